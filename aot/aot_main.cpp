@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "Machine.hpp"
+#include "aot.hpp"
+
+#include "cxxopts.hpp"
+#include "split_string.hpp"
+#include "time_str.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <spawn.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <sysexits.h>
+#include <system_error>
+
+extern char **environ;
+
+/**
+ * @brief run the C++ compiler
+ * @param args compiler command line (args[0]: compiler)
+ * @return exit code of the compiler
+ * @exception std::runtime_error failed to start the compiler
+ */
+static int compile(const std::vector<std::string> &args) {
+    std::vector<char *> argv;
+    for (const auto &arg : args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    int   err = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+    if (err) {
+        std::ostringstream sstr;
+        sstr << "failed to execute '" << args[0] << "': " << strerror(err);
+        throw std::runtime_error(sstr.str());
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) == -1) {
+        if (errno != EINTR) throw std::system_error(errno, std::generic_category(), "waitpid");
+    }
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : EX_SOFTWARE;
+}
+
+int main(int argc, char **argv) {
+    const std::string exe_name = std::filesystem::path(argv[0]).filename().string();
+    cxxopts::Options  options(exe_name, "Ahead-of-time compiler for shm-stack-machine programs");
+
+    options.add_options()("o,output",
+                          "Output file (default: PROGRAM_FILE with extension .so, or .cpp with --emit-source)",
+                          cxxopts::value<std::string>());
+    options.add_options()("s,stack-size", "Machine stack size (default: 32)", cxxopts::value<std::size_t>());
+    options.add_options()("emit-source", "Only generate the C++ source code");
+    options.add_options()("keep-source", "Do not delete the generated C++ source code after compilation");
+    options.add_options()("cxx",
+                          "C++ compiler (default: environment variable CXX or c++)",
+                          cxxopts::value<std::string>());
+    options.add_options()("cxxflags", "Additional compiler flags", cxxopts::value<std::string>());
+    options.add_options()("h,help", "Show usage information");
+    options.add_options()("v,verbose", "Print program status information");
+    options.add_options()("file", "The file to compile", cxxopts::value<std::string>());
+
+    options.parse_positional({"file"});
+    options.positional_help("PROGRAM_FILE");
+
+    auto opts = options.parse(argc, argv);
+
+    if (opts.count("help")) {
+        options.set_width(120);
+        std::cout << options.help() << std::endl;
+        std::cout << std::endl;
+        std::cout << "The generated shared object is executed by 'shm-stack-machine --aot SHARED_OBJECT PROGRAM_FILE'."
+                  << std::endl;
+        std::cout << "It is only accepted for the exact program (including constants) it was compiled from."
+                  << std::endl;
+        return EX_OK;
+    }
+
+    if (!opts.count("file")) {
+        std::cerr << "File is mandatory!" << std::endl;
+        return EX_USAGE;
+    }
+
+    const auto  file        = opts["file"].as<std::string>();
+    const bool  emit_source = opts.count("emit-source");
+    const bool  verbose     = opts.count("verbose");
+    std::size_t stack_size  = 32;
+    if (opts.count("stack-size")) stack_size = opts["stack-size"].as<std::size_t>();
+
+    std::string output;
+    if (opts.count("output")) output = opts["output"].as<std::string>();
+    else
+        output = std::filesystem::path(file).replace_extension(emit_source ? ".cpp" : ".so").string();
+
+    // parse and verify the program with the same front end as the runtime
+    std::string source;
+    try {
+        Machine machine(stack_size, verbose, false, Machine::engine_t::reference);
+        machine.load_file(file);
+        source = aot::generate(machine.get_program(), machine.get_stack_depth());
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+        return EX_DATAERR;
+    }
+
+    const auto source_path = emit_source ? output : output + ".cpp";
+    {
+        std::ofstream out(source_path);
+        out << "// generated by " << exe_name << " from " << file << '\n' << source;
+        out.close();
+        if (!out) {
+            std::cerr << now_str() << " ERROR: failed to write '" << source_path << "'" << std::endl;
+            return EX_CANTCREAT;
+        }
+    }
+
+    if (emit_source) return EX_OK;
+
+    std::string cxx = "c++";
+    if (opts.count("cxx")) cxx = opts["cxx"].as<std::string>();
+    else if (const char *env = std::getenv("CXX"); env && *env)
+        cxx = env;
+
+    std::vector<std::string> args {cxx, "-std=c++17", "-O2", "-shared", "-fPIC"};
+    if (opts.count("cxxflags")) {
+        for (auto &flag : split_string(opts["cxxflags"].as<std::string>(), ' '))
+            if (!flag.empty()) args.emplace_back(flag);
+    }
+    args.insert(args.end(), {"-o", output, source_path});
+
+    if (verbose) {
+        std::cerr << now_str() << " compile:";
+        for (const auto &arg : args)
+            std::cerr << ' ' << arg;
+        std::cerr << std::endl;
+    }
+
+    int exit_code;
+    try {
+        exit_code = compile(args);
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+        return EX_UNAVAILABLE;
+    }
+
+    if (!opts.count("keep-source")) std::filesystem::remove(source_path);
+
+    if (exit_code != 0) {
+        std::cerr << now_str() << " ERROR: compiler failed with exit code " << exit_code << std::endl;
+        return EX_SOFTWARE;
+    }
+
+    return EX_OK;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "Machine.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+static constexpr std::size_t STACK_SIZE     = 32;
+static constexpr std::size_t DEFAULT_CYCLES = 10000;
+
+/**
+ * @brief measure the execution time of Machine::run
+ * @param path program file
+ * @param engine requested execution engine
+ * @param cycles number of measured cycles
+ * @param used execution engine that was actually used
+ * @return average execution time per cycle in ns
+ */
+static double ns_per_cycle(const std::string &path, Machine::engine_t engine, std::size_t cycles,
+                           Machine::engine_t &used) {
+    Machine machine(STACK_SIZE, false, false, engine);
+    machine.load_file(path);
+    machine.init();
+    used = machine.get_engine();
+
+    // warm up
+    for (std::size_t i = 0; i < cycles / 10; ++i)
+        machine.run();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < cycles; ++i)
+        machine.run();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(cycles);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " PROGRAM_FILE [CYCLES]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string path   = argv[1];
+    std::size_t       cycles = DEFAULT_CYCLES;
+    if (argc == 3) cycles = std::stoul(argv[2]);
+
+    struct {
+        const char       *name;
+        Machine::engine_t engine;
+    } static const ENGINES[] = {
+            {"reference", Machine::engine_t::reference},
+            {"bytecode", Machine::engine_t::bytecode},
+            {"jit", Machine::engine_t::jit},
+    };
+
+    double reference = 0;
+    for (const auto &e : ENGINES) {
+        Machine::engine_t used;
+        double            ns;
+        try {
+            ns = ns_per_cycle(path, e.engine, cycles, used);
+        } catch (const std::exception &ex) {
+            std::cerr << e.name << ": " << ex.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (e.engine == Machine::engine_t::reference) reference = ns;
+
+        std::cout << std::left << std::setw(10) << e.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << ns << " ns/cycle" << std::setw(8) << std::setprecision(2) << reference / ns
+                  << 'x';
+        if (used != e.engine) std::cout << " (not available, fallback to bytecode engine)";
+        std::cout << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "Machine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <linux/futex.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static const std::string     SHM_NAME           = "/stackm_bench_pipeline";
+static constexpr std::size_t SHM_SIZE           = 16;
+static constexpr std::size_t DEFAULT_ITERATIONS = 10000;
+static constexpr std::size_t STACK_SIZE         = 32;
+
+/**
+ * @brief shared memory layout of bench/programs/pipeline.stackm
+ */
+struct pipe_t {
+    std::atomic<uint32_t> in_word;   //*< futex word of the input
+    std::atomic<uint32_t> out_word;  //*< futex word of the output
+    std::atomic<uint32_t> in;        //*< input
+    std::atomic<uint32_t> out;       //*< output
+};
+
+/**
+ * @brief stack machine process (pipeline stage)
+ * @details executes one cycle per wake up until it is terminated
+ */
+[[noreturn]] static void stage(const std::string &path) {
+    try {
+        Machine machine(STACK_SIZE, false, false);
+        machine.load_file(path);
+        if (!machine.has_trigger()) throw std::runtime_error("the program has no trigger");
+        machine.init();
+
+        while (true) {
+            machine.run();
+            machine.wait_trigger();
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "stage: " << e.what() << std::endl;
+        _exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief wait until the output of the stage is value
+ * @return false: stage did not respond within 1 s
+ */
+static bool wait_output(pipe_t &pipe, uint32_t value) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (true) {
+        // the word is read before the output, so a notification after the check is not missed
+        const auto word = pipe.out_word.load(std::memory_order_acquire);
+        if (pipe.out.load(std::memory_order_acquire) == value) return true;
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+
+        timespec timeout = {0, 1000000};
+        syscall(SYS_futex, &pipe.out_word, FUTEX_WAIT, word, &timeout, nullptr, 0);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " PIPELINE_PROGRAM_FILE [ITERATIONS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string path       = argv[1];
+    std::size_t       iterations = DEFAULT_ITERATIONS;
+    if (argc == 3) iterations = std::stoul(argv[2]);
+    if (iterations == 0) {
+        std::cerr << "ITERATIONS must not be zero" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const int fd = shm_open(SHM_NAME.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0 || ftruncate(fd, SHM_SIZE)) {
+        std::cerr << "failed to create shared memory: " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    void *addr = mmap(nullptr, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "failed to map shared memory: " << std::strerror(errno) << std::endl;
+        shm_unlink(SHM_NAME.c_str());
+        return EXIT_FAILURE;
+    }
+    auto &pipe = *static_cast<pipe_t *>(addr);
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "fork failed: " << std::strerror(errno) << std::endl;
+        shm_unlink(SHM_NAME.c_str());
+        return EXIT_FAILURE;
+    }
+    if (pid == 0) stage(path);
+
+    // the first cycle is executed without trigger
+    const auto startup = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (pipe.out_word.load(std::memory_order_acquire) == 0 && std::chrono::steady_clock::now() < startup)
+        usleep(1000);
+
+    std::vector<double> latency;
+    latency.reserve(iterations);
+    bool failed = pipe.out_word.load() == 0;
+
+    for (uint32_t value = 1; !failed && value <= iterations; ++value) {
+        const auto start = std::chrono::steady_clock::now();
+
+        // publish the input and wake the stage
+        pipe.in.store(value, std::memory_order_relaxed);
+        pipe.in_word.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, &pipe.in_word, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+
+        failed = !wait_output(pipe, value);
+
+        const auto end = std::chrono::steady_clock::now();
+        latency.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    munmap(addr, SHM_SIZE);
+    shm_unlink(SHM_NAME.c_str());
+
+    if (failed) {
+        std::cerr << "the pipeline stage did not respond" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::sort(latency.begin(), latency.end());
+    double sum = 0;
+    for (auto l : latency)
+        sum += l;
+
+    auto percentile = [&](double p) {
+        return latency[std::min(latency.size() - 1, static_cast<std::size_t>(p * static_cast<double>(latency.size())))];
+    };
+
+    std::cout << "wake to output (" << iterations << " iterations)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  min  " << std::setw(10) << latency.front() << " us" << std::endl;
+    std::cout << "  avg  " << std::setw(10) << sum / static_cast<double>(latency.size()) << " us" << std::endl;
+    std::cout << "  p50  " << std::setw(10) << percentile(0.50) << " us" << std::endl;
+    std::cout << "  p99  " << std::setw(10) << percentile(0.99) << " us" << std::endl;
+    std::cout << "  max  " << std::setw(10) << latency.back() << " us" << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "rt.hpp"
+#include "scheduler.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr std::size_t DEFAULT_CYCLES   = 2000;
+static constexpr std::size_t DEFAULT_CYCLE_US = 1000;
+static constexpr std::size_t DEFAULT_HOGS     = 2;
+static constexpr int         CPU              = 0;   // CPU of the measured process and the hogs
+static constexpr int         RT_PRIORITY      = 80;  // SCHED_FIFO priority of the real-time profile
+
+/**
+ * @brief CPU hog process (synthetic load on the CPU of the measured process)
+ */
+[[noreturn]] static void hog() {
+    try {
+        rt::profile_t profile;
+        profile.cpus = {CPU};
+        rt::apply(profile);
+    } catch (const std::exception &e) {
+        std::cerr << "hog: " << e.what() << std::endl;
+        _exit(EXIT_FAILURE);
+    }
+
+    volatile std::size_t counter = 0;
+    while (true)
+        counter = counter + 1;
+}
+
+/**
+ * @brief execute empty cycles and measure the wake latency and the period jitter
+ * @param cycles number of cycles
+ * @param cycle_time cycle time
+ * @param wait wait policy
+ */
+static scheduler::stats_t
+        measure(std::size_t cycles, std::chrono::nanoseconds cycle_time, const scheduler::wait_policy_t &wait = {}) {
+    scheduler::Scheduler cycle_scheduler(cycle_time, scheduler::overrun_t::skip);
+    cycle_scheduler.set_wait(wait);
+    cycle_scheduler.start();
+    for (std::size_t i = 0; i < cycles; ++i) {
+        cycle_scheduler.next_cycle();
+        while (!cycle_scheduler.sleep()) {}
+    }
+    return cycle_scheduler.get_stats();
+}
+
+int main(int argc, char **argv) {
+    if (argc > 4) {
+        std::cerr << "usage: " << argv[0] << " [CYCLES] [CYCLE_US] [HOGS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::size_t cycles   = DEFAULT_CYCLES;
+    std::size_t cycle_us = DEFAULT_CYCLE_US;
+    std::size_t hogs     = DEFAULT_HOGS;
+    if (argc >= 2) cycles = std::stoul(argv[1]);
+    if (argc >= 3) cycle_us = std::stoul(argv[2]);
+    if (argc == 4) hogs = std::stoul(argv[3]);
+    if (cycles == 0 || cycle_us == 0) {
+        std::cerr << "CYCLES and CYCLE_US must not be zero" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const auto cycle_time = std::chrono::microseconds(cycle_us);
+
+    auto print = [](const char *name, const scheduler::stats_t &stats) {
+        auto us = [](std::chrono::nanoseconds ns) { return static_cast<double>(ns.count()) / 1000.0; };
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << us(stats.min) << std::setw(10) << us(stats.mean) << std::setw(10)
+                  << us(stats.max) << std::setw(10) << us(stats.p99) << std::setw(10) << us(stats.jitter_max)
+                  << std::setw(10) << stats.overruns << std::endl;
+    };
+
+    std::vector<pid_t> hog_pids;
+    auto               stop_hogs = [&]() {
+        for (const auto pid : hog_pids)
+            kill(pid, SIGKILL);
+        for (const auto pid : hog_pids)
+            waitpid(pid, nullptr, 0);
+        hog_pids.clear();
+    };
+
+    try {
+        std::cout << cycles << " cycles of " << cycle_us << " us, " << hogs << " CPU hogs on CPU " << CPU << std::endl;
+        std::cout << std::left << std::setw(24) << "wake latency [us]" << std::right << std::setw(10) << "min"
+                  << std::setw(10) << "mean" << std::setw(10) << "max" << std::setw(10) << "p99" << std::setw(10)
+                  << "jitter" << std::setw(10) << "overruns" << std::endl;
+
+        rt::profile_t pinned;
+        pinned.cpus = {CPU};
+        rt::apply(pinned);
+
+        print("idle", measure(cycles, cycle_time));
+        print("idle, hybrid", measure(cycles, cycle_time, scheduler::parse_wait("HYBRID", "")));
+        print("idle, spin", measure(cycles, cycle_time, scheduler::parse_wait("SPIN", "")));
+
+        for (std::size_t i = 0; i < hogs; ++i) {
+            const pid_t pid = fork();
+            if (pid < 0) throw std::runtime_error("fork failed: " + std::string(std::strerror(errno)));
+            if (pid == 0) hog();
+            hog_pids.push_back(pid);
+        }
+
+        print("hogs, SCHED_OTHER", measure(cycles, cycle_time));
+
+        // the real-time profile is applied last (it is not reverted)
+        rt::profile_t profile = pinned;
+        profile.lock_memory   = true;
+        rt::set_policy(profile, "FIFO", std::to_string(RT_PRIORITY));
+        try {
+            rt::apply(profile);
+            print("hogs, real-time profile", measure(cycles, cycle_time));
+        } catch (const std::exception &e) {
+            std::cout << std::left << std::setw(24) << "hogs, real-time profile" << "skipped: " << e.what()
+                      << std::endl;
+        }
+
+        stop_hogs();
+    } catch (const std::exception &e) {
+        stop_hogs();
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "Memory.hpp"
+#include "memory_access.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static const std::string     SHM_NAME           = "/stackm_bench_seqlock";
+static constexpr std::size_t CELL_SIZE          = 8;
+static constexpr std::size_t DEFAULT_ITERATIONS = 1000000;
+static constexpr std::size_t DEFAULT_VARIABLES  = 16;
+static constexpr std::size_t DEFAULT_INTERVAL   = 1000;  // ns between the begin of two writes
+
+/**
+ * @brief result of a measurement
+ */
+struct result_t {
+    double      ns_per_read;  //*< average time of image_read in ns
+    std::size_t retries;      //*< number of repeated copies (seqlock)
+    std::size_t torn;         //*< number of snapshots with different values
+};
+
+/**
+ * @brief create the shared memory (cell 0: sequence counter, cell 1..variables: variables)
+ */
+static void create_shm(std::size_t variables) {
+    const int fd = shm_open(SHM_NAME.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) throw std::runtime_error("shm_open failed: " + std::string(std::strerror(errno)));
+    const auto size = static_cast<off_t>((variables + 1) * CELL_SIZE);
+    if (ftruncate(fd, size)) {
+        close(fd);
+        throw std::runtime_error("ftruncate failed: " + std::string(std::strerror(errno)));
+    }
+    close(fd);
+}
+
+/**
+ * @brief writer process (the other side of the seqlock, e.g. a Modbus gateway)
+ * @details writes the same value to all variables (busy waiting between the writes) until it is terminated
+ * @param variables number of variables
+ * @param interval time between the begin of two writes in ns (0: write continuously)
+ */
+[[noreturn]] static void writer(std::size_t variables, std::size_t interval) {
+    cxxshm::SharedMemory shm(SHM_NAME);
+    auto                *data    = shm.get_addr<uint8_t *>();
+    auto                &counter = *reinterpret_cast<std::atomic<uint64_t> *>(data);
+
+    auto next = std::chrono::steady_clock::now();
+    for (uint64_t value = 1;; ++value) {
+        next += std::chrono::nanoseconds(interval);
+        while (std::chrono::steady_clock::now() < next) {}
+
+        counter.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 1; i <= variables; ++i)
+            mem_access::store<Memory::dtype_t::le64, CELL_SIZE>(data + i * CELL_SIZE, 0, value);
+        counter.fetch_add(1, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief measure image_read
+ * @param seqlock synchronize the process image by the seqlock
+ * @param variables number of variables
+ * @param iterations number of measured reads
+ */
+static result_t measure(bool seqlock, std::size_t variables, std::size_t iterations) {
+    MemorySHM mem(SHM_NAME, CELL_SIZE);
+    if (seqlock) mem.enable_seqlock(0);
+    else
+        mem.enable_image();
+
+    std::vector<const void *> vars;
+    for (std::size_t i = 1; i <= variables; ++i)
+        vars.push_back(mem.get_var_addr(i, Memory::dtype_t::le64, 0));
+
+    result_t result {0, 0, 0};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t n = 0; n < iterations; ++n) {
+        mem.image_read();
+
+        const auto first = mem_access::load<Memory::dtype_t::le64, CELL_SIZE>(vars.front(), 0);
+        for (const auto *var : vars) {
+            if (mem_access::load<Memory::dtype_t::le64, CELL_SIZE>(var, 0) != first) {
+                ++result.torn;
+                break;
+            }
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    result.ns_per_read = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+    result.retries     = mem.get_seqlock_retries();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 4) {
+        std::cerr << "usage: " << argv[0] << " [ITERATIONS] [VARIABLES] [WRITE_INTERVAL_NS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::size_t iterations = DEFAULT_ITERATIONS;
+    std::size_t variables  = DEFAULT_VARIABLES;
+    std::size_t interval   = DEFAULT_INTERVAL;
+    if (argc >= 2) iterations = std::stoul(argv[1]);
+    if (argc >= 3) variables = std::stoul(argv[2]);
+    if (argc == 4) interval = std::stoul(argv[3]);
+    if (iterations == 0 || variables == 0) {
+        std::cerr << "ITERATIONS and VARIABLES must not be zero" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto print = [&](const char *name, const result_t &result, double baseline) {
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << result.ns_per_read << " ns/read" << std::setw(10)
+                  << result.ns_per_read - baseline << " ns added" << std::setw(10) << std::setprecision(4)
+                  << 100.0 * static_cast<double>(result.retries) / static_cast<double>(iterations) << " % retries"
+                  << std::setw(10) << result.torn << " torn" << std::endl;
+    };
+
+    pid_t pid = -1;
+    try {
+        create_shm(variables);
+
+        const auto idle = measure(true, variables, iterations);
+
+        pid = fork();
+        if (pid < 0) throw std::runtime_error("fork failed: " + std::string(std::strerror(errno)));
+        if (pid == 0) writer(variables, interval);
+
+        const auto plain  = measure(false, variables, iterations);
+        const auto locked = measure(true, variables, iterations);
+
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        pid = -1;
+        shm_unlink(SHM_NAME.c_str());
+
+        std::cout << variables << " variables (le64), " << iterations << " reads, write interval " << interval << " ns"
+                  << std::endl;
+        print("seqlock, no writer", idle, idle.ns_per_read);
+        print("image, writer", plain, idle.ns_per_read);
+        print("seqlock, writer", locked, idle.ns_per_read);
+
+        if (idle.torn || locked.torn) {
+            std::cerr << "inconsistent snapshot with seqlock" << std::endl;
+            return EXIT_FAILURE;
+        }
+    } catch (const std::exception &e) {
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        shm_unlink(SHM_NAME.c_str());
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "StackMachine.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+static constexpr std::size_t STACK_SIZE         = 32;
+static constexpr std::size_t DEFAULT_ITERATIONS = 10000000;
+static constexpr std::size_t OPS_PER_ITERATION  = 6;  // push, push, add, dup, pop, pop
+static constexpr int         ROUNDS             = 5;  // the fastest round is reported
+
+// StackMachine::pop, add and dup are not inlined (defined in StackMachine.cpp)
+#ifdef COMPILER_GNU_CLANG
+#    define BENCH_NOINLINE __attribute__((noinline))
+#else
+#    define BENCH_NOINLINE
+#endif
+
+/**
+ * @brief checked stack without any tracing support (baseline)
+ * @details same checks, data layout and inlining as StackMachine
+ */
+class BaselineStack {
+private:
+    const std::size_t                  MAX_STACK;
+    std::vector<StackMachine::stack_t> stack;
+    std::size_t                        depth = 0;
+    StackMachine::stack_t              tos   = 0;
+
+public:
+    explicit BaselineStack(std::size_t max_stack) : MAX_STACK(max_stack), stack(max_stack + 1) {}
+
+    template <typename>
+    void push(StackMachine::stack_t data) {
+        if (depth >= MAX_STACK) throw std::runtime_error("stack full");
+        stack[depth++] = tos;
+        tos            = data;
+    }
+
+    template <typename>
+    BENCH_NOINLINE StackMachine::stack_t pop() {
+        if (!depth) throw std::runtime_error("stack empty");
+        const auto data = tos;
+        tos             = stack[--depth];
+        return data;
+    }
+
+    template <typename>
+    BENCH_NOINLINE void add() {
+        if (depth < 2) throw std::runtime_error("to few elements on stack");
+        const auto R = tos;
+        tos          = stack[--depth];
+        tos += R;
+    }
+
+    template <typename>
+    BENCH_NOINLINE void dup() {
+        if (!depth) throw std::runtime_error("stack empty");
+        if (depth >= MAX_STACK) throw std::runtime_error("stack full");
+        stack[depth++] = tos;
+    }
+};
+
+/**
+ * @brief stream buffer that discards the trace output
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+/**
+ * @brief measure the average time of a stack machine operation
+ * @tparam Trace tracing policy
+ * @param machine stack machine (or baseline)
+ * @param iterations number of measured iterations
+ * @return average time per operation in ns
+ */
+template <typename Trace, typename M>
+static double ns_per_op(M &machine, std::size_t iterations) {
+    volatile StackMachine::stack_t sink = 0;
+
+    double best = std::numeric_limits<double>::max();
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            machine.template push<Trace>(i);
+            machine.template push<Trace>(sink);
+            machine.template add<Trace>();
+            machine.template dup<Trace>();
+            sink = machine.template pop<Trace>() + machine.template pop<Trace>();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    return best / static_cast<double>(iterations * OPS_PER_ITERATION);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        std::cerr << "usage: " << argv[0] << " [ITERATIONS]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::size_t iterations = DEFAULT_ITERATIONS;
+    if (argc == 2) iterations = std::stoul(argv[1]);
+
+    BaselineStack baseline(STACK_SIZE);
+    StackMachine  machine(STACK_SIZE);
+
+    const double ns_baseline = ns_per_op<void>(baseline, iterations);
+    const double ns_off      = ns_per_op<tracing::off>(machine, iterations);
+
+    // trace output is discarded (measures the formatting, not the terminal)
+    NullBuffer null_buffer;
+    auto      *cerr_buf = std::cerr.rdbuf(&null_buffer);
+    const auto ns_on    = ns_per_op<tracing::on>(machine, iterations / 100);
+    std::cerr.rdbuf(cerr_buf);
+
+    auto print = [&](const char *name, double ns) {
+        std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << ns << " ns/op" << std::setw(8) << ns / ns_baseline << 'x' << std::endl;
+    };
+
+    print("baseline", ns_baseline);
+    print("tracing::off", ns_off);
+    print("tracing::on", ns_on);
+
+    return EXIT_SUCCESS;
+}
@@ -5,12 +5,15 @@
 
 #include "Machine.hpp"
 
+#include "control_flow.hpp"
+#include "fusion.hpp"
 #include "special_instructions.hpp"
 #include "split_string.hpp"
 #include "time_str.hpp"
 
 #include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <regex>
 #include <unordered_set>
@@ -32,7 +35,8 @@ static const std::unordered_set<std::string> RESERVED = {"STIME",
                                                          "STDOUT",
                                                          "STDOUTS",
                                                          "STDOUTF",
-                                                         "STDOUTD"};
+                                                         "STDOUTD",
+                                                         "FAULT"};
 
 static unsigned long long parse_unsigned(const std::string &str) {
     unsigned long long result;
@@ -62,6 +66,34 @@ static long long parse_signed(const std::string &str) {
     return result;
 }
 
+/**
+ * @brief parse the period of a task (<number>ns|us|ms|s)
+ */
+static std::chrono::nanoseconds parse_period(const std::string &str) {
+    static const std::regex PERIOD("^([0-9]+)(ns|us|ms|s)$");
+
+    auto error = [&str]() {
+        std::ostringstream sstr;
+        sstr << "invalid task period '" << str << "' (expected <number>ns|us|ms|s)";
+        return std::runtime_error(sstr.str());
+    };
+
+    std::smatch match;
+    if (!std::regex_match(str, match, PERIOD)) throw error();
+
+    int64_t factor = 1;
+    if (match[2] == "us") factor = 1000;
+    else if (match[2] == "ms")
+        factor = 1000000;
+    else if (match[2] == "s")
+        factor = 1000000000;
+
+    const auto value = parse_unsigned(match[1]);
+    if (value == 0 || value > static_cast<unsigned long long>(INT64_MAX / factor)) throw error();
+
+    return std::chrono::nanoseconds(static_cast<int64_t>(value) * factor);
+}
+
 static double parse_double(const std::string &str) {
     double      result;
     bool        fail = false;
@@ -76,6 +108,14 @@ static double parse_double(const std::string &str) {
     return result;
 }
 
+Machine::Machine(const Machine &main, std::string name, std::chrono::nanoseconds period)
+    : verbose(main.verbose), debug(main.debug),
+      // the shared object of the aot engine contains only section __PROGRAM
+      engine(main.engine == engine_t::aot ? engine_t::bytecode : main.engine), cycle_time(period),
+      overrun_policy(main.overrun_policy), cycles(main.cycles), fault_policy(main.fault_policy),
+      stack_machine(main.stack_machine.max_size()), var_map(main.var_map), const_map(main.const_map),
+      task_name(std::move(name)) {}
+
 void Machine::load_file(const std::string &path) {
     if (verbose) {
         std::cerr << now_str() << " >>>>> read config from file" << std::endl;
@@ -93,6 +133,14 @@ void Machine::load_file(const std::string &path) {
     std::vector<std::string>  section_program;
     std::vector<std::string> *cur_section = nullptr;
 
+    // sections __PROGRAM <task> <period>
+    struct task_section_t {
+        std::string              name;
+        std::chrono::nanoseconds period;
+        std::vector<std::string> program;
+    };
+    std::vector<task_section_t> section_tasks;
+
     if (verbose) std::cerr << now_str() << " read file " << std::endl;
     std::string line;
     while (std::getline(input, line)) {
@@ -125,6 +173,32 @@ void Machine::load_file(const std::string &path) {
             cur_section = &section_program;
             if (!cur_section->empty()) throw std::runtime_error("duplicate section __PROGRAM");
             continue;
+        } else if (split_comment[0].rfind("__PROGRAM ", 0) == 0) {
+            const auto header = split_string(split_comment[0], ' ');
+            if (header.size() != 3) {
+                std::ostringstream sstr;
+                sstr << "invalid section '" << split_comment[0] << "' (expected __PROGRAM <task> <period>)";
+                throw std::runtime_error(sstr.str());
+            }
+
+            const auto &name = header[1];
+            if (!std::regex_match(name, std::regex("^[A-Za-z_][A-Za-z0-9_]*$")) || name == task_name) {
+                std::ostringstream sstr;
+                sstr << "invalid task name '" << name << "'";
+                throw std::runtime_error(sstr.str());
+            }
+
+            for (const auto &task : section_tasks) {
+                if (task.name == name) {
+                    std::ostringstream sstr;
+                    sstr << "duplicate section __PROGRAM " << name;
+                    throw std::runtime_error(sstr.str());
+                }
+            }
+
+            section_tasks.push_back({name, parse_period(header[2]), {}});
+            cur_section = &section_tasks.back().program;
+            continue;
         }
 
         if (cur_section == nullptr) throw std::runtime_error("instruction outside section");
@@ -140,14 +214,251 @@ void Machine::load_file(const std::string &path) {
     if (verbose) std::cerr << now_str() << " parse section __MEM" << std::endl;
     parse_mem(section_mem);
 
+    if (!trigger_setting.empty()) create_trigger();
+    if (!notify_setting.empty()) create_notify();
+
     if (verbose) std::cerr << now_str() << " parse section __VAR" << std::endl;
     parse_var(section_var);
 
     if (verbose) std::cerr << now_str() << " parse section __INIT" << std::endl;
     parse_init(section_init);
 
-    if (verbose) std::cerr << now_str() << " parse section __PROGRAM" << std::endl;
-    parse_program(section_program);
+    if (!section_tasks.empty()) {
+        // the tasks access the memory directly, a cycle of a task can preempt a cycle of another task
+        if (trigger) throw std::runtime_error("setting TRIGGER can not be combined with tasks");
+        if (!process_image.empty() || !bit_cache.empty())
+            throw std::runtime_error("memory options image and bits can not be combined with tasks");
+    }
+
+    compile_program(std::move(section_program), "__PROGRAM");
+
+    for (auto &section : section_tasks) {
+        tasks.emplace_back(new Machine(*this, section.name, section.period));
+        tasks.back()->compile_program(std::move(section.program), "__PROGRAM " + section.name);
+    }
+
+    prepare_pages();
+}
+
+void Machine::compile_program(std::vector<std::string> section, const std::string &section_name) {
+    // fault handler entry: the program is executed again with FAULT != 0 if an operation faults
+    std::size_t prologue = 0;
+    if (fault_policy == fault_policy_t::handler) {
+        if (std::find(section.begin(), section.end(), "$FAULT") == section.end())
+            throw std::runtime_error("fault policy HANDLER requires the label $FAULT in section " + section_name);
+        section.insert(section.begin(), {"PUSH FAULT", "JNZ FAULT"});
+        prologue = 2;
+    }
+
+    if (verbose) std::cerr << now_str() << " parse section " << section_name << std::endl;
+    if (debug) parse_program<tracing::on>(section);
+    else
+        parse_program<tracing::off>(section);
+
+    if (verbose) std::cerr << now_str() << " verify stack depth" << std::endl;
+    try {
+        stack_depth = program.verify(stack_machine.max_size());
+    } catch (const bytecode::verify_error &e) {
+        std::ostringstream sstr;
+        if (e.get_index() < prologue) sstr << "fault handler entry";
+        else
+            sstr << "instruction " << e.get_index() + 1 - prologue << " of section " << section_name;
+        if (e.get_index() < section.size()) sstr << " ('" << section[e.get_index()] << "')";
+        sstr << ": " << e.what();
+        throw std::runtime_error(sstr.str());
+    }
+
+    if (verbose) std::cerr << now_str() << " optimize bytecode" << std::endl;
+    program_source = section;
+    optimized      = bytecode::optimize(program);
+    try {
+        stack_depth = program.verify(stack_machine.max_size());
+    } catch (const bytecode::verify_error &e) {
+        throw std::logic_error(std::string("optimized bytecode program failed the verification: ") + e.what());
+    }
+    if (verbose) {
+        std::cerr << now_str() << " folded " << std::dec << optimized.folded << " and reduced " << optimized.reduced
+                  << " operations, removed " << optimized.removed << " operations, threaded " << optimized.threaded
+                  << " jumps" << std::endl;
+        std::cerr << now_str() << " max stack depth: " << std::dec << stack_depth.max_depth << " of "
+                  << stack_machine.max_size() << std::endl;
+    }
+
+    if (verbose) std::cerr << now_str() << " clean up control flow" << std::endl;
+    cleanup_instructions();
+
+    // the bytecode engine and the native code bypass the stack machine --> each stack operation is only traced by the
+    // reference interpreter
+    if (debug && engine != engine_t::reference) {
+        if (engine == engine_t::jit || engine == engine_t::aot)
+            std::cerr << now_str() << " WARNING: native code is disabled in debug mode" << std::endl;
+        engine = engine_t::reference;
+    }
+
+    if (engine == engine_t::jit) {
+        try {
+            jit_program = std::make_unique<jit::Program>(program, stack_depth);
+            if (verbose)
+                std::cerr << now_str() << " generated " << std::dec << jit_program->get_code_size()
+                          << " bytes of native code (" << jit_program->get_native_ops() << " native, "
+                          << jit_program->get_fallback_ops() << " interpreted instructions)" << std::endl;
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " WARNING: native code generation failed: " << e.what()
+                      << " --> using bytecode engine" << std::endl;
+            engine = engine_t::bytecode;
+        }
+    }
+
+    if (engine == engine_t::aot) {
+        if (verbose) std::cerr << now_str() << " load compiled program " << aot_library << std::endl;
+        aot_program = std::make_unique<aot::Program>(aot_library, program, stack_depth);
+    }
+
+    if (engine == engine_t::bytecode) {
+        const auto stats = bytecode::fuse(program);
+        if (verbose)
+            std::cerr << now_str() << " fused " << std::dec << stats.instructions << " instructions into "
+                      << stats.superinstructions << " superinstructions" << std::endl;
+    }
+}
+
+void Machine::set_preemption(bytecode::Preemption *request) {
+    preemption = request;
+
+    if (engine == engine_t::jit || engine == engine_t::aot) {
+        if (verbose)
+            std::cerr << now_str() << " task " << task_name
+                      << ": native code can not be preempted --> using bytecode engine" << std::endl;
+        jit_program.reset();
+        aot_program.reset();
+        engine = engine_t::bytecode;
+        bytecode::fuse(program);
+    }
+
+    program.set_preemption(request);
+}
+
+void Machine::prepare_pages() {
+    for (const auto &pages : mem_pages) {
+        std::size_t prefaulted = 0;
+        std::size_t locked     = 0;
+
+        if (pages.prefault) prefaulted = pages.mem->prefault();
+
+        if (pages.lock) {
+            try {
+                locked = pages.mem->lock();
+            } catch (const std::exception &e) {
+                std::ostringstream sstr;
+                sstr << "memory '" << pages.name << "': " << e.what();
+                throw std::runtime_error(sstr.str());
+            }
+        }
+
+        if (!verbose) continue;
+
+        std::cerr << now_str() << " memory '" << pages.name << "':" << std::dec;
+        if (pages.prefault) std::cerr << ' ' << prefaulted << " pages prefaulted";
+        if (pages.lock) std::cerr << (pages.prefault ? ", " : " ") << locked << " pages locked";
+
+        if (const auto *local = dynamic_cast<const MemoryLocal *>(pages.mem)) {
+            switch (local->get_huge_pages()) {
+                case MemoryLocal::huge_page_t::none: break;
+                case MemoryLocal::huge_page_t::hugetlb: std::cerr << " (huge pages)"; break;
+                case MemoryLocal::huge_page_t::transparent: std::cerr << " (transparent huge pages)"; break;
+                default: throw std::logic_error("invalid huge page mode");
+            }
+        }
+
+        std::cerr << std::endl;
+    }
+}
+
+void Machine::cleanup_instructions() {
+    std::vector<control_flow::node_t> nodes(instructions.size(), {control_flow::kind_t::other});
+    for (std::size_t i = 0; i < instructions.size(); ++i) {
+        const auto *instruction = instructions[i].get();
+        if (dynamic_cast<const instr::LABEL *>(instruction)) {
+            nodes[i].kind = control_flow::kind_t::nop;
+        } else if (const auto *jump = dynamic_cast<const instr::Jump *>(instruction)) {
+            nodes[i].kind   = dynamic_cast<const instr::J *>(jump) ? control_flow::kind_t::jump
+                                                                   : control_flow::kind_t::branch;
+            nodes[i].target = jump->get_target();
+        } else if (dynamic_cast<const instr::END *>(instruction)) {
+            nodes[i].kind = control_flow::kind_t::end;
+        }
+    }
+
+    const auto flow = control_flow::cleanup(nodes);
+
+    std::vector<std::unique_ptr<Instruction>> kept;
+    for (std::size_t i = 0; i < instructions.size(); ++i) {
+        if (!flow.keep[i]) continue;
+
+        if (auto *jump = dynamic_cast<instr::Jump *>(instructions[i].get()))
+            jump->set_target(flow.position[flow.target[i]]);
+        kept.emplace_back(std::move(instructions[i]));
+    }
+    instructions = std::move(kept);
+
+    for (auto &a : label_pos)
+        a.second = flow.position[a.second];
+
+    if (verbose)
+        std::cerr << now_str() << " removed " << std::dec << flow.nops << " labels, " << flow.unreachable
+                  << " unreachable instructions and " << flow.redundant_jumps << " redundant jumps, threaded "
+                  << flow.threaded << " jumps" << std::endl;
+}
+
+void Machine::print_listing(std::ostream &out) const {
+    const auto &ops = program.get_ops();
+
+    // variable names (PUSH_VAR, POP_VAR)
+    std::unordered_map<const var_t *, std::string> var_names;
+    for (const auto &a : var_map)
+        var_names[&a.second] = a.first;
+    var_names[&fault_var] = "FAULT";
+
+    out << "# " << std::dec << ops.size() << " operations (" << program_source.size() << " instructions, "
+        << optimized.folded << " folded, " << optimized.reduced << " reduced, " << optimized.removed << " removed, "
+        << optimized.threaded << " threaded)\n";
+
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const auto &op = ops[i];
+
+        std::ostringstream operand;
+        if (op.code == bytecode::opcode_t::PUSH_CONST)
+            operand << "0x" << std::hex << std::setw(16) << std::setfill('0') << op.arg.value;
+        else if (op.code == bytecode::opcode_t::PUSH_VAR || op.code == bytecode::opcode_t::POP_VAR)
+            operand << var_names.at(op.arg.var);
+        else if (op.code == bytecode::opcode_t::J || op.code == bytecode::opcode_t::JZ ||
+                 op.code == bytecode::opcode_t::JNZ)
+            operand << op.arg.target;
+
+        std::ostringstream line;
+        line << std::setw(6) << i << "  " << std::left << std::setw(12) << bytecode::opcode_name(op.code)
+             << std::setw(20) << operand.str();
+
+        // instructions of section __PROGRAM (END is not part of the section)
+        if (i < optimized.origin.size() && optimized.origin[i].first < program_source.size()) {
+            const auto &origin = optimized.origin[i];
+            line << "  # " << origin.first + 1;
+            if (origin.last != origin.first) line << '-' << origin.last + 1;
+            line << ':';
+            for (std::size_t k = origin.first; k <= origin.last && k < program_source.size(); ++k)
+                line << (k == origin.first ? " " : " | ") << program_source[k];
+        }
+
+        auto str = line.str();
+        str.erase(str.find_last_not_of(' ') + 1);
+        out << str << '\n';
+    }
+
+    for (const auto &task : tasks) {
+        out << "\n# task " << task->task_name << '\n';
+        task->print_listing(out);
+    }
+    out.flush();
 }
 
 void Machine::init() {
@@ -160,11 +471,21 @@ void Machine::init() {
                       << std::endl;
 
         if (var.init) {
-            instr::POP_var pop(stack_machine, var);
-            stack_machine.push(var.init_value);
-            pop.exec();
+            if (debug) {
+                instr::POP_var<tracing::on> pop(stack_machine, var);
+                stack_machine.push<tracing::on>(var.init_value);
+                pop.exec();
+            } else {
+                instr::POP_var<tracing::off> pop(stack_machine, var);
+                stack_machine.push(var.init_value);
+                pop.exec();
+            }
         }
     }
+
+    // initial values of cached bit variables
+    for (auto *mem : bit_cache)
+        mem->bits_write();
 }
 
 void Machine::run() {
@@ -173,15 +494,155 @@ void Machine::run() {
         ++cycle_counter;
     }
 
-    stack_machine.clr();
+    if (trigger) {
+        trigger->arm();
+        cycle_start = std::chrono::steady_clock::now();
+    }
+
+    for (auto *mem : process_image)
+        mem->image_read();
+
+    for (auto *mem : bit_cache)
+        mem->bits_read();
+
+    run_program();
+
+    const auto fault = stack_machine.get_fault();
+    if (fault != StackMachine::fault_t::none) {
+        stack_machine.clr_fault();
+
+        switch (fault_policy) {
+            case fault_policy_t::abort: throw std::runtime_error(StackMachine::fault_name(fault));
+            case fault_policy_t::skip:
+                // the stores to process images and cached bit variables are discarded. Stores to local memories and
+                // to memories without a process image were already written to the memory and remain.
+                for (auto *mem : process_image)
+                    mem->image_discard();
+
+                // no output in the cycle thread: the warning is printed (rate limited) by the reporter
+                if (fault_log) fault_log->record_fault(StackMachine::fault_name(fault));
+                else
+                    std::cerr << now_str() << " WARNING: " << StackMachine::fault_name(fault) << " --> cycle skipped"
+                              << std::endl;
+                return;
+            case fault_policy_t::handler: {
+                // the program starts with a jump to $FAULT if FAULT is not zero
+                fault_mem.store(static_cast<StackMachine::stack_t>(fault), 0, Memory::dtype_t::le64, 0);
+                run_program();
+                fault_mem.store(0, 0, Memory::dtype_t::le64, 0);
+
+                const auto handler_fault = stack_machine.get_fault();
+                if (handler_fault != StackMachine::fault_t::none) {
+                    stack_machine.clr_fault();
+                    std::ostringstream sstr;
+                    sstr << StackMachine::fault_name(handler_fault) << " in fault handler (handling "
+                         << StackMachine::fault_name(fault) << ")";
+                    throw std::runtime_error(sstr.str());
+                }
+                break;
+            }
+            default: throw std::logic_error("invalid fault policy");
+        }
+    }
+
+    for (auto *mem : bit_cache)
+        mem->bits_write();
+
+    for (auto *mem : process_image)
+        mem->image_write();
+
+    for (auto *file : file_sync)
+        file->cycle();
+
+    if (notify) notify->notify();
+}
+
+bool Machine::wait_trigger() {
+    if (!trigger) throw std::logic_error("no trigger");
+    return trigger->wait(cycle_start + cycle_time);
+}
+
+MemoryReal &Machine::resolve_cell(const std::string &setting, const std::string &addr_str, std::size_t &begin) {
+    const auto split_addr = split_string(addr_str, '@');
 
-    ip = 0;
-    while (true) {
-        auto instr = instructions.at(ip).get();
-        if (!instr->exec()) break;
-        ++ip;
+    auto error = [&](const std::string &what) {
+        std::ostringstream sstr;
+        sstr << "invalid " << setting << " '" << addr_str << "': " << what;
+        return std::runtime_error(sstr.str());
     };
-    return;
+
+    if (split_addr.size() != 2) throw error("expected <memory>@<cell>");
+    if (mem_map.count(split_addr[0]) == 0) throw error("unknown memory '" + split_addr[0] + "'");
+
+    auto *mem = dynamic_cast<MemoryReal *>(mem_map.at(split_addr[0]).get());
+    if (!mem) throw error("memory has to be a shared memory or a file");
+
+    try {
+        begin = parse_unsigned(split_addr[1]) * mem->get_cell_size();
+    } catch (const std::exception &e) { throw error(e.what()); }
+
+    return *mem;
+}
+
+void Machine::create_trigger() {
+    const auto &mode     = trigger_setting[1];
+    const auto &addr_str = trigger_setting[2];
+
+    std::size_t begin;
+    auto       &mem = resolve_cell("trigger", addr_str, begin);
+
+    try {
+        if (mode == "CHANGE") {
+            const auto cells = parse_unsigned(trigger_setting[3]);
+            const auto poll  = parse_unsigned(trigger_setting[4]);
+            if (poll == 0) throw std::runtime_error("poll interval must not be zero");
+
+            const auto size = cells * mem.get_cell_size();
+            trigger         = std::make_unique<trigger::Change>(
+                    mem.get_range_addr(begin, size), size, std::chrono::milliseconds(poll));
+        } else {
+            trigger = std::make_unique<trigger::Futex>(mem.get_range_addr(begin, sizeof(uint32_t)));
+        }
+    } catch (const std::exception &e) {
+        std::ostringstream sstr;
+        sstr << "invalid trigger '" << addr_str << "': " << e.what();
+        throw std::runtime_error(sstr.str());
+    }
+}
+
+void Machine::create_notify() {
+    std::size_t begin;
+    auto       &mem = resolve_cell("notify", notify_setting, begin);
+
+    try {
+        notify = std::make_unique<trigger::Notify>(mem.get_range_addr(begin, sizeof(uint32_t)));
+    } catch (const std::exception &e) {
+        std::ostringstream sstr;
+        sstr << "invalid notify '" << notify_setting << "': " << e.what();
+        throw std::runtime_error(sstr.str());
+    }
+}
+
+void Machine::run_program() {
+    if (debug) stack_machine.clr<tracing::on>();
+    else
+        stack_machine.clr();
+
+    switch (engine) {
+        case engine_t::bytecode: program.run(stack_machine); break;
+        case engine_t::jit: jit_program->run(stack_machine); break;
+        case engine_t::aot: aot_program->run(stack_machine); break;
+        case engine_t::reference:
+            // ip is the index of the next instruction (jumps overwrite it)
+            ip = 0;
+            while (true) {
+                if (preemption) preemption->poll();
+                auto instr = instructions.at(ip++).get();
+                if (!instr->exec()) break;
+            };
+            break;
+        default: throw std::logic_error("invalid engine");
+    }
 }
 
 void Machine::parse_mem(const std::vector<std::string> &data) {
@@ -192,7 +653,7 @@ void Machine::parse_mem(const std::vector<std::string> &data) {
         if (split_instr.empty()) throw std::runtime_error("internal error: instruction empty");
 
         if (split_instr[0] == "local") {
-            if (split_instr.size() != 3) {
+            if (split_instr.size() < 3) {
                 std::ostringstream sstr;
                 sstr << "invalid memory configuration: " << instr;
                 throw std::runtime_error(sstr.str());
@@ -216,16 +677,42 @@ void Machine::parse_mem(const std::vector<std::string> &data) {
                 throw std::runtime_error(sstr.str());
             }
 
-            mem_map[name] = std::make_unique<MemoryLocal>(mem_size);
+            auto        mem = std::make_unique<MemoryLocal>(mem_size);
+            mem_pages_t pages {name, mem.get(), false, false};
+
+            // options
+            for (std::size_t i = 3; i < split_instr.size(); ++i) {
+                const auto &option = split_instr[i];
+                if (option == "prefault") {
+                    pages.prefault = true;
+                } else if (option == "mlock") {
+                    pages.lock = true;
+                } else if (option == "hugepages") {
+                    try {
+                        mem->enable_huge_pages();
+                    } catch (const std::exception &e) {
+                        std::ostringstream sstr;
+                        sstr << "invalid memory configuration: " << instr << " (" << e.what() << ")";
+                        throw std::runtime_error(sstr.str());
+                    }
+                } else {
+                    std::ostringstream sstr;
+                    sstr << "invalid memory configuration: " << instr << " (unknown option '" << option << "')";
+                    throw std::runtime_error(sstr.str());
+                }
+            }
 
-        } else if (split_instr[0] == "shm") {
-            if (split_instr.size() != 4) {
+            if (pages.prefault || pages.lock || mem->get_huge_pages() != MemoryLocal::huge_page_t::none)
+                mem_pages.push_back(pages);
+            mem_map[name] = std::move(mem);
+        } else if (split_instr[0] == "shm" || split_instr[0] == "file") {
+            if (split_instr.size() < 4) {
                 std::ostringstream sstr;
                 sstr << "invalid memory configuration: " << instr;
                 throw std::runtime_error(sstr.str());
             }
 
-            const auto &shm_name  = split_instr[1];
+            const auto &source    = split_instr[1];  // shared memory name or file path
             const auto &name      = split_instr[2];
             const auto &cell_size = split_instr[3];
 
@@ -244,7 +731,69 @@ void Machine::parse_mem(const std::vector<std::string> &data) {
                 throw std::runtime_error(sstr.str());
             }
 
-            mem_map[name] = std::make_unique<MemorySHM>(shm_name, mem_cell_size);
+            std::unique_ptr<MemoryReal> mem;
+            MemoryFile                 *file = nullptr;
+            if (split_instr[0] == "file") {
+                auto file_mem = std::make_unique<MemoryFile>(source, mem_cell_size);
+                file          = file_mem.get();
+                mem           = std::move(file_mem);
+            } else {
+                if (shm_cache) mem = std::make_unique<MemorySHM>(shm_cache->get(source), mem_cell_size);
+                else
+                    mem = std::make_unique<MemorySHM>(source, mem_cell_size);
+            }
+
+            // options
+            static const std::string SEQLOCK = "seqlock=";
+            static const std::string MSYNC   = "msync=";
+            mem_pages_t              pages {name, mem.get(), false, false};
+            for (std::size_t i = 4; i < split_instr.size(); ++i) {
+                const auto &option = split_instr[i];
+                if (option == "prefault") {
+                    pages.prefault = true;
+                } else if (option == "mlock") {
+                    pages.lock = true;
+                } else if (option == "image") {
+                    if (!mem->has_image()) mem->enable_image();
+                } else if (option == "bits" || option == "bits=atomic") {
+                    mem->enable_bit_cache(option == "bits=atomic");
+                } else if (option.compare(0, SEQLOCK.size(), SEQLOCK) == 0) {
+                    const auto offset = option.substr(SEQLOCK.size());
+                    try {
+                        mem->enable_seqlock(parse_unsigned(offset));
+                    } catch (const std::exception &e) {
+                        std::ostringstream sstr;
+                        sstr << "invalid memory configuration: " << instr << " (" << e.what() << ")";
+                        throw std::runtime_error(sstr.str());
+                    }
+                } else if (file && option.compare(0, MSYNC.size(), MSYNC) == 0) {
+                    const auto interval = option.substr(MSYNC.size());
+                    if (interval == "never") file->set_sync_interval(0);
+                    else if (interval == "cycle")
+                        file->set_sync_interval(1);
+                    else {
+                        try {
+                            const auto cycles_per_sync = parse_unsigned(interval);
+                            if (cycles_per_sync == 0) throw std::runtime_error("must not be zero");
+                            file->set_sync_interval(cycles_per_sync);
+                        } catch (const std::exception &e) {
+                            std::ostringstream sstr;
+                            sstr << "invalid memory configuration: " << instr << " (msync: " << e.what() << ")";
+                            throw std::runtime_error(sstr.str());
+                        }
+                    }
+                } else {
+                    std::ostringstream sstr;
+                    sstr << "invalid memory configuration: " << instr << " (unknown option '" << option << "')";
+                    throw std::runtime_error(sstr.str());
+                }
+            }
+
+            if (mem->has_image()) process_image.push_back(mem.get());
+            if (mem->has_bit_cache()) bit_cache.push_back(mem.get());
+            if (file && file->get_sync_interval()) file_sync.push_back(file);
+            if (pages.prefault || pages.lock) mem_pages.push_back(pages);
+            mem_map[name] = std::move(mem);
         } else {
             std::ostringstream sstr;
             sstr << "invalid memory configuration: " << instr;
@@ -269,22 +818,159 @@ void Machine::parse_settings(const std::vector<std::string> &data) {
             throw std::runtime_error(sstr.str());
         }
 
-        if (split_instr[0] == "CYCLE_MS") {
+        if (split_instr[0] == "CYCLE_MS" || split_instr[0] == "CYCLE_US" || split_instr[0] == "CYCLE_NS") {
             if (split_instr.size() != 2) {
                 std::ostringstream sstr;
                 sstr << "invalid setting: " << instr;
                 throw std::runtime_error(sstr.str());
             }
 
+            if (applied_settings.count("CYCLE_MS") + applied_settings.count("CYCLE_US") +
+                applied_settings.count("CYCLE_NS")) {
+                std::ostringstream sstr;
+                sstr << "duplicate cycle time setting '" << split_instr[0] << "'";
+                throw std::runtime_error(sstr.str());
+            }
+
             const auto &value = split_instr[1];
             try {
-                this->cycle_time_ms = parse_unsigned(value);
+                const auto time = parse_unsigned(value);
+                if (time == 0) throw std::runtime_error("must not be zero");
+
+                if (split_instr[0] == "CYCLE_MS") this->cycle_time = std::chrono::milliseconds(time);
+                else if (split_instr[0] == "CYCLE_US")
+                    this->cycle_time = std::chrono::microseconds(time);
+                else
+                    this->cycle_time = std::chrono::nanoseconds(time);
             } catch (const std::exception &e) {
                 std::ostringstream sstr;
                 sstr << "failed to parse '" << value << "' as cycle time: " << e.what();
                 throw std::runtime_error(sstr.str());
             }
 
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "OVERRUN") {
+            if (split_instr.size() != 2) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr;
+                throw std::runtime_error(sstr.str());
+            }
+
+            const auto &value = split_instr[1];
+            if (value == "SKIP") {
+                overrun_policy = scheduler::overrun_t::skip;
+            } else if (value == "CATCHUP") {
+                overrun_policy = scheduler::overrun_t::catch_up;
+            } else {
+                std::ostringstream sstr;
+                sstr << "invalid overrun policy '" << value << "' (expected SKIP or CATCHUP)";
+                throw std::runtime_error(sstr.str());
+            }
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "WAIT") {
+            if (split_instr.size() < 2 || split_instr.size() > 3) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr << " (expected WAIT SLEEP|SPIN|HYBRID [<spin us>])";
+                throw std::runtime_error(sstr.str());
+            }
+
+            const auto spin = split_instr.size() == 3 ? split_instr[2] : std::string();
+            wait_policy     = scheduler::parse_wait(split_instr[1], spin);
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "SCHED") {
+            if (split_instr.size() < 2 || split_instr.size() > 3) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr << " (expected SCHED OTHER|FIFO|RR [<priority>])";
+                throw std::runtime_error(sstr.str());
+            }
+
+            rt::set_policy(rt_profile, split_instr[1], split_instr.size() == 3 ? split_instr[2] : std::string());
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "CPU") {
+            if (split_instr.size() != 2) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr << " (expected CPU <list>)";
+                throw std::runtime_error(sstr.str());
+            }
+
+            rt_profile.cpus = rt::parse_cpus(split_instr[1]);
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "MLOCKALL") {
+            if (split_instr.size() != 1) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr;
+                throw std::runtime_error(sstr.str());
+            }
+
+            rt_profile.lock_memory = true;
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "STACK_PREFAULT") {
+            if (split_instr.size() != 2) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr << " (expected STACK_PREFAULT <KiB>)";
+                throw std::runtime_error(sstr.str());
+            }
+
+            const auto &value = split_instr[1];
+            try {
+                rt_profile.stack_prefault = parse_unsigned(value) * 1024;
+            } catch (const std::exception &e) {
+                std::ostringstream sstr;
+                sstr << "failed to parse '" << value << "' as stack size: " << e.what();
+                throw std::runtime_error(sstr.str());
+            }
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "FAULT") {
+            if (split_instr.size() != 2) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr;
+                throw std::runtime_error(sstr.str());
+            }
+
+            const auto &value = split_instr[1];
+            if (value == "ABORT") {
+                fault_policy = fault_policy_t::abort;
+            } else if (value == "SKIP") {
+                fault_policy = fault_policy_t::skip;
+            } else if (value == "HANDLER") {
+                fault_policy = fault_policy_t::handler;
+            } else {
+                std::ostringstream sstr;
+                sstr << "invalid fault policy '" << value << "' (expected ABORT, SKIP or HANDLER)";
+                throw std::runtime_error(sstr.str());
+            }
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "TRIGGER") {
+            if (split_instr.size() < 2 || (split_instr[1] == "CHANGE" && split_instr.size() != 5) ||
+                (split_instr[1] == "FUTEX" && split_instr.size() != 3) ||
+                (split_instr[1] != "CHANGE" && split_instr[1] != "FUTEX")) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr
+                     << " (expected TRIGGER CHANGE <memory>@<cell> <cells> <poll ms> or TRIGGER FUTEX <memory>@<cell>)";
+                throw std::runtime_error(sstr.str());
+            }
+
+            // the trigger is created after section __MEM is parsed (see create_trigger)
+            trigger_setting = split_instr;
+
+            applied_settings.insert(split_instr[0]);
+        } else if (split_instr[0] == "NOTIFY") {
+            if (split_instr.size() != 2) {
+                std::ostringstream sstr;
+                sstr << "invalid setting: " << instr << " (expected NOTIFY <memory>@<cell>)";
+                throw std::runtime_error(sstr.str());
+            }
+
+            // created after section __MEM is parsed (see create_notify)
+            notify_setting = split_instr[1];
+
             applied_settings.insert(split_instr[0]);
         } else if (split_instr[0] == "CYCLES") {
             const auto &value = split_instr[1];
@@ -433,7 +1119,7 @@ void Machine::parse_var(const std::vector<std::string> &data) {
                     sstr << "failed to create variable: invalid memory address: '" << cell_str << "'";
                     throw std::runtime_error(sstr.str());
                 }
-                var_map.emplace(std::make_pair(name_str, var_t(*mem, Memory::dtype_t::le1, cell, index)));
+                var_map.emplace(std::make_pair(name_str, var_t(*mem, Memory::dtype_t::be1, cell, index)));
             } else if (data_type_str == "byte") {
                 check_cell_str(false);
                 var_map.emplace(std::make_pair(name_str, var_t(*mem, Memory::dtype_t::byte, cell)));
@@ -593,134 +1279,159 @@ void Machine::parse_init(const std::vector<std::string> &data) {
     }
 }
 
+template <typename Trace>
 void Machine::parse_program(const std::vector<std::string> &data) {
-    std::unordered_map<instr::Jump *, std::string> jump_targets;
+    std::unordered_map<std::size_t, std::string> jump_targets;
+
+    // append instruction to the reference instruction list and the bytecode program
+    auto emit = [this](std::unique_ptr<Instruction> &&instruction, const bytecode::op_t &op) {
+        instructions.emplace_back(std::move(instruction));
+        program.emit(op);
+    };
+
+    // append instruction that the bytecode engine executes via the instruction object
+    auto emit_exec = [this](std::unique_ptr<Instruction> &&instruction) {
+        auto &ref = *instruction;
+        instructions.emplace_back(std::move(instruction));
+        program.emit(bytecode::op_t(bytecode::opcode_t::EXEC, ref));
+    };
+
+    // create a specialized variable access (memory bounds are checked once here, not on each access)
+    auto make_var_access = [](const std::string &name, auto &&factory) {
+        try {
+            return factory();
+        } catch (const std::exception &e) {
+            std::ostringstream sstr;
+            sstr << "invalid access to variable '" << name << "': " << e.what();
+            throw std::runtime_error(sstr.str());
+        }
+    };
 
     for (auto &instr : data) {
         if (instr == "ADD") {
-            instructions.emplace_back(std::make_unique<instr::ADD>(stack_machine));
+            emit(std::make_unique<instr::ADD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ADD));
         } else if (instr == "SUB") {
-            instructions.emplace_back(std::make_unique<instr::SUB>(stack_machine));
+            emit(std::make_unique<instr::SUB<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::SUB));
         } else if (instr == "MUL") {
-            instructions.emplace_back(std::make_unique<instr::MUL>(stack_machine));
+            emit(std::make_unique<instr::MUL<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::MUL));
         } else if (instr == "MULS") {
-            instructions.emplace_back(std::make_unique<instr::MULS>(stack_machine));
+            emit(std::make_unique<instr::MULS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::MULS));
         } else if (instr == "DIV") {
-            instructions.emplace_back(std::make_unique<instr::DIV>(stack_machine));
+            emit(std::make_unique<instr::DIV<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::DIV));
         } else if (instr == "DIVS") {
-            instructions.emplace_back(std::make_unique<instr::DIVS>(stack_machine));
+            emit(std::make_unique<instr::DIVS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::DIVS));
         } else if (instr == "MOD") {
-            instructions.emplace_back(std::make_unique<instr::MOD>(stack_machine));
+            emit(std::make_unique<instr::MOD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::MOD));
         } else if (instr == "MODS") {
-            instructions.emplace_back(std::make_unique<instr::MODS>(stack_machine));
+            emit(std::make_unique<instr::MODS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::MODS));
         } else if (instr == "POW") {
-            instructions.emplace_back(std::make_unique<instr::POW>(stack_machine));
+            emit(std::make_unique<instr::POW<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::POW));
         } else if (instr == "POWS") {
-            instructions.emplace_back(std::make_unique<instr::POWS>(stack_machine));
+            emit(std::make_unique<instr::POWS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::POWS));
         } else if (instr == "ADDF") {
-            instructions.emplace_back(std::make_unique<instr::ADDF>(stack_machine));
+            emit(std::make_unique<instr::ADDF<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ADDF));
         } else if (instr == "SUBF") {
-            instructions.emplace_back(std::make_unique<instr::SUBF>(stack_machine));
+            emit(std::make_unique<instr::SUBF<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::SUBF));
         } else if (instr == "MULF") {
-            instructions.emplace_back(std::make_unique<instr::MULF>(stack_machine));
+            emit(std::make_unique<instr::MULF<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::MULF));
         } else if (instr == "POWF") {
-            instructions.emplace_back(std::make_unique<instr::POWF>(stack_machine));
+            emit(std::make_unique<instr::POWF<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::POWF));
         } else if (instr == "DIVF") {
-            instructions.emplace_back(std::make_unique<instr::DIVF>(stack_machine));
+            emit(std::make_unique<instr::DIVF<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::DIVF));
         } else if (instr == "ADDD") {
-            instructions.emplace_back(std::make_unique<instr::ADDD>(stack_machine));
+            emit(std::make_unique<instr::ADDD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ADDD));
         } else if (instr == "SUBD") {
-            instructions.emplace_back(std::make_unique<instr::SUBD>(stack_machine));
+            emit(std::make_unique<instr::SUBD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::SUBD));
         } else if (instr == "MULD") {
-            instructions.emplace_back(std::make_unique<instr::MULD>(stack_machine));
+            emit(std::make_unique<instr::MULD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::MULD));
         } else if (instr == "DIVD") {
-            instructions.emplace_back(std::make_unique<instr::DIVD>(stack_machine));
+            emit(std::make_unique<instr::DIVD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::DIVD));
         } else if (instr == "POWD") {
-            instructions.emplace_back(std::make_unique<instr::POWD>(stack_machine));
+            emit(std::make_unique<instr::POWD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::POWD));
         } else if (instr == "NOT") {
-            instructions.emplace_back(std::make_unique<instr::NOT>(stack_machine));
+            emit(std::make_unique<instr::NOT<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::NOT));
         } else if (instr == "AND") {
-            instructions.emplace_back(std::make_unique<instr::AND>(stack_machine));
+            emit(std::make_unique<instr::AND<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::AND));
         } else if (instr == "OR") {
-            instructions.emplace_back(std::make_unique<instr::OR>(stack_machine));
+            emit(std::make_unique<instr::OR<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::OR));
         } else if (instr == "XOR") {
-            instructions.emplace_back(std::make_unique<instr::XOR>(stack_machine));
+            emit(std::make_unique<instr::XOR<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::XOR));
         } else if (instr == "INV") {
-            instructions.emplace_back(std::make_unique<instr::INV>(stack_machine));
+            emit(std::make_unique<instr::INV<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::INV));
         } else if (instr == "BAND") {
-            instructions.emplace_back(std::make_unique<instr::BAND>(stack_machine));
+            emit(std::make_unique<instr::BAND<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::BAND));
         } else if (instr == "BOR") {
-            instructions.emplace_back(std::make_unique<instr::BOR>(stack_machine));
+            emit(std::make_unique<instr::BOR<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::BOR));
         } else if (instr == "BXOR") {
-            instructions.emplace_back(std::make_unique<instr::BXOR>(stack_machine));
+            emit(std::make_unique<instr::BXOR<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::BXOR));
         } else if (instr == "ITOF") {
-            instructions.emplace_back(std::make_unique<instr::ITOF>(stack_machine));
+            emit(std::make_unique<instr::ITOF<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ITOF));
         } else if (instr == "ITOD") {
-            instructions.emplace_back(std::make_unique<instr::ITOD>(stack_machine));
+            emit(std::make_unique<instr::ITOD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ITOD));
         } else if (instr == "FTOI") {
-            instructions.emplace_back(std::make_unique<instr::FTOI>(stack_machine));
+            emit(std::make_unique<instr::FTOI<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::FTOI));
         } else if (instr == "DTOI") {
-            instructions.emplace_back(std::make_unique<instr::DTOI>(stack_machine));
+            emit(std::make_unique<instr::DTOI<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::DTOI));
         } else if (instr == "FTOD") {
-            instructions.emplace_back(std::make_unique<instr::FTOD>(stack_machine));
+            emit(std::make_unique<instr::FTOD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::FTOD));
         } else if (instr == "DTOF") {
-            instructions.emplace_back(std::make_unique<instr::DTOF>(stack_machine));
+            emit(std::make_unique<instr::DTOF<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::DTOF));
         } else if (instr == "EQ") {
-            instructions.emplace_back(std::make_unique<instr::EQ>(stack_machine));
+            emit(std::make_unique<instr::EQ<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::EQ));
         } else if (instr == "NE") {
-            instructions.emplace_back(std::make_unique<instr::NE>(stack_machine));
+            emit(std::make_unique<instr::NE<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::NE));
         } else if (instr == "LT") {
-            instructions.emplace_back(std::make_unique<instr::LT>(stack_machine));
+            emit(std::make_unique<instr::LT<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LT));
         } else if (instr == "GT") {
-            instructions.emplace_back(std::make_unique<instr::GT>(stack_machine));
+            emit(std::make_unique<instr::GT<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::GT));
         } else if (instr == "LE") {
-            instructions.emplace_back(std::make_unique<instr::LE>(stack_machine));
+            emit(std::make_unique<instr::LE<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LE));
         } else if (instr == "GE") {
-            instructions.emplace_back(std::make_unique<instr::GE>(stack_machine));
+            emit(std::make_unique<instr::GE<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::GE));
         } else if (instr == "LTS") {
-            instructions.emplace_back(std::make_unique<instr::LTS>(stack_machine));
+            emit(std::make_unique<instr::LTS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LTS));
         } else if (instr == "GTS") {
-            instructions.emplace_back(std::make_unique<instr::GTS>(stack_machine));
+            emit(std::make_unique<instr::GTS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::GTS));
         } else if (instr == "LES") {
-            instructions.emplace_back(std::make_unique<instr::LES>(stack_machine));
+            emit(std::make_unique<instr::LES<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LES));
         } else if (instr == "GES") {
-            instructions.emplace_back(std::make_unique<instr::GES>(stack_machine));
+            emit(std::make_unique<instr::GES<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::GES));
         } else if (instr == "LTD") {
-            instructions.emplace_back(std::make_unique<instr::LTD>(stack_machine));
+            emit(std::make_unique<instr::LTD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LTD));
         } else if (instr == "GTD") {
-            instructions.emplace_back(std::make_unique<instr::GTD>(stack_machine));
+            emit(std::make_unique<instr::GTD<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::GTD));
         } else if (instr == "LED") {
-            instructions.emplace_back(std::make_unique<instr::LED>(stack_machine));
+            emit(std::make_unique<instr::LED<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LED));
         } else if (instr == "GED") {
-            instructions.emplace_back(std::make_unique<instr::GED>(stack_machine));
+            emit(std::make_unique<instr::GED<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::GED));
         } else if (instr == "DUP") {
-            instructions.emplace_back(std::make_unique<instr::DUP>(stack_machine));
+            emit(std::make_unique<instr::DUP<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::DUP));
         } else if (instr == "ABS") {
-            instructions.emplace_back(std::make_unique<instr::ABS>(stack_machine));
+            emit(std::make_unique<instr::ABS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ABS));
         } else if (instr == "SQRT") {
-            instructions.emplace_back(std::make_unique<instr::SQRT>(stack_machine));
+            emit(std::make_unique<instr::SQRT<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::SQRT));
         } else if (instr == "CBRT") {
-            instructions.emplace_back(std::make_unique<instr::CBRT>(stack_machine));
+            emit(std::make_unique<instr::CBRT<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::CBRT));
         } else if (instr == "LN") {
-            instructions.emplace_back(std::make_unique<instr::LN>(stack_machine));
+            emit(std::make_unique<instr::LN<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LN));
         } else if (instr == "LG") {
-            instructions.emplace_back(std::make_unique<instr::LG>(stack_machine));
+            emit(std::make_unique<instr::LG<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LG));
         } else if (instr == "LOG") {
-            instructions.emplace_back(std::make_unique<instr::LOG>(stack_machine));
+            emit(std::make_unique<instr::LOG<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::LOG));
         } else if (instr == "SIN") {
-            instructions.emplace_back(std::make_unique<instr::SIN>(stack_machine));
+            emit(std::make_unique<instr::SIN<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::SIN));
         } else if (instr == "COS") {
-            instructions.emplace_back(std::make_unique<instr::COS>(stack_machine));
+            emit(std::make_unique<instr::COS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::COS));
         } else if (instr == "TAN") {
-            instructions.emplace_back(std::make_unique<instr::TAN>(stack_machine));
+            emit(std::make_unique<instr::TAN<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::TAN));
         } else if (instr == "ASIN") {
-            instructions.emplace_back(std::make_unique<instr::ASIN>(stack_machine));
+            emit(std::make_unique<instr::ASIN<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ASIN));
         } else if (instr == "ACOS") {
-            instructions.emplace_back(std::make_unique<instr::ACOS>(stack_machine));
+            emit(std::make_unique<instr::ACOS<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ACOS));
         } else if (instr == "ATAN") {
-            instructions.emplace_back(std::make_unique<instr::ATAN>(stack_machine));
+            emit(std::make_unique<instr::ATAN<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ATAN));
         } else if (instr == "ATANXY" || instr == "ATAN2") {
-            instructions.emplace_back(std::make_unique<instr::ATANXY>(stack_machine));
+            emit(std::make_unique<instr::ATANXY<Trace>>(stack_machine), bytecode::op_t(bytecode::opcode_t::ATANXY));
         } else {
             const auto split_instr = split_string(instr, ' ');
 
@@ -741,7 +1452,7 @@ void Machine::parse_program(const std::vector<std::string> &data) {
                 }
 
                 label_pos[name] = instructions.size();
-                instructions.emplace_back(std::make_unique<instr::LABEL>(stack_machine, name));
+                emit(std::make_unique<instr::LABEL>(stack_machine, name), bytecode::op_t(bytecode::opcode_t::NOP));
                 continue;
             }
 
@@ -755,32 +1466,39 @@ void Machine::parse_program(const std::vector<std::string> &data) {
                 const auto &target = split_instr[1];
 
                 if (const_map.count(target)) {
-                    instructions.emplace_back(std::make_unique<instr::PUSH_const>(stack_machine, const_map.at(target)));
+                    auto &constant = const_map.at(target);
+                    emit(std::make_unique<instr::PUSH_const<Trace>>(stack_machine, constant),
+                         bytecode::op_t(bytecode::opcode_t::PUSH_CONST, constant.value));
                 } else if (var_map.count(target)) {
-                    instructions.emplace_back(std::make_unique<instr::PUSH_var>(stack_machine, var_map.at(target)));
+                    auto &var = var_map.at(target);
+                    emit(make_var_access(target, [&] { return instr::make_push<Trace>(stack_machine, var); }),
+                         bytecode::op_t(bytecode::opcode_t::PUSH_VAR, var));
                 } else {
-                    if (target == "STIME") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_stime>(stack_machine));
+                    if (target == "FAULT") {
+                        emit(make_var_access(target, [&] { return instr::make_push<Trace>(stack_machine, fault_var); }),
+                             bytecode::op_t(bytecode::opcode_t::PUSH_VAR, fault_var));
+                    } else if (target == "STIME") {
+                        emit_exec(std::make_unique<instr_special::PUSH_stime<Trace>>(stack_machine));
                     } else if (target == "MTIME") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_mtime>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_mtime<Trace>>(stack_machine));
                     } else if (target == "CTIME") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_ctime>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_ctime<Trace>>(stack_machine));
                     } else if (target == "TTIME") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_ttime>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_ttime<Trace>>(stack_machine));
                     } else if (target == "PID") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_pid>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_pid<Trace>>(stack_machine));
                     } else if (target == "PPID") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_ppid>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_ppid<Trace>>(stack_machine));
                     } else if (target == "UID") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_uid>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_uid<Trace>>(stack_machine));
                     } else if (target == "EUID") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_euid>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_euid<Trace>>(stack_machine));
                     } else if (target == "RAND") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_rand>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_rand<Trace>>(stack_machine));
                     } else if (target == "RANDF") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_randf>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_randf<Trace>>(stack_machine));
                     } else if (target == "RANDD") {
-                        instructions.emplace_back(std::make_unique<instr_special::PUSH_randd>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::PUSH_randd<Trace>>(stack_machine));
                     } else {
                         std::ostringstream sstr;
                         sstr << "failed to pares instruction '" << instr << "': unknown variable '" << target << "'";
@@ -792,18 +1510,21 @@ void Machine::parse_program(const std::vector<std::string> &data) {
                 const auto &target = split_instr[1];
 
                 if (var_map.count(target)) {
-                    instructions.emplace_back(std::make_unique<instr::POP_var>(stack_machine, var_map.at(target)));
+                    auto &var = var_map.at(target);
+                    emit(make_var_access(target, [&] { return instr::make_pop<Trace>(stack_machine, var); }),
+                         bytecode::op_t(bytecode::opcode_t::POP_VAR, var));
                 } else {
                     if (target == "STDOUT") {
-                        instructions.emplace_back(std::make_unique<instr_special::POP_stdout>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::POP_stdout<Trace>>(stack_machine));
                     } else if (target == "STDOUTS") {
-                        instructions.emplace_back(std::make_unique<instr_special::POP_stdouts>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::POP_stdouts<Trace>>(stack_machine));
                     } else if (target == "STDOUTF") {
-                        instructions.emplace_back(std::make_unique<instr_special::POP_stdoutf>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::POP_stdoutf<Trace>>(stack_machine));
                     } else if (target == "STDOUTD") {
-                        instructions.emplace_back(std::make_unique<instr_special::POP_stdoutd>(stack_machine));
+                        emit_exec(std::make_unique<instr_special::POP_stdoutd<Trace>>(stack_machine));
                     } else if (target == "NULL") {
-                        instructions.emplace_back(std::make_unique<instr_special::POP_NULL>(stack_machine));
+                        emit(std::make_unique<instr_special::POP_NULL<Trace>>(stack_machine),
+                             bytecode::op_t(bytecode::opcode_t::POP_NULL));
                     } else {
                         std::ostringstream sstr;
                         sstr << "failed to pares instruction '" << instr << "': unknown variable '" << target << "'";
@@ -811,21 +1532,21 @@ void Machine::parse_program(const std::vector<std::string> &data) {
                     }
                 }
             } else if (split_instr[0] == "J") {
-                instructions.emplace_back(std::make_unique<instr::J>(stack_machine));
-                jump_targets[dynamic_cast<instr::Jump *>(instructions.back().get())] = split_instr[1];
+                jump_targets[instructions.size()] = split_instr[1];
+                emit(std::make_unique<instr::J>(stack_machine, ip), bytecode::op_t(bytecode::opcode_t::J));
             } else if (split_instr[0] == "JZ") {
-                instructions.emplace_back(std::make_unique<instr::JZ>(stack_machine, ip));
-                jump_targets[dynamic_cast<instr::Jump *>(instructions.back().get())] = split_instr[1];
+                jump_targets[instructions.size()] = split_instr[1];
+                emit(std::make_unique<instr::JZ<Trace>>(stack_machine, ip), bytecode::op_t(bytecode::opcode_t::JZ));
             } else if (split_instr[0] == "JNZ") {
-                instructions.emplace_back(std::make_unique<instr::JNZ>(stack_machine, ip));
-                jump_targets[dynamic_cast<instr::Jump *>(instructions.back().get())] = split_instr[1];
+                jump_targets[instructions.size()] = split_instr[1];
+                emit(std::make_unique<instr::JNZ<Trace>>(stack_machine, ip), bytecode::op_t(bytecode::opcode_t::JNZ));
             }
         }
     }
 
     // assign jump targets
     for (auto &a : jump_targets) {
-        auto &jump       = a.first;
+        auto &jump_pos   = a.first;
         auto &label_name = a.second;
 
         if (!label_pos.count(label_name)) {
@@ -834,9 +1555,10 @@ void Machine::parse_program(const std::vector<std::string> &data) {
             throw std::runtime_error(sstr.str());
         }
 
-        jump->set_target(label_pos[label_name]);
+        dynamic_cast<instr::Jump *>(instructions.at(jump_pos).get())->set_target(label_pos[label_name]);
+        program.at(jump_pos).arg.target = label_pos[label_name];
     }
 
     // add end instruction
-    instructions.emplace_back(std::make_unique<instr::END>(stack_machine));
+    emit(std::make_unique<instr::END>(stack_machine), bytecode::op_t(bytecode::opcode_t::END));
 }
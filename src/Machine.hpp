@@ -8,32 +8,101 @@
 
 #include "Memory.hpp"
 #include "StackMachine.hpp"
+#include "aot.hpp"
+#include "bytecode.hpp"
+#include "cycle_log.hpp"
+#include "jit.hpp"
 #include "instruction.hpp"
+#include "optimize.hpp"
+#include "rt.hpp"
+#include "scheduler.hpp"
+#include "trigger.hpp"
 
+#include <chrono>
 #include <memory>
+#include <ostream>
 #include <unordered_map>
 #include <utility>
 
 class Machine {
+public:
+    /**
+     * @brief execution engines
+     */
+    enum class engine_t {
+        reference,  //*< execute the instruction objects (virtual exec() per instruction)
+        bytecode,   //*< execute the flat bytecode program (threaded dispatch loop)
+        jit,        //*< execute native code generated from the bytecode program (falls back to bytecode)
+        aot,        //*< execute a shared object that was compiled ahead of time (see set_aot_library)
+    };
+
+    /**
+     * @brief reaction to a runtime fault (setting FAULT, see StackMachine::fault_t)
+     */
+    enum class fault_policy_t {
+        abort,    //*< stop the execution with an error (ABORT, default)
+        skip,     //*< skip the rest of the cycle (SKIP)
+        handler,  //*< skip the rest of the cycle and execute the program at label $FAULT (HANDLER)
+    };
+
 private:
+    /**
+     * @brief memory that is prepared at load time (options prefault, mlock and hugepages of section __MEM)
+     */
+    struct mem_pages_t {
+        std::string name;      //*< memory name
+        Memory     *mem;       //*< memory
+        bool        prefault;  //*< fault in all pages
+        bool        lock;      //*< lock all pages in RAM
+    };
+
     bool                                                     verbose;
-    std::size_t                                              cycle_time_ms = 1000;
-    std::size_t                                              cycles        = 0;
-    std::size_t                                              cycle_counter = 0;
+    bool                                                     debug;
+    engine_t                                                 engine;
+    std::chrono::nanoseconds                                 cycle_time     = std::chrono::milliseconds(1000);
+    scheduler::overrun_t                                     overrun_policy = scheduler::overrun_t::skip;
+    scheduler::wait_policy_t                                 wait_policy;
+    rt::profile_t                                            rt_profile;
+    std::size_t                                              cycles         = 0;
+    std::size_t                                              cycle_counter  = 0;
+    fault_policy_t                                           fault_policy   = fault_policy_t::abort;
     StackMachine                                             stack_machine;
     std::unordered_map<std::string, std::unique_ptr<Memory>> mem_map;
+    SharedMemoryCache                                       *shm_cache = nullptr;
+    std::vector<MemoryReal *>                                process_image;    //*< memories with process image
+    std::vector<MemoryReal *>                                bit_cache;        //*< memories with bit cache
+    std::vector<MemoryFile *>                                file_sync;        //*< files that are synchronized (msync)
+    std::vector<mem_pages_t>                                 mem_pages;        //*< memories prepared at load time
+    std::vector<std::string>                                 trigger_setting;  //*< setting TRIGGER (split)
+    std::unique_ptr<trigger::Trigger>                        trigger;          //*< event driven execution
+    std::string                                              notify_setting;   //*< setting NOTIFY
+    std::unique_ptr<trigger::Notify>                         notify;           //*< notification after each cycle
+    std::chrono::steady_clock::time_point                    cycle_start;      //*< begin of the current cycle
     std::unordered_map<std::string, var_t>                   var_map;
     std::unordered_map<std::string, const_t>                 const_map;
     std::vector<std::unique_ptr<Instruction>>                instructions;
     std::unordered_map<std::string, std::size_t>             label_pos;
+    std::vector<std::string>                                 program_source;
+    bytecode::Program                                        program;
+    bytecode::optimize_result_t                              optimized;
+    bytecode::verify_result_t                                stack_depth;
+    std::unique_ptr<jit::Program>                            jit_program;
+    std::string                                              aot_library;
+    std::unique_ptr<aot::Program>                            aot_program;
+    std::string                                              task_name  = "main";   //*< task name
+    std::vector<std::unique_ptr<Machine>>                    tasks;                 //*< named program sections
+    bytecode::Preemption                                    *preemption = nullptr;  //*< see set_preemption
+    cycle_log::Reporter::Source                             *fault_log  = nullptr;  //*< see set_fault_log
+    MemoryLocal                                              fault_mem {1};
+    var_t                                                    fault_var {fault_mem, Memory::dtype_t::le64, 0};
 
     std::size_t ip = 0;
 
     // TODO instruction list
     // TODO instruction pointer
 public:
-    explicit Machine(std::size_t stack_size, bool verbose, bool debug)
-        : stack_machine(debug, stack_size), verbose(verbose) {}
+    explicit Machine(std::size_t stack_size, bool verbose, bool debug, engine_t engine = engine_t::bytecode)
+        : verbose(verbose), debug(debug), engine(engine), stack_machine(stack_size) {}
 
     void load_file(const std::string &path);
 
@@ -41,13 +110,161 @@ public:
 
     void run();
 
-    inline std::size_t get_cycle_time_ms() const { return cycle_time_ms; }
-    inline std::size_t get_cycles() const { return cycles; }
+    /**
+     * @brief check if the cycles are triggered by input changes (setting TRIGGER)
+     * @details the cycle time (CYCLE_MS/US/NS) is the max interval between two cycles in this case
+     */
+    inline bool has_trigger() const { return static_cast<bool>(trigger); }
+
+    /**
+     * @brief wait until the trigger fires or the cycle time since the begin of the last cycle elapsed
+     * @details returns early if the wait is interrupted by a signal
+     * @return true: triggered, false: cycle time elapsed or interrupted
+     * @exception std::logic_error no trigger
+     */
+    bool wait_trigger();
+
+    inline std::chrono::nanoseconds get_cycle_time() const { return cycle_time; }
+    inline scheduler::overrun_t     get_overrun_policy() const { return overrun_policy; }
+    inline scheduler::wait_policy_t get_wait_policy() const { return wait_policy; }
+    inline const rt::profile_t     &get_rt_profile() const { return rt_profile; }
+    inline std::size_t              get_cycles() const { return cycles; }
+    inline engine_t                 get_engine() const { return engine; }
+    inline const std::string       &get_task_name() const { return task_name; }
+
+    /**
+     * @brief get the tasks (sections __PROGRAM <task> <period>)
+     * @details
+     *   Each task is a machine that shares the memories and variables of this machine. The cycle time of a task is its
+     *   period. Only run is called for a task; init, image and bit cache handling are done by this machine.
+     *   Valid after load_file.
+     * @return tasks (empty: single program)
+     */
+    inline const std::vector<std::unique_ptr<Machine>> &get_tasks() const { return tasks; }
+
+    /**
+     * @brief make the program preemptible
+     * @details
+     *   The preemption request is checked at each jump (bytecode engine) or each instruction (reference engine).
+     *   Native code (jit, aot) can not be preempted, the machine falls back to the bytecode engine.
+     * @param request preemption request (has to outlive the machine)
+     */
+    void set_preemption(bytecode::Preemption *request);
+
+    /**
+     * @brief report the cycles that are skipped because of a fault (FAULT SKIP) via the reporter thread
+     * @details without a cycle log, a warning is printed by run for each skipped cycle
+     * @param log cycle log of the machine (has to outlive the machine, nullptr: none)
+     */
+    inline void set_fault_log(cycle_log::Reporter::Source *log) { fault_log = log; }
+
+    /**
+     * @brief set the shared object that is executed by the aot engine
+     * @details has to be called before load_file
+     * @param path path of the shared object (created by shm-stack-machine-aot)
+     */
+    inline void set_aot_library(const std::string &path) { aot_library = path; }
+
+    /**
+     * @brief map the shared memories via a cache that is shared with other machines (host mode)
+     * @details has to be called before load_file
+     * @param cache shared memory cache (has to outlive the machine)
+     */
+    inline void set_shm_cache(SharedMemoryCache *cache) { shm_cache = cache; }
+
+    /**
+     * @brief get the bytecode program
+     * @details valid after load_file
+     * @return bytecode program
+     */
+    inline const bytecode::Program &get_program() const { return program; }
+
+    /**
+     * @brief get the stack depths of the bytecode program
+     * @details valid after load_file
+     * @return stack depths
+     */
+    inline const bytecode::verify_result_t &get_stack_depth() const { return stack_depth; }
+
+    /**
+     * @brief print the optimized bytecode program
+     * @details
+     *   One line per operation: index, opcode, operand and the instructions of section __PROGRAM the operation was
+     *   generated from. The programs of the tasks follow. Valid after load_file.
+     * @param out output stream
+     */
+    void print_listing(std::ostream &out) const;
 
 private:
+    /**
+     * @brief create a task of a machine
+     * @details the task copies the settings, variables and constants of the machine
+     * @param main machine that owns the task (section __MEM, __VAR and __INIT are parsed)
+     * @param name task name
+     * @param period task period (cycle time)
+     */
+    Machine(const Machine &main, std::string name, std::chrono::nanoseconds period);
+
+    /**
+     * @brief parse, verify and optimize a section __PROGRAM and set up the execution engine
+     * @param section instructions of the section
+     * @param section_name section name (messages)
+     */
+    void compile_program(std::vector<std::string> section, const std::string &section_name);
+
+    /**
+     * @brief execute the program once with the selected engine
+     * @details stops at the end of the program or at the first fault (see StackMachine::get_fault)
+     */
+    void run_program();
+
     void parse_mem(const std::vector<std::string> &data);
     void parse_settings(const std::vector<std::string> &data);
     void parse_var(const std::vector<std::string> &data);
     void parse_init(const std::vector<std::string> &data);
+
+    /**
+     * @brief parse section __PROGRAM
+     * @tparam Trace tracing policy of the created instructions (tracing::on in debug mode)
+     */
+    template <typename Trace>
     void parse_program(const std::vector<std::string> &data);
+
+    /**
+     * @brief remove labels and unreachable instructions from the instruction list, collapse jump chains
+     * @details label_pos is adjusted to the new instruction indices
+     */
+    void cleanup_instructions();
+
+    /**
+     * @brief prefault and lock the pages of the memories (see mem_pages); the number of pages is reported if verbose
+     * @details called at the end of load_file, so no page faults occur in the first cycles
+     * @exception std::runtime_error failed to lock a memory
+     */
+    void prepare_pages();
+
+    /**
+     * @brief resolve the address <memory>@<cell> of a setting
+     * @param setting setting name (error message)
+     * @param addr_str <memory>@<cell>
+     * @param begin byte index of the cell
+     * @return memory (shared memory or file)
+     * @exception std::runtime_error invalid address
+     */
+    MemoryReal &resolve_cell(const std::string &setting, const std::string &addr_str, std::size_t &begin);
+
+    /**
+     * @brief create the trigger from setting TRIGGER
+     * @details called after section __MEM is parsed
+     * @exception std::runtime_error invalid trigger
+     */
+    void create_trigger();
+
+    /**
+     * @brief create the notification from setting NOTIFY
+     * @details called after section __MEM is parsed
+     * @exception std::runtime_error invalid address
+     */
+    void create_notify();
 };
+
@@ -5,18 +5,139 @@
 
 #include "Memory.hpp"
 
-#include "cxxendian/endian.hpp"
+#include "memory_access.hpp"
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <fcntl.h>
+#include <sstream>
 #include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @brief get the pages of an address range
+ * @param addr begin of the address range
+ * @param size size of the address range in bytes
+ * @param begin page aligned begin of the address range
+ * @return number of pages
+ */
+static std::size_t page_range(void *addr, std::size_t size, uint8_t *&begin) {
+    const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto first     = reinterpret_cast<uintptr_t>(addr) & ~(page_size - 1);
+    const auto last      = (reinterpret_cast<uintptr_t>(addr) + size + page_size - 1) & ~(page_size - 1);
+    begin                = reinterpret_cast<uint8_t *>(first);
+    return (last - first) / page_size;
+}
+
+std::size_t Memory::prefault() {
+    const auto  page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t pages     = 0;
+
+    for (const auto &region : get_regions()) {
+        if (region.size == 0) continue;
+
+        uint8_t   *begin;
+        const auto n = page_range(region.addr, region.size, begin);
+        pages += n;
+
+        if (region.file) {
+#ifdef MADV_POPULATE_READ
+            if (madvise(begin, n * page_size, MADV_POPULATE_READ) == 0) continue;
+#endif
+
+            // fallback: read each page (maps the page cache of the file without marking it dirty)
+            for (std::size_t i = 0; i < n; ++i)
+                static_cast<void>(__atomic_load_n(begin + i * page_size, __ATOMIC_RELAXED));
+            continue;
+        }
+
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(begin, n * page_size, MADV_POPULATE_WRITE) == 0) continue;
+#endif
+
+        // fallback: write each page without modifying it (other processes may write to a shared memory)
+        for (std::size_t i = 0; i < n; ++i)
+            __atomic_fetch_add(begin + i * page_size, 0, __ATOMIC_RELAXED);
+    }
+
+    return pages;
+}
+
+std::size_t Memory::lock() {
+    std::size_t pages = 0;
+
+    for (const auto &region : get_regions()) {
+        if (region.size == 0) continue;
+
+        uint8_t *begin;
+        pages += page_range(region.addr, region.size, begin);
+
+        if (mlock(region.addr, region.size)) {
+            std::ostringstream sstr;
+            sstr << "failed to lock memory: " << std::strerror(errno);
+            if (errno == ENOMEM || errno == EPERM) sstr << " (check RLIMIT_MEMLOCK / ulimit -l)";
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    return pages;
+}
+
+MemoryLocal::~MemoryLocal() {
+    if (mapping) munmap(mapping, mapping_size);
+}
+
+MemoryLocal::huge_page_t MemoryLocal::enable_huge_pages() {
+    if (mapping) return huge_pages;
+
+    const auto bytes = size * sizeof(StackMachine::stack_t);
+    mapping_size     = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (mapping_size == 0) mapping_size = HUGE_PAGE_SIZE;
+
+    void *addr = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (addr != MAP_FAILED) {
+        mapping    = addr;
+        mem        = static_cast<StackMachine::stack_t *>(addr);
+        huge_pages = huge_page_t::hugetlb;
+    } else {
+        // no reserved huge pages: align to a huge page and use transparent huge pages
+        const auto reserve = mapping_size + HUGE_PAGE_SIZE;
+        addr               = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            mapping_size = 0;
+            std::ostringstream sstr;
+            sstr << "failed to allocate local memory: " << std::strerror(errno);
+            throw std::runtime_error(sstr.str());
+        }
+
+        const auto base    = reinterpret_cast<uintptr_t>(addr);
+        const auto aligned = (base + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        if (aligned != base) munmap(addr, aligned - base);
+        if (aligned + mapping_size != base + reserve)
+            munmap(reinterpret_cast<void *>(aligned + mapping_size), base + reserve - aligned - mapping_size);
+
+        mapping = reinterpret_cast<void *>(aligned);
+        mem     = static_cast<StackMachine::stack_t *>(mapping);
+        madvise(mapping, mapping_size, MADV_HUGEPAGE);
+        huge_pages = huge_page_t::transparent;
+    }
+
+    // anonymous mappings are zero initialized
+    storage.clear();
+    storage.shrink_to_fit();
+    return huge_pages;
+}
 
 StackMachine::stack_t MemoryLocal::load(std::size_t cell, Memory::dtype_t, std::size_t) const {
-    if (cell >= mem.size()) throw std::out_of_range("memory cell out of range");
+    if (cell >= size) throw std::out_of_range("memory cell out of range");
     return mem[cell];
 }
 
 void MemoryLocal::store(StackMachine::stack_t data, std::size_t cell, Memory::dtype_t data_type, std::size_t) {
-    if (cell >= mem.size()) throw std::out_of_range("memory cell out of range");
+    if (cell >= size) throw std::out_of_range("memory cell out of range");
 
     StackMachine::stack_t mask;
     switch (data_type) {
@@ -51,226 +172,344 @@ MemoryReal::MemoryReal(std::size_t cell_size) : Memory(), cell_size(cell_size) {
 }
 
 StackMachine::stack_t MemoryReal::load(std::size_t cell, Memory::dtype_t data_type, std::size_t index) const {
-    switch (data_type) {
-        case Memory::dtype_t::le1: return load_bit(cell, index, true);
-        case Memory::dtype_t::be1: return load_bit(cell, index, false);
-        case Memory::dtype_t::byte: return load_byte(cell);
-        case Memory::dtype_t::le16: return load_16(cell, true);
-        case Memory::dtype_t::be16: return load_16(cell, false);
-        case Memory::dtype_t::le32: return load_32(cell, true, false);
-        case Memory::dtype_t::be32: return load_32(cell, false, false);
-        case Memory::dtype_t::le32r: return load_32(cell, true, true);
-        case Memory::dtype_t::be32r: return load_32(cell, false, true);
-        case Memory::dtype_t::le64: return load_64(cell, true, 0);
-        case Memory::dtype_t::be64: return load_64(cell, false, 0);
-        case Memory::dtype_t::le64r: return load_64(cell, true, 2);
-        case Memory::dtype_t::be64r: return load_64(cell, false, 2);
-        case Memory::dtype_t::le64r4: return load_64(cell, true, 4);
-        case Memory::dtype_t::be64r4: return load_64(cell, false, 4);
-    }
+    const auto addr = get_data(check_access(cell, data_type, index));
+    return mem_access::accessor(data_type, cell_size).load(addr, index);
 }
 
 void MemoryReal::store(StackMachine::stack_t data, std::size_t cell, Memory::dtype_t data_type, std::size_t index) {
-    switch (data_type) {
-        case Memory::dtype_t::le1: return store_bit(data, cell, index, true);
-        case Memory::dtype_t::be1: return store_bit(data, cell, index, false);
-        case Memory::dtype_t::byte: return store_byte(data, cell);
-        case Memory::dtype_t::le16: return store_16(data, cell, true);
-        case Memory::dtype_t::be16: return store_16(data, cell, false);
-        case Memory::dtype_t::le32: return store_32(data, cell, true, false);
-        case Memory::dtype_t::be32: return store_32(data, cell, false, false);
-        case Memory::dtype_t::le32r: return store_32(data, cell, true, true);
-        case Memory::dtype_t::be32r: return store_32(data, cell, false, true);
-        case Memory::dtype_t::le64: return store_64(data, cell, true, 0);
-        case Memory::dtype_t::be64: return store_64(data, cell, false, 0);
-        case Memory::dtype_t::le64r: return store_64(data, cell, true, 2);
-        case Memory::dtype_t::be64r: return store_64(data, cell, false, 2);
-        case Memory::dtype_t::le64r4: return store_64(data, cell, true, 4);
-        case Memory::dtype_t::be64r4: return store_64(data, cell, false, 4);
+    const auto addr = get_data(check_access(cell, data_type, index));
+    mem_access::accessor(data_type, cell_size).store(addr, index, data);
+}
+
+void *MemoryReal::get_cell_addr(std::size_t cell, std::size_t size) {
+    if (cell_size > size) {
+        std::ostringstream sstr;
+        sstr << "Memory cell size is to large to access " << size * 8 << " bit.";
+        throw std::runtime_error(sstr.str());
     }
+    if ((cell * cell_size + size - 1) >= get_size()) throw std::out_of_range("memory cell out of range");
+    return access(cell * cell_size, size);
 }
 
-StackMachine::stack_t MemoryReal::load_bit(std::size_t cell, std::size_t index, bool little_endian) const {
-    if (cell >= get_size() / cell_size) throw std::out_of_range("memory cell out of range");
-    if (index >= cell * 8) throw std::out_of_range("bit index out of range");
+void *MemoryReal::get_var_addr(std::size_t cell, Memory::dtype_t data_type, std::size_t index) {
+    return access(check_access(cell, data_type, index), mem_access::access_size(data_type, cell_size));
+}
 
-    switch (cell_size) {
-        case 1: {
-            uint8_t data = *reinterpret_cast<const uint8_t *>(get_data(cell * cell_size));
-            uint8_t ret  = (data >> index) & 0x1;
-            return ret;
-        }
-        case 2: {
-            uint16_t data = *reinterpret_cast<const uint8_t *>(get_data(cell * cell_size));
-            if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);
-            uint16_t ret = (data >> index) & 0x1;
-            return ret;
-        }
-        case 4: {
-            uint32_t data = *reinterpret_cast<const uint32_t *>(get_data(cell * cell_size));
-            if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);
-            uint32_t ret = (data >> index) & 0x1;
-            return ret;
-        }
+void *MemoryReal::get_range_addr(std::size_t begin, std::size_t size) {
+    if (size == 0 || begin >= get_size() || get_size() - begin < size)
+        throw std::out_of_range("memory range out of range");
+    return get_data(begin);
+}
 
-        case 8: {
-            uint64_t data = *reinterpret_cast<const uint64_t *>(get_data(cell * cell_size));
-            if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);
-            uint64_t ret = (data >> index) & 0x1;
-            return ret;
-        }
+void *MemoryReal::access(std::size_t begin, std::size_t size) {
+    if (has_seqlock() && begin < seqlock_offset + sizeof(uint64_t) && seqlock_offset < begin + size)
+        throw std::runtime_error("variable overlaps the seqlock sequence counter");
+
+    // insert sorted and merge overlapping ranges (adjacent ranges stay separated, see image_write)
+    range_t range {begin, begin + size};
+    auto    it = std::lower_bound(
+            ranges.begin(), ranges.end(), range, [](const range_t &a, const range_t &b) { return a.end <= b.begin; });
+    while (it != ranges.end() && it->begin < range.end) {
+        range.begin = std::min(range.begin, it->begin);
+        range.end   = std::max(range.end, it->end);
+        it          = ranges.erase(it);
     }
+    ranges.insert(it, range);
+
+    // coalesce ranges that are close to each other for image_read
+    read.clear();
+    for (const auto &r : ranges) {
+        if (!read.empty() && r.begin - read.back().end <= IMAGE_GAP) read.back().end = r.end;
+        else
+            read.push_back(r);
+    }
+
+    return image.empty() ? get_data(begin) : image.data() + begin;
+}
 
-    throw std::runtime_error("internal program error: cell size is invalid");
+std::vector<Memory::region_t> MemoryReal::get_regions() {
+    std::vector<region_t> regions {{get_data(0), get_size(), true}};
+    if (has_image()) {
+        regions.push_back({image.data(), image.size(), false});
+        regions.push_back({dirty.data(), dirty.size(), false});
+    }
+    return regions;
 }
 
-StackMachine::stack_t MemoryReal::load_byte(std::size_t cell) const {
-    if (cell_size != 1) throw std::runtime_error("Memory cell size is to large to load 8 bit.");
-    if (cell >= get_size()) throw std::out_of_range("memory cell out of range");
-    return *reinterpret_cast<const uint8_t *>(get_data(cell * cell_size));
+void MemoryReal::enable_bit_cache(bool atomic) {
+    if (!ranges.empty()) throw std::logic_error("bit cache has to be enabled before variables are resolved");
+    bit_cache  = true;
+    bit_atomic = atomic;
 }
 
-StackMachine::stack_t MemoryReal::load_16(std::size_t cell, bool little_endian) const {
-    if (cell_size > 2) throw std::runtime_error("Memory cell size is to large to load 16 bit.");
-    if ((cell * cell_size + 1) >= get_size()) throw std::out_of_range("memory cell out of range");
+void *MemoryReal::get_bit_cell(std::size_t cell, Memory::dtype_t data_type, std::size_t index) {
+    if (!bit_cache) throw std::logic_error("memory has no bit cache");
+    if (!mem_access::is_bit(data_type)) throw std::logic_error("not a bit data type");
+
+    auto      *addr  = get_var_addr(cell, data_type, index);
+    const auto begin = cell * cell_size;
+
+    auto it = bit_cells.find(begin);
+    if (it == bit_cells.end()) it = bit_cells.emplace(begin, bit_cell_t {addr}).first;
+    return &it->second;
+}
 
-    auto data = *reinterpret_cast<const uint16_t *>(get_data(cell * cell_size));
-    if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);
+/**
+ * @brief read a memory cell of bit variables
+ * @tparam W memory cell type
+ */
+template <typename W>
+static uint64_t read_bits(const void *addr) {
+    W data;
+    std::memcpy(&data, addr, sizeof(data));
     return data;
 }
 
-StackMachine::stack_t MemoryReal::load_32(std::size_t cell, bool little_endian, bool reg_swap) const {
-    if (cell_size > 4) throw std::runtime_error("Memory cell size is to large to load 16 bit.");
-    if ((cell * cell_size + 3) >= get_size()) throw std::out_of_range("memory cell out of range");
+/**
+ * @brief apply the modified bits of a memory cell
+ * @tparam W memory cell type
+ */
+template <typename W>
+static void write_bits(void *addr, uint64_t set, uint64_t clear, bool atomic) {
+    if (atomic) {
+        auto &data = *static_cast<std::atomic<W> *>(addr);
+        if (set) data.fetch_or(static_cast<W>(set));
+        if (clear) data.fetch_and(static_cast<W>(~clear));
+    } else {
+        W data;
+        std::memcpy(&data, addr, sizeof(data));
+        data = static_cast<W>((data & ~clear) | set);
+        std::memcpy(addr, &data, sizeof(data));
+    }
+}
+
+void MemoryReal::bits_read() {
+    for (auto &a : bit_cells) {
+        auto &cell = a.second;
+        switch (cell_size) {
+            case 1: cell.value = read_bits<uint8_t>(cell.addr); break;
+            case 2: cell.value = read_bits<uint16_t>(cell.addr); break;
+            case 4: cell.value = read_bits<uint32_t>(cell.addr); break;
+            case 8: cell.value = read_bits<uint64_t>(cell.addr); break;
+            default: throw std::logic_error("invalid memory cell size");
+        }
+        cell.set   = 0;
+        cell.clear = 0;
+    }
+}
 
-    union {
-        uint32_t data;
-        uint16_t reg16[2];
-    };
-    data = *reinterpret_cast<const uint32_t *>(get_data(cell * cell_size));
-    if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);
-    if (reg_swap) std::swap(reg16[0], reg16[1]);
-    return data;
+void MemoryReal::bits_write() {
+    // the process image is private --> no atomic operations required
+    const bool atomic = bit_atomic && !has_image();
+
+    for (auto &a : bit_cells) {
+        auto &cell = a.second;
+        if (!cell.set && !cell.clear) continue;
+        if (has_image()) dirty[a.first] = 1;
+
+        switch (cell_size) {
+            case 1: write_bits<uint8_t>(cell.addr, cell.set, cell.clear, atomic); break;
+            case 2: write_bits<uint16_t>(cell.addr, cell.set, cell.clear, atomic); break;
+            case 4: write_bits<uint32_t>(cell.addr, cell.set, cell.clear, atomic); break;
+            case 8: write_bits<uint64_t>(cell.addr, cell.set, cell.clear, atomic); break;
+            default: throw std::logic_error("invalid memory cell size");
+        }
+        cell.set   = 0;
+        cell.clear = 0;
+    }
 }
 
-StackMachine::stack_t MemoryReal::load_64(std::size_t cell, bool little_endian, std::size_t reg_swap) const {
-    if (cell_size > 4) throw std::runtime_error("Memory cell size is to large to load 16 bit.");
-    if ((cell * cell_size + 7) >= get_size()) throw std::out_of_range("memory cell out of range");
+void MemoryReal::enable_image() {
+    if (!ranges.empty()) throw std::logic_error("process image has to be enabled before variables are resolved");
+    image.resize(get_size());
+    dirty.resize(get_size());
+}
 
-    union {
-        uint64_t data;
-        uint16_t reg16[4];
-        uint32_t reg32[2];
-    };
-    data = *reinterpret_cast<const uint32_t *>(get_data(cell * cell_size));
-    if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);
-    if (reg_swap == 4) std::swap(reg32[0], reg32[1]);
-    else if (reg_swap == 2) {
-        std::swap(reg16[0], reg16[3]);
-        std::swap(reg16[1], reg16[2]);
+void MemoryReal::enable_seqlock(std::size_t offset) {
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "seqlock requires lock free 64 bit atomics");
+
+    if (!ranges.empty()) throw std::logic_error("seqlock has to be enabled before variables are resolved");
+
+    if (offset % alignof(std::atomic<uint64_t>) != 0 || offset > get_size() || get_size() - offset < sizeof(uint64_t)) {
+        std::ostringstream sstr;
+        sstr << "invalid seqlock offset " << offset << " (memory size: " << get_size()
+             << ", the sequence counter requires 8 aligned bytes)";
+        throw std::runtime_error(sstr.str());
     }
-    return data;
+
+    if (!has_image()) enable_image();
+    seqlock_offset = offset;
 }
-void MemoryReal::store_bit(StackMachine::stack_t data, std::size_t cell, std::size_t index, bool little_endian) {
-    if (cell >= get_size() / cell_size) throw std::out_of_range("memory cell out of range");
-    if (index >= cell * 8) throw std::out_of_range("bit index out of range");
 
-    bool store_bit = data != 0;
+void MemoryReal::copy_in() {
+    for (const auto &r : read)
+        std::memcpy(image.data() + r.begin, get_data(r.begin), r.end - r.begin);
+}
 
-    switch (cell_size) {
-        case 1: {
-            typedef uint8_t mem_t;
-            mem_t           data = *reinterpret_cast<mem_t *>(get_data(cell * cell_size));  // read data
-            data &= ~(0x1 << index);                                                        // mask bit
-            if (store_bit) data |= 0x1 << index;                                            // set bit
-            *reinterpret_cast<mem_t *>(get_data(cell * cell_size)) = data;                  // write back
-            break;
-        }
-        case 2: {
-            typedef uint16_t mem_t;
-            mem_t            data = *reinterpret_cast<mem_t *>(get_data(cell * cell_size));  // read data
-            if (endian::HostEndianness.isLittle() != little_endian)
-                data = endian::swap(data);        // change endianness to host
-            data &= ~(0x1 << index);              // mask bit
-            if (store_bit) data |= 0x1 << index;  // set bit
-            if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);  // revert endianness
-            *reinterpret_cast<mem_t *>(get_data(cell * cell_size)) = data;                      // write back
-            break;
-        }
-        case 4: {
-            typedef uint32_t mem_t;
-            mem_t            data = *reinterpret_cast<mem_t *>(get_data(cell * cell_size));  // read data
-            if (endian::HostEndianness.isLittle() != little_endian)
-                data = endian::swap(data);        // change endianness to host
-            data &= ~(0x1 << index);              // mask bit
-            if (store_bit) data |= 0x1 << index;  // set bit
-            if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);  // revert endianness
-            *reinterpret_cast<mem_t *>(get_data(cell * cell_size)) = data;                      // write back
-            break;
+std::atomic<uint64_t> &MemoryReal::seqlock_counter() {
+    return *static_cast<std::atomic<uint64_t> *>(get_data(seqlock_offset));
+}
+
+void MemoryReal::image_read() {
+    if (has_seqlock()) {
+        auto &counter = seqlock_counter();
+        ++seqlock_reads;
+
+        for (std::size_t attempt = 0;; ++attempt) {
+            if (attempt == SEQLOCK_MAX_RETRIES)
+                throw std::runtime_error("seqlock: no consistent copy of the shared memory (writer stalled?)");
+
+            const auto seq = counter.load(std::memory_order_acquire);
+            if ((seq & 0x1) == 0) {
+                copy_in();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (counter.load(std::memory_order_relaxed) == seq) break;
+            }
+            ++seqlock_retries;
+
+            // the writer might be preempted on the same CPU
+            if (attempt % SEQLOCK_YIELD == SEQLOCK_YIELD - 1) std::this_thread::yield();
         }
+    } else {
+        copy_in();
+    }
+}
 
-        case 8: {
-            typedef uint64_t mem_t;
-            mem_t            data = *reinterpret_cast<mem_t *>(get_data(cell * cell_size));  // read data
-            if (endian::HostEndianness.isLittle() != little_endian)
-                data = endian::swap(data);        // change endianness to host
-            data &= ~(0x1 << index);              // mask bit
-            if (store_bit) data |= 0x1 << index;  // set bit
-            if (endian::HostEndianness.isLittle() != little_endian) data = endian::swap(data);  // revert endianness
-            *reinterpret_cast<mem_t *>(get_data(cell * cell_size)) = data;                      // write back
-            break;
+void MemoryReal::image_write() {
+    // stored range that is not written yet (adjacent stored ranges are written by a single memcpy)
+    std::size_t begin   = 0;
+    std::size_t end     = 0;
+    bool        written = false;
+    auto        flush   = [&] {
+        if (begin == end) return;
+
+        // odd sequence counter: write in progress
+        if (!written && has_seqlock()) {
+            seqlock_counter().fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
         }
+        written = true;
+
+        std::memcpy(get_data(begin), image.data() + begin, end - begin);
+    };
 
-        default: throw std::runtime_error("internal program error: cell size is invalid");
+    for (const auto &r : ranges) {
+        auto *flags = dirty.data() + r.begin;
+        if (!std::memchr(flags, 1, r.end - r.begin)) continue;
+        std::memset(flags, 0, r.end - r.begin);
+
+        if (r.begin != end) {
+            flush();
+            begin = r.begin;
+        }
+        end = r.end;
     }
+    flush();
+
+    if (written && has_seqlock()) seqlock_counter().fetch_add(1, std::memory_order_release);
 }
 
-void MemoryReal::store_byte(StackMachine::stack_t data, std::size_t cell) {
-    if (cell_size != 1) throw std::runtime_error("Memory cell size is to large to store 8 bit.");
-    if (cell >= get_size()) throw std::out_of_range("memory cell out of range");
-    *reinterpret_cast<uint8_t *>(get_data(cell * cell_size)) = static_cast<uint8_t>(data);
+void MemoryReal::image_discard() {
+    for (const auto &r : ranges)
+        std::memset(dirty.data() + r.begin, 0, r.end - r.begin);
 }
 
-void MemoryReal::store_16(StackMachine::stack_t data, std::size_t cell, bool little_endian) {
-    if (cell_size > 2) throw std::runtime_error("Memory cell size is to large to store 16 bit.");
-    if ((cell * cell_size + 1) >= get_size()) throw std::out_of_range("memory cell out of range");
+std::size_t MemoryReal::check_access(std::size_t cell, Memory::dtype_t data_type, std::size_t index) const {
+    const auto size = mem_access::access_size(data_type, cell_size);
+    if (cell_size > size) {
+        std::ostringstream sstr;
+        sstr << "Memory cell size is to large to access " << size * 8 << " bit.";
+        throw std::runtime_error(sstr.str());
+    }
+    if (cell >= get_size() / cell_size || (cell * cell_size + size - 1) >= get_size())
+        throw std::out_of_range("memory cell out of range");
+    if (mem_access::is_bit(data_type) && index >= cell_size * 8) throw std::out_of_range("bit index out of range");
+    return cell * cell_size;
+}
+
+MemoryFile::MemoryFile(std::string path, std::size_t cell_size) : MemoryReal(cell_size), path(std::move(path)) {
+    auto error = [this](const char *what) {
+        std::ostringstream sstr;
+        sstr << "failed to map file '" << this->path << "': " << what;
+        if (errno) sstr << ": " << std::strerror(errno);
+        return std::runtime_error(sstr.str());
+    };
 
-    auto d = static_cast<uint16_t>(data);
-    if (endian::HostEndianness.isLittle() != little_endian) d = endian::swap(d);
-    *reinterpret_cast<uint16_t *>(get_data(cell * cell_size)) = d;
+    errno        = 0;
+    const int fd = open(this->path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) throw error("open");
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat)) {
+        const auto e = error("fstat");
+        close(fd);
+        throw e;
+    }
+
+    if (!S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) {
+        close(fd);
+        errno = 0;
+        throw error("not a regular file or empty");
+    }
+    size = static_cast<std::size_t>(file_stat.st_size);
+
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        const auto e = error("mmap");
+        close(fd);
+        throw e;
+    }
+    close(fd);
+
+    data = static_cast<uint8_t *>(addr);
 }
 
-void MemoryReal::store_32(StackMachine::stack_t data, std::size_t cell, bool little_endian, bool reg_swap) {
-    if (cell_size > 4) throw std::runtime_error("Memory cell size is to large to store 16 bit.");
-    if ((cell * cell_size + 3) >= get_size()) throw std::out_of_range("memory cell out of range");
+MemoryFile::~MemoryFile() {
+    if (sync_interval) msync(data, size, MS_SYNC);
+    munmap(data, size);
+}
 
-    union {
-        uint32_t d;
-        uint16_t reg16[2];
-    };
+std::vector<Memory::region_t> MemoryFile::get_regions() {
+    auto regions    = MemoryReal::get_regions();
+    regions[0].file = true;
+    return regions;
+}
+
+void MemoryFile::cycle() {
+    if (!sync_interval) return;
 
-    d = static_cast<uint32_t>(data);
-    if (endian::HostEndianness.isLittle() != little_endian) d = endian::swap(d);
-    if (reg_swap) std::swap(reg16[0], reg16[1]);
-    *reinterpret_cast<uint32_t *>(get_data(cell * cell_size)) = d;
+    if (++sync_counter >= sync_interval) {
+        sync_counter = 0;
+        // no MS_SYNC in the cycle: waiting for the disk would take several milliseconds
+        sync(MS_ASYNC);
+    }
 }
 
-void MemoryReal::store_64(StackMachine::stack_t data, std::size_t cell, bool little_endian, std::size_t reg_swap) {
-    if (cell_size > 4) throw std::runtime_error("Memory cell size is to large to store 16 bit.");
-    if ((cell * cell_size + 7) >= get_size()) throw std::out_of_range("memory cell out of range");
+void MemoryFile::sync(int flags) {
+    if (msync(data, size, flags)) {
+        std::ostringstream sstr;
+        sstr << "failed to synchronize file '" << path << "': " << std::strerror(errno);
+        throw std::runtime_error(sstr.str());
+    }
+}
 
-    union {
-        uint64_t d;
-        uint16_t reg16[4];
-        uint16_t reg32[2];
-    };
+std::shared_ptr<cxxshm::SharedMemory> SharedMemoryCache::get(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
 
-    d = static_cast<uint64_t>(data);
-    if (endian::HostEndianness.isLittle() != little_endian) d = endian::swap(d);
-    if (reg_swap == 4) std::swap(reg32[0], reg32[1]);
-    else if (reg_swap == 2) {
-        std::swap(reg16[0], reg16[3]);
-        std::swap(reg16[1], reg16[2]);
+    auto &segment = segments[name];
+    auto  shm     = segment.lock();
+    if (!shm) {
+        shm     = std::make_shared<cxxshm::SharedMemory>(name);
+        segment = shm;
     }
-    *reinterpret_cast<uint64_t *>(get_data(cell * cell_size)) = d;
+    return shm;
+}
+
+std::size_t SharedMemoryCache::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::size_t count = 0;
+    for (const auto &segment : segments)
+        if (!segment.second.expired()) ++count;
+    return count;
 }
@@ -8,8 +8,15 @@
 #include "StackMachine.hpp"
 
 #include "cxxshm.hpp"
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -22,7 +29,7 @@ public:
      */
     enum class dtype_t {
         le1,     //*< bit, cell is little endian
-        be1,     //*< bit, cell is little endian
+        be1,     //*< bit, cell is    big endian
         byte,    //*< byte
         le16,    //*< 16 bit little endian
         le32,    //*< 32 bit little endian
@@ -83,6 +90,43 @@ public:
      * @param index bit index (only relevant for storing bits)
      */
     virtual void store(StackMachine::stack_t data, std::size_t cell, dtype_t data_type, std::size_t index) = 0;
+
+    /**
+     * @brief fault in all pages of the memory (so they do not fault during a cycle)
+     * @details
+     *   Uses madvise(MADV_POPULATE_WRITE) if available. Otherwise, each page is written by an atomic add of zero
+     *   (a read would only map the shared zero page; the content of a shared memory must not be modified).
+     *
+     *   The pages of a mapped file are only read (MADV_POPULATE_READ or a read of each page): a write would mark the
+     *   whole file dirty (writeback, modification time). The first store to a page of the file still takes a minor
+     *   fault.
+     * @return number of pages
+     */
+    std::size_t prefault();
+
+    /**
+     * @brief lock all pages of the memory in RAM (mlock)
+     * @details locking faults in all pages
+     * @return number of locked pages
+     * @exception std::runtime_error mlock failed
+     */
+    std::size_t lock();
+
+protected:
+    /**
+     * @brief address range that is used by a memory
+     */
+    struct region_t {
+        void       *addr;            //*< begin of the region
+        std::size_t size;            //*< size in bytes
+        bool        shared;          //*< region is shared with other processes
+        bool        file   = false;  //*< region is a mapped file (must not be written by prefault)
+    };
+
+    /**
+     * @brief get all address ranges that are accessed during a cycle
+     */
+    [[nodiscard]] virtual std::vector<region_t> get_regions() = 0;
 };
 
 /**
@@ -92,23 +136,137 @@ public:
  *   - ignores the data type (except mapping)
  */
 class MemoryLocal : public Memory {
+public:
+    /**
+     * @brief huge page backing of the memory
+     */
+    enum class huge_page_t {
+        none,         //*< normal pages
+        hugetlb,      //*< reserved huge pages (MAP_HUGETLB)
+        transparent,  //*< transparent huge pages (MADV_HUGEPAGE)
+    };
+
 private:
-    std::vector<StackMachine::stack_t> mem; /** memory container*/
+    //* huge page size that is assumed to align huge page mappings
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    std::vector<StackMachine::stack_t> storage;                           //*< memory container (normal pages)
+    StackMachine::stack_t             *mem;                               //*< memory cells
+    std::size_t                        size;                              //*< number of memory cells
+    void                              *mapping      = nullptr;            //*< huge page mapping
+    std::size_t                        mapping_size = 0;                  //*< size of the huge page mapping in bytes
+    huge_page_t                        huge_pages   = huge_page_t::none;  //*< huge page backing
 
 public:
     /**
      * @brief create local memory
      * @param size local memory size (in number of cells)
      */
-    explicit MemoryLocal(std::size_t size) : mem(size, 0) {}
+    explicit MemoryLocal(std::size_t size) : storage(size, 0), mem(storage.data()), size(size) {}
+
+    MemoryLocal(const MemoryLocal &)            = delete;
+    MemoryLocal &operator=(const MemoryLocal &) = delete;
+
+    ~MemoryLocal() override;
 
     [[nodiscard]] StackMachine::stack_t load(std::size_t cell, dtype_t data_type, std::size_t index) const override;
     void store(StackMachine::stack_t data, std::size_t cell, dtype_t data_type, std::size_t index) override;
+
+    /**
+     * @brief move the memory to huge pages
+     * @details
+     *   Reserved huge pages are used if available. Otherwise, the memory is aligned to huge pages and transparent huge
+     *   pages are requested. Has to be called before the first cell address is resolved (see get_cell).
+     * @return huge page backing
+     * @exception std::runtime_error failed to allocate the memory
+     */
+    huge_page_t enable_huge_pages();
+
+    /**
+     * @brief get the huge page backing of the memory
+     */
+    [[nodiscard]] huge_page_t get_huge_pages() const { return huge_pages; }
+
+    /**
+     * @brief get the address of a memory cell
+     * @details the address is valid for the lifetime of the memory object
+     * @param cell memory cell
+     * @return address of the memory cell
+     * @exception std::out_of_range memory cell out of range
+     */
+    [[nodiscard]] StackMachine::stack_t *get_cell(std::size_t cell) {
+        if (cell >= size) throw std::out_of_range("memory cell out of range");
+        return &mem[cell];
+    }
+
+protected:
+    [[nodiscard]] std::vector<region_t> get_regions() override {
+        return {{mem, size * sizeof(StackMachine::stack_t), false}};
+    }
 };
 
+/**
+ * @brief Class that represents a memory that is shared with other processes
+ * @details
+ *   The variables are accessed directly (see get_var_addr) or via a private process image:
+ *     - image_read copies all accessed ranges of the memory to the process image (one memcpy per coalesced range)
+ *     - the variables are accessed in the process image, each store sets the dirty flag of the variable
+ *     - image_write copies the ranges of the stored variables back to the memory
+ *   So the program sees a consistent snapshot of the memory during the whole cycle and each cycle touches the shared
+ *   memory only twice.
+ *
+ *   Optionally, the process image is synchronized with other processes by a seqlock (see enable_seqlock):
+ *     - image_read retries the copy until the sequence counter was even and unchanged during the copy
+ *     - image_write increments the sequence counter before (odd: write in progress) and after the copy
+ *   Neither side waits for a lock. A reader only repeats its copy if a write was in progress.
+ */
 class MemoryReal : public Memory {
+public:
+    /**
+     * @brief memory cell of bit variables that is accessed once per cycle (see enable_bit_cache)
+     * @details the cell is stored raw (memory byte order, zero extended)
+     */
+    struct bit_cell_t {
+        void    *addr;       //*< address of the memory cell
+        uint64_t value = 0;  //*< content of the memory cell (updated by the bit stores)
+        uint64_t set   = 0;  //*< bits that were set in this cycle
+        uint64_t clear = 0;  //*< bits that were cleared in this cycle
+    };
+
 private:
-    const std::size_t cell_size;  //*< memory cell size
+    /**
+     * @brief byte range of the memory [begin, end)
+     */
+    struct range_t {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    //* ranges that are closer than this are copied by a single memcpy (image_read)
+    static constexpr std::size_t IMAGE_GAP = 64;
+
+    //* max number of copies per image_read before the memory is considered inconsistent (seqlock)
+    static constexpr std::size_t SEQLOCK_MAX_RETRIES = 1000000;
+
+    //* the CPU is yielded after this number of failed copies (seqlock)
+    static constexpr std::size_t SEQLOCK_YIELD = 64;
+
+    //* seqlock_offset if the memory has no seqlock
+    static constexpr std::size_t NO_SEQLOCK = static_cast<std::size_t>(-1);
+
+    const std::size_t    cell_size;  //*< memory cell size
+    std::vector<uint8_t> image;      //*< process image (empty: variables are accessed directly)
+    std::vector<uint8_t> dirty;      //*< dirty flags of the process image (one per byte, see get_dirty_flag)
+    std::vector<range_t> ranges;     //*< accessed ranges (sorted, not overlapping)
+    std::vector<range_t> read;       //*< coalesced accessed ranges (copied by image_read)
+
+    std::size_t seqlock_offset  = NO_SEQLOCK;  //*< byte index of the seqlock sequence counter
+    std::size_t seqlock_reads   = 0;           //*< number of image_read calls (seqlock)
+    std::size_t seqlock_retries = 0;           //*< number of copies that were repeated (seqlock)
+
+    bool                              bit_cache  = false;  //*< bit variables are accessed via bit_cells
+    bool                              bit_atomic = false;  //*< bit_cells are written by atomic operations
+    std::map<std::size_t, bit_cell_t> bit_cells;           //*< cached memory cells of bit variables (key: byte index)
 
 protected:
     /**
@@ -140,21 +298,215 @@ protected:
 public:
     ~MemoryReal() override = default;
 
+    /**
+     * @brief load from memory
+     * @details accesses the memory directly (bypasses the process image)
+     */
     [[nodiscard]] StackMachine::stack_t load(std::size_t cell, dtype_t data_type, std::size_t index) const override;
+
+    /**
+     * @brief store in memory
+     * @details accesses the memory directly (bypasses the process image)
+     */
     void store(StackMachine::stack_t data, std::size_t cell, dtype_t data_type, std::size_t index) override;
 
+    /**
+     * @brief access the variables of this memory via a process image
+     * @details has to be called before the first variable address is resolved (get_var_addr, get_cell_addr)
+     * @exception std::logic_error variable addresses were already resolved
+     */
+    void enable_image();
+
+    /**
+     * @brief check if the variables of this memory are accessed via a process image
+     */
+    [[nodiscard]] bool has_image() const { return !image.empty(); }
+
+    /**
+     * @brief synchronize the process image with other processes by a seqlock
+     * @details
+     *   Enables the process image. Has to be called before the first variable address is resolved.
+     *
+     *   The sequence counter is an unsigned 64 bit integer in host byte order that is incremented by each writer
+     *   before (odd value) and after writing the memory. It must not overlap any variable.
+     *   Writes of different processes must not overlap in time (one writer at a time).
+     * @param offset byte index of the sequence counter (aligned to 8 bytes)
+     * @exception std::runtime_error invalid offset
+     * @exception std::logic_error variable addresses were already resolved
+     */
+    void enable_seqlock(std::size_t offset);
+
+    /**
+     * @brief check if the process image is synchronized by a seqlock
+     */
+    [[nodiscard]] bool has_seqlock() const { return seqlock_offset != NO_SEQLOCK; }
+
+    /**
+     * @brief get the number of image_read calls since the process image was enabled (seqlock only)
+     */
+    [[nodiscard]] std::size_t get_seqlock_reads() const { return seqlock_reads; }
+
+    /**
+     * @brief get the number of copies that were repeated by image_read because of a concurrent write (seqlock only)
+     */
+    [[nodiscard]] std::size_t get_seqlock_retries() const { return seqlock_retries; }
+
+    /**
+     * @brief access the bit variables of this memory via a cache with one entry per memory cell
+     * @details
+     *   Each memory cell that contains bit variables is read once per cycle (bits_read). Bit stores only update the
+     *   cache and record the modified bits. bits_write applies all modified bits of a cell with one read-modify-write
+     *   operation, so bits of the cell that were not stored in this cycle keep the value of the memory (e.g. bits that
+     *   are written by another process).
+     *
+     *   Has to be called before the first variable address is resolved.
+     * @param atomic apply the modified bits with atomic fetch_or / fetch_and (ignored if the memory has a process
+     * image)
+     * @exception std::logic_error variable addresses were already resolved
+     */
+    void enable_bit_cache(bool atomic);
+
+    /**
+     * @brief check if the bit variables of this memory are accessed via a cache (see enable_bit_cache)
+     */
+    [[nodiscard]] bool has_bit_cache() const { return bit_cache; }
+
+    /**
+     * @brief get the cache entry of the memory cell of a bit variable
+     * @details
+     *   checks the access like get_var_addr. The address is valid for the lifetime of the memory object.
+     *   The variable can be accessed via the functions of mem_access::bit_accessor afterwards.
+     * @param cell memory base cell
+     * @param data_type data type of the variable (le1 or be1)
+     * @param index bit index
+     * @return address of the bit_cell_t
+     * @exception std::logic_error no bit cache or not a bit data type
+     * @exception std::out_of_range memory cell or bit index out of range
+     */
+    [[nodiscard]] void *get_bit_cell(std::size_t cell, dtype_t data_type, std::size_t index);
+
+    /**
+     * @brief read all cached memory cells of bit variables
+     * @details called at the begin of each cycle (after image_read)
+     */
+    void bits_read();
+
+    /**
+     * @brief apply the modified bits of all cached memory cells
+     * @details called at the end of each cycle (before image_write)
+     */
+    void bits_write();
+
+    /**
+     * @brief copy all accessed ranges of the memory to the process image
+     * @details called at the begin of each cycle
+     * @exception std::runtime_error no consistent copy after SEQLOCK_MAX_RETRIES attempts (seqlock)
+     */
+    void image_read();
+
+    /**
+     * @brief copy the ranges of the process image that were stored since image_read back to the memory
+     * @details
+     *   called at the end of each cycle.
+     *   A range is written if the dirty flag of a variable in the range is set, even if the stored value equals the
+     *   value that was read (the store overwrites concurrent changes of other processes). The whole range of a stored
+     *   variable is written (a bit variable writes the whole memory cell).
+     */
+    void image_write();
+
+    /**
+     * @brief discard the stores to the process image since image_read
+     * @details called instead of image_write if a cycle is skipped (clears the dirty flags)
+     */
+    void image_discard();
+
+    /**
+     * @brief get the dirty flag of a variable
+     * @details
+     *   Every store to the variable has to set the flag to 1 (image_write writes back the ranges with a set flag).
+     *   The address is valid for the lifetime of the memory object.
+     * @param cell memory base cell of the variable (checked by get_var_addr or get_cell_addr)
+     * @return address of the dirty flag (nullptr: the memory has no process image)
+     */
+    [[nodiscard]] uint8_t *get_dirty_flag(std::size_t cell) {
+        return has_image() ? dirty.data() + cell * cell_size : nullptr;
+    }
+
+    /**
+     * @brief get memory cell size
+     * @return cell size in bytes
+     */
+    [[nodiscard]] std::size_t get_cell_size() const { return cell_size; }
+
+    /**
+     * @brief get the address of a memory cell for direct access
+     * @details
+     *   the address is valid for the lifetime of the memory object.
+     *   Points into the process image if the memory has one.
+     * @param cell memory base cell
+     * @param size number of bytes that are accessed (1, 2 or 4)
+     * @return address of the memory cell
+     * @exception std::runtime_error memory cell size is to large for the access size
+     * @exception std::out_of_range memory cell out of range
+     */
+    [[nodiscard]] void *get_cell_addr(std::size_t cell, std::size_t size);
+
+    /**
+     * @brief get the address of a variable for direct access
+     * @details
+     *   Checks the memory bounds, the memory cell size and the bit index once. The variable can be accessed via the
+     *   functions of mem_access::accessor afterwards.
+     *   The address is valid for the lifetime of the memory object. Points into the process image if the memory has
+     *   one.
+     * @param cell memory base cell
+     * @param data_type data type of the variable
+     * @param index bit index (only relevant for bits)
+     * @return address of the memory cell
+     * @exception std::runtime_error memory cell size is to large for the data type
+     * @exception std::out_of_range memory cell or bit index out of range
+     */
+    [[nodiscard]] void *get_var_addr(std::size_t cell, dtype_t data_type, std::size_t index);
+
+    /**
+     * @brief get the address of a byte range of the memory
+     * @details
+     *   Bypasses the process image (always points into the memory itself). The range is not accessed by the program
+     *   (not copied by image_read / image_write).
+     * @param begin byte index of the range
+     * @param size size of the range in bytes
+     * @return address of the range
+     * @exception std::out_of_range range out of range
+     */
+    [[nodiscard]] void *get_range_addr(std::size_t begin, std::size_t size);
+
+protected:
+    [[nodiscard]] std::vector<region_t> get_regions() override;
+
 private:
-    [[nodiscard]] StackMachine::stack_t load_bit(std::size_t cell, std::size_t index, bool little_endian) const;
-    [[nodiscard]] StackMachine::stack_t load_byte(std::size_t cell) const;
-    [[nodiscard]] StackMachine::stack_t load_16(std::size_t cell, bool little_endian) const;
-    [[nodiscard]] StackMachine::stack_t load_32(std::size_t cell, bool little_endian, bool reg_swap) const;
-    [[nodiscard]] StackMachine::stack_t load_64(std::size_t cell, bool little_endian, std::size_t reg_swap) const;
-
-    void store_bit(StackMachine::stack_t data, std::size_t cell, std::size_t index, bool little_endian);
-    void store_byte(StackMachine::stack_t data, std::size_t cell);
-    void store_16(StackMachine::stack_t data, std::size_t cell, bool little_endian);
-    void store_32(StackMachine::stack_t data, std::size_t cell, bool little_endian, bool reg_swap);
-    void store_64(StackMachine::stack_t data, std::size_t cell, bool little_endian, std::size_t reg_swap);
+    /**
+     * @brief check access to a variable
+     * @return byte index of the variable
+     */
+    [[nodiscard]] std::size_t check_access(std::size_t cell, dtype_t data_type, std::size_t index) const;
+
+    /**
+     * @brief get the address of an accessed range for direct access
+     * @details adds the range to the ranges of the process image
+     * @param begin byte index of the range
+     * @param size size of the range in bytes
+     * @return address of the range (in the process image if the memory has one)
+     */
+    [[nodiscard]] void *access(std::size_t begin, std::size_t size);
+
+    /**
+     * @brief copy the coalesced accessed ranges to the process image
+     */
+    void copy_in();
+
+    /**
+     * @brief get the seqlock sequence counter
+     */
+    [[nodiscard]] std::atomic<uint64_t> &seqlock_counter();
 };
 
 /**
@@ -162,21 +514,128 @@ private:
  */
 class MemorySHM : public MemoryReal {
 private:
-    cxxshm::SharedMemory shm;  //*< shared memory instance
+    std::shared_ptr<cxxshm::SharedMemory> shm;  //*< shared memory instance (possibly shared with other machines)
 public:
     /**
      * @brief create shared memory instance
      * @param name shared memory name
      * @param cell_size memory cell size
      */
-    MemorySHM(const std::string &name, std::size_t cell_size) : MemoryReal(cell_size), shm(name) {};
+    MemorySHM(const std::string &name, std::size_t cell_size)
+        : MemoryReal(cell_size), shm(std::make_shared<cxxshm::SharedMemory>(name)) {};
+
+    /**
+     * @brief create shared memory instance from an existing mapping (see SharedMemoryCache)
+     * @param shm mapped shared memory
+     * @param cell_size memory cell size
+     */
+    MemorySHM(std::shared_ptr<cxxshm::SharedMemory> shm, std::size_t cell_size)
+        : MemoryReal(cell_size), shm(std::move(shm)) {};
 
     ~MemorySHM() override = default;
 
 protected:
-    [[nodiscard]] size_t      get_size() const override { return shm.get_size(); }
+    [[nodiscard]] size_t      get_size() const override { return shm->get_size(); }
     [[nodiscard]] const void *get_data(std::size_t index) const override {
-        return shm.get_addr<const uint8_t *>() + index;
+        return shm->get_addr<const uint8_t *>() + index;
     }
-    [[nodiscard]] void *get_data(std::size_t index) override { return shm.get_addr<uint8_t *>() + index; }
+    [[nodiscard]] void *get_data(std::size_t index) override { return shm->get_addr<uint8_t *>() + index; }
+};
+
+/**
+ * @brief shared memory mappings that are used by multiple machines in one process (host mode)
+ * @details
+ *   Each shared memory is mapped once. The mapping is released when the last MemorySHM that uses it is destroyed.
+ *   Process image, bit cache, seqlock etc. remain per MemorySHM instance.
+ */
+class SharedMemoryCache final {
+private:
+    std::mutex                                                            mutex;
+    std::unordered_map<std::string, std::weak_ptr<cxxshm::SharedMemory>> segments;  //*< key: shared memory name
+
+public:
+    /**
+     * @brief get the mapping of a shared memory
+     * @details maps the shared memory if it is not mapped yet
+     * @param name shared memory name
+     * @return mapped shared memory
+     */
+    std::shared_ptr<cxxshm::SharedMemory> get(const std::string &name);
+
+    /**
+     * @brief get the number of mapped shared memories
+     */
+    [[nodiscard]] std::size_t size();
+};
+
+/**
+ * @brief class that represents a memory mapped regular file
+ * @details
+ *   The file is mapped shared, so the content of the memory is retained in the file (e.g. across restarts).
+ *   The file is written back by the kernel. Additionally, it can be synchronized explicitly every N cycles (option
+ *   msync=, see cycle).
+ *
+ *   The synchronization in the cycles does not wait for the disk (MS_ASYNC): the writeback is only scheduled, so a
+ *   cycle is never blocked by disk I/O. The content of the last cycles is lost if the system crashes before the
+ *   writeback is done. The file is written to the disk (MS_SYNC) when it is unmapped.
+ */
+class MemoryFile : public MemoryReal {
+private:
+    std::string  path;                     //*< file path
+    std::size_t  size          = 0;        //*< file size in bytes
+    uint8_t     *data          = nullptr;  //*< mapped file
+    std::size_t  sync_interval = 0;        //*< number of cycles between two msync calls (0: never)
+    std::size_t  sync_counter  = 0;        //*< number of cycles since the last msync call
+
+public:
+    /**
+     * @brief map a file
+     * @param path path of an existing regular file
+     * @param cell_size memory cell size
+     * @exception std::runtime_error failed to map the file
+     */
+    MemoryFile(std::string path, std::size_t cell_size);
+
+    MemoryFile(const MemoryFile &)            = delete;
+    MemoryFile &operator=(const MemoryFile &) = delete;
+
+    /**
+     * @brief unmap the file
+     * @details the file is synchronized before unless the sync interval is 0
+     */
+    ~MemoryFile() override;
+
+    /**
+     * @brief end of cycle
+     * @details schedules the writeback of the file (msync MS_ASYNC) every sync_interval cycles
+     * @exception std::runtime_error msync failed
+     */
+    void cycle();
+
+    /**
+     * @brief set the number of cycles between two msync calls
+     * @param interval sync interval (0: never, default)
+     */
+    void set_sync_interval(std::size_t interval) { sync_interval = interval; }
+
+    /**
+     * @brief get the number of cycles between two msync calls
+     * @return sync interval (0: never)
+     */
+    [[nodiscard]] std::size_t get_sync_interval() const { return sync_interval; }
+
+protected:
+    [[nodiscard]] size_t      get_size() const override { return size; }
+    [[nodiscard]] const void *get_data(std::size_t index) const override { return data + index; }
+    [[nodiscard]] void       *get_data(std::size_t index) override { return data + index; }
+
+    [[nodiscard]] std::vector<region_t> get_regions() override;
+
+private:
+    /**
+     * @brief write the mapped file to the disk
+     * @param flags MS_ASYNC: schedule the writeback, MS_SYNC: block until done
+     * @exception std::runtime_error msync failed
+     */
+    void sync(int flags);
 };
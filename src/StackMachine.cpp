@@ -5,6 +5,7 @@
 
 #include "StackMachine.hpp"
 
+#include "alu.hpp"
 #include "time_str.hpp"
 
 #include <array>
@@ -71,28 +72,29 @@ static_assert(sizeof(data_f) >= sizeof(StackMachine::stack_t));
 
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
-/* Helper funcitons                                                                                                   */
+/* Constructor                                                                                                        */
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
 
-template <typename T>
-static T ipow(T x, T p) {
-    if (p == 0) return 1;
-    if (p == 1) return x;
-
-    T tmp = ipow(x, p / 2);
-    if (p % 2 == 0) return tmp * tmp;
-    return x * tmp * tmp;
+StackMachine::StackMachine(std::size_t max_stack) : MAX_STACK(max_stack) {
+    if (MAX_STACK < MIN_STACK) throw std::invalid_argument("max stack size to small");
+    stack.resize(MAX_STACK + 1);
 }
 
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
-/* Constructor                                                                                                        */
+/* Fault register                                                                                                     */
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
 
-StackMachine::StackMachine(bool verbose, std::size_t max_stack) : verbose(verbose), MAX_STACK(max_stack) {
-    if (MAX_STACK < MIN_STACK) throw std::invalid_argument("max stack size to small");
+const char *StackMachine::fault_name(fault_t fault) {
+    switch (fault) {
+        case fault_t::none: return "no fault";
+        case fault_t::div_zero: return "integer division by zero";
+        case fault_t::div_overflow: return "integer division overflow";
+        case fault_t::system: return "system call failed";
+        default: throw std::logic_error("invalid fault");
+    }
 }
 
 /**********************************************************************************************************************/
@@ -101,43 +103,33 @@ StackMachine::StackMachine(bool verbose, std::size_t max_stack) : verbose(verbos
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
 
-void StackMachine::push(StackMachine::stack_t data) {
-    if (stack.size() >= MAX_STACK) throw std::runtime_error("stack full");
-    if (verbose) std::cerr << now_str() << std::setw(FUNC_W) << __func__ << ' ' << std::hex << data << std::endl;
-    stack.push(data);
-}
-
-StackMachine::stack_t StackMachine::_pop() {
-    auto data = stack.top();
-    stack.pop();
-    return data;
-}
-
+template <typename Trace>
 StackMachine::stack_t StackMachine::pop() {
-    if (stack.empty()) throw std::runtime_error("stack empty");
-    auto data = stack.top();
-    stack.pop();
-    if (verbose) std::cerr << now_str() << std::setw(FUNC_W) << __func__ << ' ' << std::hex << data << std::endl;
+    if (!depth) throw std::runtime_error("stack empty");
+    const auto data = _pop();
+    if constexpr (Trace::enabled) trace(__func__, data);
     return data;
 }
 
+template <typename Trace>
 StackMachine::stack_t StackMachine::get() const {
-    if (stack.empty()) throw std::runtime_error("stack empty");
-    if (verbose) std::cerr << now_str() << std::setw(FUNC_W) << __func__ << ' ' << std::hex << stack.top() << std::endl;
-    return stack.top();
+    if (!depth) throw std::runtime_error("stack empty");
+    if constexpr (Trace::enabled) trace(__func__, tos);
+    return tos;
 }
 
+template <typename Trace>
 void StackMachine::clr() {
-    stack = std::stack<StackMachine::stack_t>();
-    if (verbose) std::cerr << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    depth = 0;
+    if constexpr (Trace::enabled) std::cerr << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::dup() {
-    bool tmp = verbose;
-    verbose  = false;
-    push(get());
-    verbose = tmp;
-    if (verbose) std::cerr << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    if (!depth) throw std::runtime_error("stack empty");
+    if (depth >= MAX_STACK) throw std::runtime_error("stack full");
+    _push(tos);
+    if constexpr (Trace::enabled) std::cerr << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
 /**********************************************************************************************************************/
@@ -147,216 +139,256 @@ void StackMachine::dup() {
 /**********************************************************************************************************************/
 
 
+template <typename Trace>
 void StackMachine::add() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L + R);
-    if (verbose)
+    const auto L = tos;
+    tos          = L + R;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " + " << R << " = "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::sub() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L - R);
-    if (verbose)
+    const auto L = tos;
+    tos          = L - R;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " - " << R << " = "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::mul() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L * R);
-    if (verbose)
+    const auto L = tos;
+    tos          = L * R;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " * " << R << " = "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::muls() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
-    stack.push(static_cast<StackMachine::stack_t>(L * R));
-    if (verbose)
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
+    tos          = static_cast<StackMachine::stack_t>(L * R);
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " * " << R << " = "
-                  << static_cast<StackMachine::signed_stack_t>(stack.top()) << std::endl;
+                  << static_cast<StackMachine::signed_stack_t>(tos) << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::div() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L / R);
-    if (verbose)
+    const auto L = tos;
+    fault        = alu::div_fault<false>(L, R);
+    if (fault != fault_t::none) {
+        if constexpr (Trace::enabled) trace_fault(__func__);
+        return;
+    }
+    tos = L / R;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " / " << R << " = "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::divs() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
-    stack.push(static_cast<StackMachine::stack_t>(L / R));
-    if (verbose)
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
+    fault        = alu::div_fault<true>(tos, static_cast<StackMachine::stack_t>(R));
+    if (fault != fault_t::none) {
+        if constexpr (Trace::enabled) trace_fault(__func__);
+        return;
+    }
+    tos = static_cast<StackMachine::stack_t>(L / R);
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " / " << R << " = "
-                  << static_cast<StackMachine::signed_stack_t>(stack.top()) << std::endl;
+                  << static_cast<StackMachine::signed_stack_t>(tos) << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::mod() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L % R);
-    if (verbose)
+    const auto L = tos;
+    fault        = alu::div_fault<false>(L, R);
+    if (fault != fault_t::none) {
+        if constexpr (Trace::enabled) trace_fault(__func__);
+        return;
+    }
+    tos = L % R;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " % " << R << " = "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::mods() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
-    stack.push(static_cast<StackMachine::stack_t>(L % R));
-    if (verbose)
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
+    fault        = alu::div_fault<true>(tos, static_cast<StackMachine::stack_t>(R));
+    if (fault != fault_t::none) {
+        if constexpr (Trace::enabled) trace_fault(__func__);
+        return;
+    }
+    tos = static_cast<StackMachine::stack_t>(L % R);
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " % " << R << " = "
-                  << static_cast<StackMachine::signed_stack_t>(stack.top()) << std::endl;
+                  << static_cast<StackMachine::signed_stack_t>(tos) << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::pow() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(ipow(L, R));
-    if (verbose)
+    const auto L = tos;
+    tos          = alu::ipow(L, R);
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " ** " << R << " = "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::pows() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
 
-    if (L < 0) stack.push(0);
+    if (L < 0) tos = 0;
     else
-        stack.push(static_cast<StackMachine::stack_t>(ipow(L, R)));
-    if (verbose)
+        tos = static_cast<StackMachine::stack_t>(alu::ipow(L, R));
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " ** " << R << " = "
-                  << static_cast<StackMachine::signed_stack_t>(stack.top()) << std::endl;
+                  << static_cast<StackMachine::signed_stack_t>(tos) << std::endl;
 }
 
 
+template <typename Trace>
 void StackMachine::addf() {
     check_arith();
     const data_f R   = _pop();
-    const data_f L   = _pop();
+    const data_f L   = tos;
     const data_f RES = L.f + R.f;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.f << " + " << R.f << " = "
                   << RES.f << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::subf() {
     check_arith();
     const data_f R   = _pop();
-    const data_f L   = _pop();
+    const data_f L   = tos;
     const data_f RES = L.f - R.f;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.f << " - " << R.f << " = "
                   << RES.f << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::mulf() {
     check_arith();
     const data_f R   = _pop();
-    const data_f L   = _pop();
+    const data_f L   = tos;
     const data_f RES = L.f * R.f;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.f << " * " << R.f << " = "
                   << RES.f << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::divf() {
     check_arith();
     const data_f R   = _pop();
-    const data_f L   = _pop();
+    const data_f L   = tos;
     const data_f RES = L.f / R.f;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.f << " / " << R.f << " = "
                   << RES.f << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::powf() {
     check_arith();
     const data_f R   = _pop();
-    const data_f L   = _pop();
+    const data_f L   = tos;
     const data_f RES = std::pow(L.f, R.f);
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.f << " ** " << R.f << " = "
                   << RES.f << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::addd() {
     check_arith();
     const data_d R   = _pop();
-    const data_d L   = _pop();
+    const data_d L   = tos;
     const data_d RES = L.d + R.d;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " + " << R.d << " = "
                   << RES.d << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::subd() {
     check_arith();
     const data_d R   = _pop();
-    const data_d L   = _pop();
+    const data_d L   = tos;
     const data_d RES = L.d - R.d;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " - " << R.d << " = "
                   << RES.d << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::muld() {
     check_arith();
     const data_d R   = _pop();
-    const data_d L   = _pop();
+    const data_d L   = tos;
     const data_d RES = L.d * R.d;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " * " << R.d << " = "
                   << RES.d << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::divd() {
     check_arith();
     const data_d R   = _pop();
-    const data_d L   = _pop();
+    const data_d L   = tos;
     const data_d RES = L.d / R.d;
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " / " << R.d << " = "
                   << RES.d << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::powd() {
     check_arith();
     const data_d R   = _pop();
-    const data_d L   = _pop();
+    const data_d L   = tos;
     const data_d RES = std::pow(L.d, R.d);
-    stack.push(RES.st);
-    if (verbose)
+    tos              = RES.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " ** " << R.d << " = "
                   << RES.d << std::endl;
 }
@@ -367,43 +399,47 @@ void StackMachine::powd() {
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
 
+template <typename Trace>
 void StackMachine::linv() {
     check_conv();
-    const auto SRC = _pop() != 0;
-    stack.push(SRC ? 0 : 1);
-    if (verbose)
+    const auto SRC = tos != 0;
+    tos            = SRC ? 0 : 1;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << (SRC ? '1' : '0') << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::land() {
     check_arith();
     const auto R = _pop() != 0;
-    const auto L = _pop() != 0;
-    stack.push(R && L ? 1 : 0);
-    if (verbose)
+    const auto L = tos != 0;
+    tos          = R && L ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << (L ? '1' : '0') << " && "
-                  << (R ? '1' : '0') << " -> " << stack.top() << std::endl;
+                  << (R ? '1' : '0') << " -> " << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::lor() {
     check_arith();
     const auto R = _pop() != 0;
-    const auto L = _pop() != 0;
-    stack.push(R || L ? 1 : 0);
-    if (verbose)
+    const auto L = tos != 0;
+    tos          = R || L ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << (L ? '1' : '0') << " || "
-                  << (R ? '1' : '0') << " -> " << stack.top() << std::endl;
+                  << (R ? '1' : '0') << " -> " << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::lxor() {
     check_arith();
     const auto R = _pop() != 0;
-    const auto L = _pop() != 0;
-    stack.push(R != L ? 1 : 0);
-    if (verbose)
+    const auto L = tos != 0;
+    tos          = R != L ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::dec << now_str() << std::setw(FUNC_W) << __func__ << ' ' << (L ? '1' : '0') << " xor "
-                  << (R ? '1' : '0') << " -> " << stack.top() << std::endl;
+                  << (R ? '1' : '0') << " -> " << tos << std::endl;
 }
 
 /**********************************************************************************************************************/
@@ -412,43 +448,69 @@ void StackMachine::lxor() {
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
 
+template <typename Trace>
 void StackMachine::binv() {
     check_conv();
-    const auto SRC = _pop();
-    stack.push(~SRC);
-    if (verbose)
-        std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC << " -> " << stack.top()
+    const auto SRC = tos;
+    tos            = ~SRC;
+    if constexpr (Trace::enabled)
+        std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC << " -> " << tos
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::band() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L & R);
-    if (verbose)
+    const auto L = tos;
+    tos          = L & R;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " & " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::bor() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L | R);
-    if (verbose)
+    const auto L = tos;
+    tos          = L | R;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " | " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::bxor() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L ^ R);
-    if (verbose)
+    const auto L = tos;
+    tos          = L ^ R;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " ^ " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
+}
+
+template <typename Trace>
+void StackMachine::shl() {
+    check_arith();
+    const auto R = _pop();
+    const auto L = tos;
+    tos          = alu::shl(L, R);
+    if constexpr (Trace::enabled)
+        std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " << " << std::dec << R
+                  << " -> " << std::hex << tos << std::endl;
+}
+
+template <typename Trace>
+void StackMachine::shr() {
+    check_arith();
+    const auto R = _pop();
+    const auto L = tos;
+    tos          = alu::shr(L, R);
+    if constexpr (Trace::enabled)
+        std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " >> " << std::dec << R
+                  << " -> " << std::hex << tos << std::endl;
 }
 
 /**********************************************************************************************************************/
@@ -457,52 +519,58 @@ void StackMachine::bxor() {
 /**********************************************************************************************************************/
 /**********************************************************************************************************************/
 
+template <typename Trace>
 void StackMachine::itof() {
     check_conv();
-    const auto   SRC = _pop();
+    const auto   SRC = tos;
     const data_f DST = static_cast<float>(SRC);
-    stack.push(DST.st);
-    if (verbose) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    tos              = DST.st;
+    if constexpr (Trace::enabled) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::itod() {
     check_conv();
-    const auto   SRC = _pop();
+    const auto   SRC = tos;
     const data_d DST = static_cast<double>(SRC);
-    stack.push(DST.st);
-    if (verbose) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    tos              = DST.st;
+    if constexpr (Trace::enabled) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ftoi() {
     check_conv();
-    const data_f SRC = _pop();
+    const data_f SRC = tos;
     const auto   DST = static_cast<StackMachine::stack_t>(SRC.f);
-    stack.push(DST);
-    if (verbose) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    tos              = DST;
+    if constexpr (Trace::enabled) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::dtoi() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const auto   DST = static_cast<StackMachine::stack_t>(SRC.d);
-    stack.push(DST);
-    if (verbose) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    tos              = DST;
+    if constexpr (Trace::enabled) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ftod() {
     check_conv();
-    const data_f SRC = _pop();
+    const data_f SRC = tos;
     const data_d DST = static_cast<double>(SRC.f);
-    stack.push(DST.st);
-    if (verbose) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    tos              = DST.st;
+    if constexpr (Trace::enabled) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::dtof() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_f DST = static_cast<float>(SRC.d);
-    stack.push(DST.st);
-    if (verbose) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
+    tos              = DST.st;
+    if constexpr (Trace::enabled) std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << std::endl;
 }
 
 /******************************************************************************************************************/
@@ -510,144 +578,158 @@ void StackMachine::dtof() {
 /* Relational instructions                                                                                        */
 /******************************************************************************************************************/
 /******************************************************************************************************************/
+template <typename Trace>
 void StackMachine::eq() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L == R ? 1 : 0);  // false positive: condition is always true
-    if (verbose)
+    const auto L = tos;
+    tos          = L == R ? 1 : 0;  // false positive: condition is always true
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " == " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ne() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L != R ? 1 : 0);  // false positive: condition is always false
-    if (verbose)
+    const auto L = tos;
+    tos          = L != R ? 1 : 0;  // false positive: condition is always false
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " != " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::lt() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L < R ? 1 : 0);
-    if (verbose)
+    const auto L = tos;
+    tos          = L < R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " < " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::gt() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L > R ? 1 : 0);
-    if (verbose)
+    const auto L = tos;
+    tos          = L > R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " > " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::le() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L <= R ? 1 : 0);
-    if (verbose)
+    const auto L = tos;
+    tos          = L <= R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " <= " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ge() {
     check_arith();
     const auto R = _pop();
-    const auto L = _pop();
-    stack.push(L >= R ? 1 : 0);
-    if (verbose)
+    const auto L = tos;
+    tos          = L >= R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " >= " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::lts() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
-    stack.push(L < R ? 1 : 0);
-    if (verbose)
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
+    tos          = L < R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " < " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::gts() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
-    stack.push(L > R ? 1 : 0);
-    if (verbose)
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
+    tos          = L > R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " > " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::les() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
-    stack.push(L <= R ? 1 : 0);
-    if (verbose)
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
+    tos          = L <= R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " <= " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ges() {
     check_arith();
     const auto R = static_cast<StackMachine::signed_stack_t>(_pop());
-    const auto L = static_cast<StackMachine::signed_stack_t>(_pop());
-    stack.push(L >= R ? 1 : 0);
-    if (verbose)
+    const auto L = static_cast<StackMachine::signed_stack_t>(tos);
+    tos          = L >= R ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L << " >= " << R << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ltd() {
     check_arith();
     const data_d R = _pop();
-    const data_d L = _pop();
-    stack.push(L.d < R.d ? 1 : 0);
-    if (verbose)
+    const data_d L = tos;
+    tos            = L.d < R.d ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " < " << R.d << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::gtd() {
     check_arith();
     const data_d R = _pop();
-    const data_d L = _pop();
-    stack.push(L.d > R.d ? 1 : 0);
-    if (verbose)
+    const data_d L = tos;
+    tos            = L.d > R.d ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " > " << R.d << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::led() {
     check_arith();
     const data_d R = _pop();
-    const data_d L = _pop();
-    stack.push(L.d <= R.d ? 1 : 0);
-    if (verbose)
+    const data_d L = tos;
+    tos            = L.d <= R.d ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " <= " << R.d << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ged() {
     check_arith();
     const data_d R = _pop();
-    const data_d L = _pop();
-    stack.push(L.d >= R.d ? 1 : 0);
-    if (verbose)
+    const data_d L = tos;
+    tos            = L.d >= R.d ? 1 : 0;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << L.d << " >= " << R.d << " -> "
-                  << stack.top() << std::endl;
+                  << tos << std::endl;
 }
 
 /******************************************************************************************************************/
@@ -655,133 +737,146 @@ void StackMachine::ged() {
 /* Floating point math instructions                                                                               */
 /******************************************************************************************************************/
 /******************************************************************************************************************/
+template <typename Trace>
 void StackMachine::abs() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::abs(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::sqrt() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::sqrt(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::cbrt() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::cbrt(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::ln() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::log(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::log() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::log10(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::lg() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::log2(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::sin() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::sin(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::cos() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::cos(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::tan() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::tan(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::asin() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::asin(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::acos() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::acos(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::atan() {
     check_conv();
-    const data_d SRC = _pop();
+    const data_d SRC = tos;
     const data_d DST = std::atan(SRC.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << ' ' << SRC.d << " -> " << DST.d
                   << std::endl;
 }
 
+template <typename Trace>
 void StackMachine::atanxy() {
-    check_conv();
+    check_arith();
     const data_d R   = _pop();
-    const data_d L   = _pop();
+    const data_d L   = tos;
     const data_d DST = std::atan2(R.d, L.d);
-    stack.push(DST.st);
-    if (verbose)
+    tos              = DST.st;
+    if constexpr (Trace::enabled)
         std::cerr << std::hex << now_str() << std::setw(FUNC_W) << __func__ << " x:" << L.d << " y:" << R.d << " -> "
                   << DST.d << std::endl;
 }
@@ -794,9 +889,42 @@ void StackMachine::atanxy() {
 /**********************************************************************************************************************/
 
 void StackMachine::check_arith() const {
-    if (stack.size() < MIN_ARITH) throw std::runtime_error("to few elements on stack");
+    if (depth < MIN_ARITH) throw std::runtime_error("to few elements on stack");
 }
 
 void StackMachine::check_conv() const {
-    if (stack.size() < MIN_CONV) throw std::runtime_error("to few elements on stack");
+    if (depth < MIN_CONV) throw std::runtime_error("to few elements on stack");
+}
+
+void StackMachine::trace(const char *func, StackMachine::stack_t data) const {
+    std::cerr << now_str() << std::setw(FUNC_W) << func << ' ' << std::hex << data << std::endl;
+}
+
+void StackMachine::trace_fault(const char *func) const {
+    std::cerr << now_str() << std::setw(FUNC_W) << func << " FAULT: " << fault_name(fault) << std::endl;
 }
+
+/**********************************************************************************************************************/
+/**********************************************************************************************************************/
+/* Instantiation for all tracing policies                                                                             */
+/**********************************************************************************************************************/
+/**********************************************************************************************************************/
+
+// stack machine operations without return value
+#define STACK_MACHINE_OPS(X)                                                                                           \
+    X(dup) X(clr) X(add) X(sub) X(mul) X(muls) X(div) X(divs) X(mod) X(mods) X(pow) X(pows) X(addf) X(subf) X(mulf)    \
+    X(divf) X(powf) X(addd) X(subd) X(muld) X(divd) X(powd) X(linv) X(land) X(lor) X(lxor) X(binv) X(band) X(bor)      \
+    X(bxor) X(shl) X(shr) X(itof) X(itod) X(ftoi) X(dtoi) X(ftod) X(dtof) X(eq) X(ne) X(lt) X(gt) X(le) X(ge)          \
+    X(lts) X(gts) X(les) X(ges) X(ltd) X(gtd) X(led) X(ged) X(abs) X(sqrt) X(cbrt) X(ln) X(log) X(lg) X(sin) X(cos)    \
+    X(tan) X(asin) X(acos) X(atan) X(atanxy)
+
+#define STACK_MACHINE_INSTANTIATE(name)                                                                                \
+    template void StackMachine::name<tracing::off>();                                                                  \
+    template void StackMachine::name<tracing::on>();
+STACK_MACHINE_OPS(STACK_MACHINE_INSTANTIATE)
+#undef STACK_MACHINE_INSTANTIATE
+
+template StackMachine::stack_t StackMachine::pop<tracing::off>();
+template StackMachine::stack_t StackMachine::pop<tracing::on>();
+template StackMachine::stack_t StackMachine::get<tracing::off>() const;
+template StackMachine::stack_t StackMachine::get<tracing::on>() const;
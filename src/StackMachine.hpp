@@ -5,20 +5,54 @@
 
 #pragma once
 
-#include <cstdint>
-#include <stack>
+#include "tracing.hpp"
 
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief stack machine
+ * @details
+ *   The checked operations are templates on the tracing policy (see tracing.hpp). The default instantiation
+ *   (tracing::off) contains no trace code.
+ */
 class StackMachine {
 public:
     typedef uint64_t stack_t;
     typedef int64_t  signed_stack_t;
 
+    /**
+     * @brief runtime faults
+     * @details
+     *   An operation that can not be executed sets the fault register instead of throwing an exception. The engines
+     *   check the fault register after each operation that can fault and stop the execution of the program.
+     *
+     *   Stack underflow / overflow and invalid memory accesses are not runtime faults. They are rejected before the
+     *   execution (see bytecode::Program::verify and var_t::resolve).
+     */
+    enum class fault_t : uint8_t {
+        none         = 0,  //*< no fault
+        div_zero     = 1,  //*< integer division by zero
+        div_overflow = 2,  //*< signed integer division overflow (min / -1)
+        system       = 3,  //*< system call failed
+    };
+
+    /**
+     * @brief get the name of a fault
+     * @param fault fault
+     * @return fault name
+     */
+    static const char *fault_name(fault_t fault);
+
 private:
     static constexpr std::size_t DEFAULT_MAX_STACK = 4096 / sizeof(stack_t);
 
-    bool                verbose;
-    const std::size_t   MAX_STACK;
-    std::stack<stack_t> stack;
+    const std::size_t    MAX_STACK;
+    std::vector<stack_t> stack;                  //*< stack memory (MAX_STACK + 1 elements, allocated once, see _push)
+    std::size_t          depth = 0;              //*< number of elements on the stack
+    stack_t              tos   = 0;              //*< top of stack (not stored in stack memory)
+    fault_t              fault = fault_t::none;  //*< fault register (see fault_t)
 
 public:
     /**
@@ -27,7 +61,7 @@ public:
      * @exception std::invalid_argument max stack size to small
      * @exception std::bad_alloc failed to allocate memory for stack
      */
-    explicit StackMachine(bool verbose, std::size_t max_stack = DEFAULT_MAX_STACK);
+    explicit StackMachine(std::size_t max_stack = DEFAULT_MAX_STACK);
 
     /******************************************************************************************************************/
     /******************************************************************************************************************/
@@ -39,15 +73,20 @@ public:
      * @brief push tat to the stack
      * @param data data to push
      * @exception std::runtime_error stack is full
-     * @exception std::bad_alloc failed to allocate memory for stack
      */
-    void push(stack_t data);
+    template <typename Trace = tracing::off>
+    inline void push(stack_t data) {
+        if (depth >= MAX_STACK) throw std::runtime_error("stack full");
+        if constexpr (Trace::enabled) trace(__func__, data);
+        _push(data);
+    }
 
     /**
      * @brief pop data from the stack
      * @return popped data
      * @exception std::runtime_error stack is empty
      */
+    template <typename Trace = tracing::off>
     stack_t pop();
 
     /**
@@ -55,27 +94,90 @@ public:
      * @return top of stack
      * @exception std::runtime_error stack is empty
      */
+    template <typename Trace = tracing::off>
     [[nodiscard]] stack_t get() const;
 
     /**
      * @brief duplicate top of stack
      * @exception std::runtime_error stack is empty
      * @exception std::runtime_error stack is full
-     * @exception std::bad_alloc failed to allocate memory for stack
      */
+    template <typename Trace = tracing::off>
     void dup();
 
     /**
      * @brief clear stack
-     * @exception std::bad_alloc failed to allocate memory for stack
      */
+    template <typename Trace = tracing::off>
     void clr();
 
     /**
      * @brief get current stack size
      * @return stack size
      */
-    inline std::size_t size() const { return stack.size(); }
+    inline std::size_t size() const { return depth; }
+
+    /**
+     * @brief get max stack size
+     * @return max stack size
+     */
+    inline std::size_t max_size() const { return MAX_STACK; }
+
+    /******************************************************************************************************************/
+    /******************************************************************************************************************/
+    /* Fault register                                                                                                 */
+    /******************************************************************************************************************/
+    /******************************************************************************************************************/
+
+    /**
+     * @brief get the fault register
+     * @return fault of the last operation that failed (fault_t::none: no fault since the last clr_fault)
+     */
+    [[nodiscard]] inline fault_t get_fault() const { return fault; }
+
+    /**
+     * @brief check if the fault register is set
+     */
+    [[nodiscard]] inline bool faulted() const { return fault != fault_t::none; }
+
+    /**
+     * @brief set the fault register
+     * @details used by operations that are not executed by the stack machine (special instructions, engines)
+     * @param new_fault fault
+     */
+    inline void set_fault(fault_t new_fault) { fault = new_fault; }
+
+    /**
+     * @brief clear the fault register
+     */
+    inline void clr_fault() { fault = fault_t::none; }
+
+    /******************************************************************************************************************/
+    /******************************************************************************************************************/
+    /* Unchecked stack access                                                                                         */
+    /******************************************************************************************************************/
+    /******************************************************************************************************************/
+
+    /**
+     * @brief push data to the stack without range check and trace output
+     * @details only for programs whose stack depth was verified before execution (see bytecode::Program::verify)
+     * @param data data to push
+     */
+    inline void push_unchecked(stack_t data) { _push(data); }
+
+    /**
+     * @brief pop data from the stack without range check and trace output
+     * @details only for programs whose stack depth was verified before execution (see bytecode::Program::verify)
+     * @return popped data
+     */
+    inline stack_t pop_unchecked() { return _pop(); }
+
+    /**
+     * @brief access the top of stack without range check and trace output
+     * @details only for programs whose stack depth was verified before execution (see bytecode::Program::verify)
+     * @return reference to the top of stack
+     */
+    inline stack_t &top_unchecked() { return tos; }
 
     /******************************************************************************************************************/
     /******************************************************************************************************************/
@@ -87,120 +189,144 @@ public:
      * @brief integer addition
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void add();
 
     /**
      * @brief integer subtraction
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void sub();
 
     /**
      * @brief integer multiplication (unsigned)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void mul();
 
     /**
      * @brief integer multiplication (signed)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void muls();
 
     /**
      * @brief integer division (unsigned)
+     * @details sets the fault register on division by zero (fault_t::div_zero)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void div();
 
     /**
      * @brief integer division (signed)
+     * @details sets the fault register on division by zero (fault_t::div_zero) or min / -1 (fault_t::div_overflow)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void divs();
 
     /**
      * @brief integer modulo (unsigned)
+     * @details sets the fault register on division by zero (fault_t::div_zero)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void mod();
 
     /**
      * @brief integer modulo (signed)
+     * @details sets the fault register on division by zero (fault_t::div_zero) or min / -1 (fault_t::div_overflow)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void mods();
 
     /**
      * @brief integer exponentiation (unsigned)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void pow();
 
     /**
      * @brief integer exponentiation (signed)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void pows();
 
     /**
      * @brief float addition
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void addf();
 
     /**
      * @brief float subtraction
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void subf();
 
     /**
      * @brief float multiplication
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void mulf();
 
     /**
      * @brief float division
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void divf();
 
     /**
      * @brief float exponentiation
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void powf();
 
     /**
      * @brief double addition
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void addd();
 
     /**
      * @brief double subtraction
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void subd();
 
     /**
      * @brief double multiplication
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void muld();
 
     /**
      * @brief double division
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void divd();
 
     /**
      * @brief float exponentiation
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void powd();
 
     /******************************************************************************************************************/
@@ -214,6 +340,7 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void linv();
 
     /**
@@ -221,6 +348,7 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void land();
 
     /**
@@ -228,6 +356,7 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void lor();
 
     /**
@@ -235,6 +364,7 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void lxor();
 
     /******************************************************************************************************************/
@@ -248,6 +378,7 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void binv();
 
     /**
@@ -255,6 +386,7 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void band();
 
     /**
@@ -262,6 +394,7 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void bor();
 
     /**
@@ -269,8 +402,25 @@ public:
      * @details any nonzero value is treated as true
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void bxor();
 
+    /**
+     * @brief logical shift left (L << R)
+     * @details only the lower 6 bit of R are used
+     * @exception std::runtime_error to few elements on stack
+     */
+    template <typename Trace = tracing::off>
+    void shl();
+
+    /**
+     * @brief logical shift right (L >> R)
+     * @details only the lower 6 bit of R are used
+     * @exception std::runtime_error to few elements on stack
+     */
+    template <typename Trace = tracing::off>
+    void shr();
+
     /******************************************************************************************************************/
     /******************************************************************************************************************/
     /* Data conversion instructions                                                                                   */
@@ -281,36 +431,42 @@ public:
      * @brief convert int to float
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void itof();
 
     /**
      * @brief convert int to double
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void itod();
 
     /**
      * @brief convert float to int
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ftoi();
 
     /**
      * @brief convert double to int
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void dtoi();
 
     /**
      * @brief convert float to double
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ftod();
 
     /**
      * @brief convert double to float
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void dtof();
 
     /******************************************************************************************************************/
@@ -323,84 +479,98 @@ public:
      * @brief check equal
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void eq();
 
     /**
      * @brief check not equal
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ne();
 
     /**
      * @brief check less than (unsigned integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void lt();
 
     /**
      * @brief check greater than (unsigned integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void gt();
 
     /**
      * @brief check less than or equal (unsigned integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void le();
 
     /**
      * @brief check greater than or equal (unsigned integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ge();
 
     /**
      * @brief check less than (signed integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void lts();
 
     /**
      * @brief check greater than (signed integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void gts();
 
     /**
      * @brief check less than or equal (signed integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void les();
 
     /**
      * @brief check greater than or equal (signed integer)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ges();
 
     /**
      * @brief check less than (64 bit float)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ltd();
 
     /**
      * @brief check greater than (64 bit float)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void gtd();
 
     /**
      * @brief check less than or equal (64 bit float)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void led();
 
     /**
      * @brief check greater than or equal (64 bit float)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ged();
 
     /******************************************************************************************************************/
@@ -414,6 +584,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void abs();
 
     /**
@@ -421,6 +592,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void sqrt();
 
     /**
@@ -428,6 +600,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void cbrt();
 
     /**
@@ -435,6 +608,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void ln();
 
     /**
@@ -442,6 +616,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void log();
 
     /**
@@ -449,6 +624,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void lg();
 
     /**
@@ -456,6 +632,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void sin();
 
     /**
@@ -463,6 +640,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void cos();
 
     /**
@@ -470,6 +648,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void tan();
 
     /**
@@ -477,6 +656,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void asin();
 
     /**
@@ -484,6 +664,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void acos();
 
     /**
@@ -491,6 +672,7 @@ public:
      * @details 64 float only
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void atan();
 
     /**
@@ -500,6 +682,7 @@ public:
      *      Y is right operand (tos)
      * @exception std::runtime_error to few elements on stack
      */
+    template <typename Trace = tracing::off>
     void atanxy();
 
 private:
@@ -516,11 +699,42 @@ private:
     void check_conv() const;
 
 
+    /**
+     * @brief print stack operation
+     * @param func operation name
+     * @param data operand
+     */
+    void trace(const char *func, stack_t data) const;
+
+    /**
+     * @brief print the fault of a stack operation
+     * @param func operation name
+     */
+    void trace_fault(const char *func) const;
+
 private:
+    /**
+     * @brief push data to the stack
+     * @details
+     *   like push, but without range check.
+     *   The previous top of stack is moved to stack[depth]. Element 0 of the stack memory is never part of the stack,
+     *   so push and pop work without branches even if the stack is empty.
+     * @param data data to push
+     */
+    inline void _push(stack_t data) {
+        stack[depth] = tos;
+        tos          = data;
+        ++depth;
+    }
+
     /**
      * @brief pop data from the stack
      * @details like pop, but without range check
      * @return popped data
      */
-    stack_t _pop();
+    inline stack_t _pop() {
+        const auto data = tos;
+        tos             = stack[--depth];
+        return data;
+    }
 };
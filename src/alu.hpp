@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "StackMachine.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+/**
+ * @brief side effect free implementations of the stack machine operations
+ * @details
+ *   Operate on the raw stack words exactly like the corresponding StackMachine methods.
+ *   L is the left operand (below top of stack), R the right operand (top of stack), X the operand of unary operations.
+ */
+namespace alu {
+
+typedef StackMachine::stack_t        stack_t;
+typedef StackMachine::signed_stack_t signed_stack_t;
+
+[[nodiscard]] static inline float as_float(stack_t st) {
+    float      f;
+    const auto u = static_cast<uint32_t>(st);
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+[[nodiscard]] static inline stack_t from_float(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+[[nodiscard]] static inline double as_double(stack_t st) {
+    double d;
+    std::memcpy(&d, &st, sizeof(d));
+    return d;
+}
+
+[[nodiscard]] static inline stack_t from_double(double d) {
+    stack_t st;
+    std::memcpy(&st, &d, sizeof(st));
+    return st;
+}
+
+[[nodiscard]] static inline signed_stack_t as_signed(stack_t st) { return static_cast<signed_stack_t>(st); }
+
+[[nodiscard]] static inline stack_t from_signed(signed_stack_t s) { return static_cast<stack_t>(s); }
+
+/**
+ * @brief integer exponentiation
+ * @param x base
+ * @param p exponent
+ * @return x ** p
+ */
+template <typename T>
+[[nodiscard]] static T ipow(T x, T p) {
+    if (p == 0) return 1;
+    if (p == 1) return x;
+
+    T tmp = ipow(x, p / 2);
+    if (p % 2 == 0) return tmp * tmp;
+    return x * tmp * tmp;
+}
+
+/**
+ * @brief check the operands of an integer division or modulo
+ * @tparam SIGNED signed operation
+ * @param L left operand
+ * @param R right operand
+ * @return fault the operation would cause (fault_t::none: the operation can be executed)
+ */
+template <bool SIGNED>
+[[nodiscard]] static inline StackMachine::fault_t div_fault([[maybe_unused]] stack_t L, stack_t R) {
+    if (R == 0) return StackMachine::fault_t::div_zero;
+    if constexpr (SIGNED) {
+        if (as_signed(L) == std::numeric_limits<signed_stack_t>::min() && as_signed(R) == -1)
+            return StackMachine::fault_t::div_overflow;
+    }
+    return StackMachine::fault_t::none;
+}
+
+// integer (the operands of div, divs, mod and mods have to be checked with div_fault)
+[[nodiscard]] static inline stack_t add(stack_t L, stack_t R) { return L + R; }
+[[nodiscard]] static inline stack_t sub(stack_t L, stack_t R) { return L - R; }
+[[nodiscard]] static inline stack_t mul(stack_t L, stack_t R) { return L * R; }
+[[nodiscard]] static inline stack_t muls(stack_t L, stack_t R) { return from_signed(as_signed(L) * as_signed(R)); }
+[[nodiscard]] static inline stack_t div(stack_t L, stack_t R) { return L / R; }
+[[nodiscard]] static inline stack_t divs(stack_t L, stack_t R) { return from_signed(as_signed(L) / as_signed(R)); }
+[[nodiscard]] static inline stack_t mod(stack_t L, stack_t R) { return L % R; }
+[[nodiscard]] static inline stack_t mods(stack_t L, stack_t R) { return from_signed(as_signed(L) % as_signed(R)); }
+[[nodiscard]] static inline stack_t pow(stack_t L, stack_t R) { return ipow(L, R); }
+[[nodiscard]] static inline stack_t pows(stack_t L, stack_t R) {
+    return as_signed(L) < 0 ? 0 : from_signed(ipow(as_signed(L), as_signed(R)));
+}
+
+// float
+[[nodiscard]] static inline stack_t addf(stack_t L, stack_t R) { return from_float(as_float(L) + as_float(R)); }
+[[nodiscard]] static inline stack_t subf(stack_t L, stack_t R) { return from_float(as_float(L) - as_float(R)); }
+[[nodiscard]] static inline stack_t mulf(stack_t L, stack_t R) { return from_float(as_float(L) * as_float(R)); }
+[[nodiscard]] static inline stack_t divf(stack_t L, stack_t R) { return from_float(as_float(L) / as_float(R)); }
+[[nodiscard]] static inline stack_t powf(stack_t L, stack_t R) {
+    return from_float(std::pow(as_float(L), as_float(R)));
+}
+
+// double
+[[nodiscard]] static inline stack_t addd(stack_t L, stack_t R) { return from_double(as_double(L) + as_double(R)); }
+[[nodiscard]] static inline stack_t subd(stack_t L, stack_t R) { return from_double(as_double(L) - as_double(R)); }
+[[nodiscard]] static inline stack_t muld(stack_t L, stack_t R) { return from_double(as_double(L) * as_double(R)); }
+[[nodiscard]] static inline stack_t divd(stack_t L, stack_t R) { return from_double(as_double(L) / as_double(R)); }
+[[nodiscard]] static inline stack_t powd(stack_t L, stack_t R) {
+    return from_double(std::pow(as_double(L), as_double(R)));
+}
+
+// logic
+[[nodiscard]] static inline stack_t linv(stack_t X) { return X != 0 ? 0 : 1; }
+[[nodiscard]] static inline stack_t land(stack_t L, stack_t R) { return L != 0 && R != 0 ? 1 : 0; }
+[[nodiscard]] static inline stack_t lor(stack_t L, stack_t R) { return L != 0 || R != 0 ? 1 : 0; }
+[[nodiscard]] static inline stack_t lxor(stack_t L, stack_t R) { return (L != 0) != (R != 0) ? 1 : 0; }
+
+// bitwise
+[[nodiscard]] static inline stack_t binv(stack_t X) { return ~X; }
+[[nodiscard]] static inline stack_t band(stack_t L, stack_t R) { return L & R; }
+[[nodiscard]] static inline stack_t bor(stack_t L, stack_t R) { return L | R; }
+[[nodiscard]] static inline stack_t bxor(stack_t L, stack_t R) { return L ^ R; }
+[[nodiscard]] static inline stack_t shl(stack_t L, stack_t R) { return L << (R % 64); }
+[[nodiscard]] static inline stack_t shr(stack_t L, stack_t R) { return L >> (R % 64); }
+
+// conversion
+[[nodiscard]] static inline stack_t itof(stack_t X) { return from_float(static_cast<float>(X)); }
+[[nodiscard]] static inline stack_t itod(stack_t X) { return from_double(static_cast<double>(X)); }
+[[nodiscard]] static inline stack_t ftoi(stack_t X) { return static_cast<stack_t>(as_float(X)); }
+[[nodiscard]] static inline stack_t dtoi(stack_t X) { return static_cast<stack_t>(as_double(X)); }
+[[nodiscard]] static inline stack_t ftod(stack_t X) { return from_double(static_cast<double>(as_float(X))); }
+[[nodiscard]] static inline stack_t dtof(stack_t X) { return from_float(static_cast<float>(as_double(X))); }
+
+// relational
+[[nodiscard]] static inline stack_t eq(stack_t L, stack_t R) { return L == R ? 1 : 0; }
+[[nodiscard]] static inline stack_t ne(stack_t L, stack_t R) { return L != R ? 1 : 0; }
+[[nodiscard]] static inline stack_t lt(stack_t L, stack_t R) { return L < R ? 1 : 0; }
+[[nodiscard]] static inline stack_t gt(stack_t L, stack_t R) { return L > R ? 1 : 0; }
+[[nodiscard]] static inline stack_t le(stack_t L, stack_t R) { return L <= R ? 1 : 0; }
+[[nodiscard]] static inline stack_t ge(stack_t L, stack_t R) { return L >= R ? 1 : 0; }
+[[nodiscard]] static inline stack_t lts(stack_t L, stack_t R) { return as_signed(L) < as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t gts(stack_t L, stack_t R) { return as_signed(L) > as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t les(stack_t L, stack_t R) { return as_signed(L) <= as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t ges(stack_t L, stack_t R) { return as_signed(L) >= as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t ltd(stack_t L, stack_t R) { return as_double(L) < as_double(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t gtd(stack_t L, stack_t R) { return as_double(L) > as_double(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t led(stack_t L, stack_t R) { return as_double(L) <= as_double(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t ged(stack_t L, stack_t R) { return as_double(L) >= as_double(R) ? 1 : 0; }
+
+// math (double)
+[[nodiscard]] static inline stack_t abs(stack_t X) { return from_double(std::abs(as_double(X))); }
+[[nodiscard]] static inline stack_t sqrt(stack_t X) { return from_double(std::sqrt(as_double(X))); }
+[[nodiscard]] static inline stack_t cbrt(stack_t X) { return from_double(std::cbrt(as_double(X))); }
+[[nodiscard]] static inline stack_t ln(stack_t X) { return from_double(std::log(as_double(X))); }
+[[nodiscard]] static inline stack_t log(stack_t X) { return from_double(std::log10(as_double(X))); }
+[[nodiscard]] static inline stack_t lg(stack_t X) { return from_double(std::log2(as_double(X))); }
+[[nodiscard]] static inline stack_t sin(stack_t X) { return from_double(std::sin(as_double(X))); }
+[[nodiscard]] static inline stack_t cos(stack_t X) { return from_double(std::cos(as_double(X))); }
+[[nodiscard]] static inline stack_t tan(stack_t X) { return from_double(std::tan(as_double(X))); }
+[[nodiscard]] static inline stack_t asin(stack_t X) { return from_double(std::asin(as_double(X))); }
+[[nodiscard]] static inline stack_t acos(stack_t X) { return from_double(std::acos(as_double(X))); }
+[[nodiscard]] static inline stack_t atan(stack_t X) { return from_double(std::atan(as_double(X))); }
+[[nodiscard]] static inline stack_t atanxy(stack_t L, stack_t R) {
+    return from_double(std::atan2(as_double(R), as_double(L)));
+}
+
+}  // namespace alu
@@ -0,0 +1,673 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "aot.hpp"
+
+#include <dlfcn.h>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+//* version of the interface between the runtime and the generated code (stackm_aot_abi)
+static constexpr unsigned ABI_VERSION = 3;
+
+//* return value of stackm_aot_run if an integer division faults (FAULT_RESULT + StackMachine::fault_t)
+static constexpr int FAULT_RESULT = 0x100;
+
+/**
+ * @brief runtime context of the generated code
+ * @details
+ *   The definition is also emitted as source code (see CONTEXT_SOURCE), so both sides always use the same layout.
+ *   Callbacks return 0 on success and 1 if an exception was thrown (stored in the runtime) or the operation faulted
+ *   (stored in the fault register of the stack machine).
+ */
+#define AOT_CONTEXT_DEFINITION                                                                                         \
+    struct stackm_aot_context {                                                                                        \
+        void *const         *addr;                                                                                     \
+        std::uint8_t *const *dirty;                                                                                    \
+        void                *runtime;                                                                                  \
+        int (*load)(void *runtime, std::size_t var, std::uint64_t *value);                                             \
+        int (*store)(void *runtime, std::size_t var, std::uint64_t value);                                             \
+        int (*exec_push)(void *runtime, std::size_t op, std::uint64_t *value);                                         \
+        int (*exec_pop)(void *runtime, std::size_t op, std::uint64_t value);                                           \
+    };
+
+#define AOT_STRINGIFY_(...) #__VA_ARGS__
+#define AOT_STRINGIFY(...)  AOT_STRINGIFY_(__VA_ARGS__)
+
+AOT_CONTEXT_DEFINITION
+
+static const char CONTEXT_SOURCE[] = AOT_STRINGIFY(AOT_CONTEXT_DEFINITION);
+
+//* helper functions of the generated code (keep the alu namespace in sync with alu.hpp)
+static const char PRELUDE[] = R"(#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// copy of alu.hpp
+namespace alu {
+
+typedef std::uint64_t stack_t;
+typedef std::int64_t  signed_stack_t;
+using std::uint32_t;
+
+[[nodiscard]] static inline float as_float(stack_t st) {
+    float      f;
+    const auto u = static_cast<uint32_t>(st);
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+[[nodiscard]] static inline stack_t from_float(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+[[nodiscard]] static inline double as_double(stack_t st) {
+    double d;
+    std::memcpy(&d, &st, sizeof(d));
+    return d;
+}
+
+[[nodiscard]] static inline stack_t from_double(double d) {
+    stack_t st;
+    std::memcpy(&st, &d, sizeof(st));
+    return st;
+}
+
+[[nodiscard]] static inline signed_stack_t as_signed(stack_t st) { return static_cast<signed_stack_t>(st); }
+
+[[nodiscard]] static inline stack_t from_signed(signed_stack_t s) { return static_cast<stack_t>(s); }
+
+/**
+ * @brief integer exponentiation
+ * @param x base
+ * @param p exponent
+ * @return x ** p
+ */
+template <typename T>
+[[nodiscard]] static T ipow(T x, T p) {
+    if (p == 0) return 1;
+    if (p == 1) return x;
+
+    T tmp = ipow(x, p / 2);
+    if (p % 2 == 0) return tmp * tmp;
+    return x * tmp * tmp;
+}
+
+// integer
+[[nodiscard]] static inline stack_t add(stack_t L, stack_t R) { return L + R; }
+[[nodiscard]] static inline stack_t sub(stack_t L, stack_t R) { return L - R; }
+[[nodiscard]] static inline stack_t mul(stack_t L, stack_t R) { return L * R; }
+[[nodiscard]] static inline stack_t muls(stack_t L, stack_t R) { return from_signed(as_signed(L) * as_signed(R)); }
+[[nodiscard]] static inline stack_t div(stack_t L, stack_t R) { return L / R; }
+[[nodiscard]] static inline stack_t divs(stack_t L, stack_t R) { return from_signed(as_signed(L) / as_signed(R)); }
+[[nodiscard]] static inline stack_t mod(stack_t L, stack_t R) { return L % R; }
+[[nodiscard]] static inline stack_t mods(stack_t L, stack_t R) { return from_signed(as_signed(L) % as_signed(R)); }
+[[nodiscard]] static inline stack_t pow(stack_t L, stack_t R) { return ipow(L, R); }
+[[nodiscard]] static inline stack_t pows(stack_t L, stack_t R) {
+    return as_signed(L) < 0 ? 0 : from_signed(ipow(as_signed(L), as_signed(R)));
+}
+
+// float
+[[nodiscard]] static inline stack_t addf(stack_t L, stack_t R) { return from_float(as_float(L) + as_float(R)); }
+[[nodiscard]] static inline stack_t subf(stack_t L, stack_t R) { return from_float(as_float(L) - as_float(R)); }
+[[nodiscard]] static inline stack_t mulf(stack_t L, stack_t R) { return from_float(as_float(L) * as_float(R)); }
+[[nodiscard]] static inline stack_t divf(stack_t L, stack_t R) { return from_float(as_float(L) / as_float(R)); }
+[[nodiscard]] static inline stack_t powf(stack_t L, stack_t R) {
+    return from_float(std::pow(as_float(L), as_float(R)));
+}
+
+// double
+[[nodiscard]] static inline stack_t addd(stack_t L, stack_t R) { return from_double(as_double(L) + as_double(R)); }
+[[nodiscard]] static inline stack_t subd(stack_t L, stack_t R) { return from_double(as_double(L) - as_double(R)); }
+[[nodiscard]] static inline stack_t muld(stack_t L, stack_t R) { return from_double(as_double(L) * as_double(R)); }
+[[nodiscard]] static inline stack_t divd(stack_t L, stack_t R) { return from_double(as_double(L) / as_double(R)); }
+[[nodiscard]] static inline stack_t powd(stack_t L, stack_t R) {
+    return from_double(std::pow(as_double(L), as_double(R)));
+}
+
+// logic
+[[nodiscard]] static inline stack_t linv(stack_t X) { return X != 0 ? 0 : 1; }
+[[nodiscard]] static inline stack_t land(stack_t L, stack_t R) { return L != 0 && R != 0 ? 1 : 0; }
+[[nodiscard]] static inline stack_t lor(stack_t L, stack_t R) { return L != 0 || R != 0 ? 1 : 0; }
+[[nodiscard]] static inline stack_t lxor(stack_t L, stack_t R) { return (L != 0) != (R != 0) ? 1 : 0; }
+
+// bitwise
+[[nodiscard]] static inline stack_t binv(stack_t X) { return ~X; }
+[[nodiscard]] static inline stack_t band(stack_t L, stack_t R) { return L & R; }
+[[nodiscard]] static inline stack_t bor(stack_t L, stack_t R) { return L | R; }
+[[nodiscard]] static inline stack_t bxor(stack_t L, stack_t R) { return L ^ R; }
+[[nodiscard]] static inline stack_t shl(stack_t L, stack_t R) { return L << (R % 64); }
+[[nodiscard]] static inline stack_t shr(stack_t L, stack_t R) { return L >> (R % 64); }
+
+// conversion
+[[nodiscard]] static inline stack_t itof(stack_t X) { return from_float(static_cast<float>(X)); }
+[[nodiscard]] static inline stack_t itod(stack_t X) { return from_double(static_cast<double>(X)); }
+[[nodiscard]] static inline stack_t ftoi(stack_t X) { return static_cast<stack_t>(as_float(X)); }
+[[nodiscard]] static inline stack_t dtoi(stack_t X) { return static_cast<stack_t>(as_double(X)); }
+[[nodiscard]] static inline stack_t ftod(stack_t X) { return from_double(static_cast<double>(as_float(X))); }
+[[nodiscard]] static inline stack_t dtof(stack_t X) { return from_float(static_cast<float>(as_double(X))); }
+
+// relational
+[[nodiscard]] static inline stack_t eq(stack_t L, stack_t R) { return L == R ? 1 : 0; }
+[[nodiscard]] static inline stack_t ne(stack_t L, stack_t R) { return L != R ? 1 : 0; }
+[[nodiscard]] static inline stack_t lt(stack_t L, stack_t R) { return L < R ? 1 : 0; }
+[[nodiscard]] static inline stack_t gt(stack_t L, stack_t R) { return L > R ? 1 : 0; }
+[[nodiscard]] static inline stack_t le(stack_t L, stack_t R) { return L <= R ? 1 : 0; }
+[[nodiscard]] static inline stack_t ge(stack_t L, stack_t R) { return L >= R ? 1 : 0; }
+[[nodiscard]] static inline stack_t lts(stack_t L, stack_t R) { return as_signed(L) < as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t gts(stack_t L, stack_t R) { return as_signed(L) > as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t les(stack_t L, stack_t R) { return as_signed(L) <= as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t ges(stack_t L, stack_t R) { return as_signed(L) >= as_signed(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t ltd(stack_t L, stack_t R) { return as_double(L) < as_double(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t gtd(stack_t L, stack_t R) { return as_double(L) > as_double(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t led(stack_t L, stack_t R) { return as_double(L) <= as_double(R) ? 1 : 0; }
+[[nodiscard]] static inline stack_t ged(stack_t L, stack_t R) { return as_double(L) >= as_double(R) ? 1 : 0; }
+
+// math (double)
+[[nodiscard]] static inline stack_t abs(stack_t X) { return from_double(std::abs(as_double(X))); }
+[[nodiscard]] static inline stack_t sqrt(stack_t X) { return from_double(std::sqrt(as_double(X))); }
+[[nodiscard]] static inline stack_t cbrt(stack_t X) { return from_double(std::cbrt(as_double(X))); }
+[[nodiscard]] static inline stack_t ln(stack_t X) { return from_double(std::log(as_double(X))); }
+[[nodiscard]] static inline stack_t log(stack_t X) { return from_double(std::log10(as_double(X))); }
+[[nodiscard]] static inline stack_t lg(stack_t X) { return from_double(std::log2(as_double(X))); }
+[[nodiscard]] static inline stack_t sin(stack_t X) { return from_double(std::sin(as_double(X))); }
+[[nodiscard]] static inline stack_t cos(stack_t X) { return from_double(std::cos(as_double(X))); }
+[[nodiscard]] static inline stack_t tan(stack_t X) { return from_double(std::tan(as_double(X))); }
+[[nodiscard]] static inline stack_t asin(stack_t X) { return from_double(std::asin(as_double(X))); }
+[[nodiscard]] static inline stack_t acos(stack_t X) { return from_double(std::acos(as_double(X))); }
+[[nodiscard]] static inline stack_t atan(stack_t X) { return from_double(std::atan(as_double(X))); }
+[[nodiscard]] static inline stack_t atanxy(stack_t L, stack_t R) {
+    return from_double(std::atan2(as_double(R), as_double(L)));
+}
+
+}  // namespace alu
+
+// direct access to shared memory cells (see MemoryReal)
+namespace mem {
+
+using alu::stack_t;
+
+static constexpr bool HOST_LE = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+template <typename T>
+static inline T read(const void *addr) {
+    T value;
+    std::memcpy(&value, addr, sizeof(value));
+    return value;
+}
+
+template <typename T>
+static inline void write(void *addr, T value) {
+    std::memcpy(addr, &value, sizeof(value));
+}
+
+static inline std::uint16_t conv16(std::uint16_t v, bool le) { return HOST_LE == le ? v : __builtin_bswap16(v); }
+static inline std::uint32_t conv32(std::uint32_t v, bool le) { return HOST_LE == le ? v : __builtin_bswap32(v); }
+static inline std::uint32_t swap_reg(std::uint32_t v) { return v >> 16 | v << 16; }
+
+static inline stack_t load_byte(const void *addr) { return read<std::uint8_t>(addr); }
+static inline stack_t load_le16(const void *addr) { return conv16(read<std::uint16_t>(addr), true); }
+static inline stack_t load_be16(const void *addr) { return conv16(read<std::uint16_t>(addr), false); }
+static inline stack_t load_le32(const void *addr) { return conv32(read<std::uint32_t>(addr), true); }
+static inline stack_t load_be32(const void *addr) { return conv32(read<std::uint32_t>(addr), false); }
+static inline stack_t load_le32r(const void *addr) { return swap_reg(conv32(read<std::uint32_t>(addr), true)); }
+static inline stack_t load_be32r(const void *addr) { return swap_reg(conv32(read<std::uint32_t>(addr), false)); }
+
+static inline void store_byte(void *addr, stack_t v) { write(addr, static_cast<std::uint8_t>(v)); }
+static inline void store_le16(void *addr, stack_t v) { write(addr, conv16(static_cast<std::uint16_t>(v), true)); }
+static inline void store_be16(void *addr, stack_t v) { write(addr, conv16(static_cast<std::uint16_t>(v), false)); }
+static inline void store_le32(void *addr, stack_t v) { write(addr, conv32(static_cast<std::uint32_t>(v), true)); }
+static inline void store_be32(void *addr, stack_t v) { write(addr, conv32(static_cast<std::uint32_t>(v), false)); }
+static inline void store_le32r(void *addr, stack_t v) {
+    write(addr, swap_reg(conv32(static_cast<std::uint32_t>(v), true)));
+}
+static inline void store_be32r(void *addr, stack_t v) {
+    write(addr, swap_reg(conv32(static_cast<std::uint32_t>(v), false)));
+}
+
+}  // namespace mem
+
+}  // namespace
+
+)";
+
+/** @brief signature of stackm_aot_run: returns 0 on success, 1 if a callback failed, FAULT_RESULT + fault */
+typedef int (*entry_t)(const stackm_aot_context *);
+
+/**
+ * @brief how the generated code accesses a variable
+ */
+struct access_t {
+    enum class kind_t {
+        local,     //*< pointer to a local memory cell
+        direct,    //*< pointer to a shared memory cell (mem::load_<type> / mem::store_<type>)
+        callback,  //*< load/store callback (Memory::load / Memory::store)
+    };
+
+    kind_t                kind;
+    std::size_t           size = 0;  //*< direct: number of bytes
+    const char           *type = "";  //*< direct: name of the access functions
+    StackMachine::stack_t mask = 0;  //*< local: store mask
+};
+
+/**
+ * @brief alu function of each stack operation (index: opcode, only valid for unary and binary operations)
+ */
+static constexpr const char *ALU_FUNCTION[] = {
+#define AOT_FUNCTION_CONTROL(name)                 nullptr,
+#define AOT_FUNCTION_STACK(name, function)         #function,
+#define AOT_FUNCTION_FUSED(prefix, name, function) nullptr,
+        BYTECODE_CONTROL_OPS(AOT_FUNCTION_CONTROL) BYTECODE_STACK_OPS(AOT_FUNCTION_STACK)
+                BYTECODE_FUSED_OPS(AOT_FUNCTION_FUSED)
+#undef AOT_FUNCTION_CONTROL
+#undef AOT_FUNCTION_STACK
+#undef AOT_FUNCTION_FUSED
+};
+
+/**
+ * @brief determine how the generated code accesses a variable
+ * @details only depends on the memory type, cell size and data type (not on the memory size)
+ * @param var variable
+ * @return access type
+ */
+static access_t classify(const var_t &var) {
+    access_t access {access_t::kind_t::callback};
+
+    if (dynamic_cast<const MemoryLocal *>(&var.mem)) {
+        access.kind = access_t::kind_t::local;
+        switch (var.data_type) {
+            case Memory::dtype_t::le1:
+            case Memory::dtype_t::be1: access.mask = 0x1; break;
+            case Memory::dtype_t::byte: access.mask = 0xFF; break;
+            case Memory::dtype_t::le16:
+            case Memory::dtype_t::be16: access.mask = 0xFFFF; break;
+            case Memory::dtype_t::le32:
+            case Memory::dtype_t::be32:
+            case Memory::dtype_t::le32r:
+            case Memory::dtype_t::be32r: access.mask = 0xFFFFFFFF; break;
+            case Memory::dtype_t::le64:
+            case Memory::dtype_t::be64:
+            case Memory::dtype_t::le64r:
+            case Memory::dtype_t::be64r:
+            case Memory::dtype_t::le64r4:
+            case Memory::dtype_t::be64r4: access.mask = 0xFFFFFFFFFFFFFFFF; break;
+            default: throw std::logic_error("aot: invalid data type");
+        }
+        return access;
+    }
+
+    const auto real = dynamic_cast<const MemoryReal *>(&var.mem);
+    if (!real) return access;
+
+    switch (var.data_type) {
+        case Memory::dtype_t::byte: access = {access_t::kind_t::direct, 1, "byte"}; break;
+        case Memory::dtype_t::le16: access = {access_t::kind_t::direct, 2, "le16"}; break;
+        case Memory::dtype_t::be16: access = {access_t::kind_t::direct, 2, "be16"}; break;
+        case Memory::dtype_t::le32: access = {access_t::kind_t::direct, 4, "le32"}; break;
+        case Memory::dtype_t::be32: access = {access_t::kind_t::direct, 4, "be32"}; break;
+        case Memory::dtype_t::le32r: access = {access_t::kind_t::direct, 4, "le32r"}; break;
+        case Memory::dtype_t::be32r: access = {access_t::kind_t::direct, 4, "be32r"}; break;
+        case Memory::dtype_t::le1:
+        case Memory::dtype_t::be1:
+        case Memory::dtype_t::le64:
+        case Memory::dtype_t::be64:
+        case Memory::dtype_t::le64r:
+        case Memory::dtype_t::be64r:
+        case Memory::dtype_t::le64r4:
+        case Memory::dtype_t::be64r4: return access;  // bits and 64 bit values
+        default: throw std::logic_error("aot: invalid data type");
+    }
+
+    // let the memory object report the error if the cell size does not fit
+    if (real->get_cell_size() > access.size) access = {access_t::kind_t::callback};
+    return access;
+}
+
+/**
+ * @brief get all variables that are used by a program (in order of the first use)
+ * @param ops program
+ * @param index variable index for each variable
+ * @return variables
+ */
+static std::vector<const var_t *> collect_vars(const std::vector<bytecode::op_t>      &ops,
+                                               std::unordered_map<const var_t *, std::size_t> &index) {
+    std::vector<const var_t *> vars;
+    for (const auto &op : ops) {
+        if (op.code != bytecode::opcode_t::PUSH_VAR && op.code != bytecode::opcode_t::POP_VAR) continue;
+        if (index.count(op.arg.var)) continue;
+        index[op.arg.var] = vars.size();
+        vars.push_back(op.arg.var);
+    }
+    return vars;
+}
+
+/**
+ * @brief 64 bit FNV-1a hash
+ * @param data data to hash
+ * @return hash value
+ */
+static uint64_t fnv1a(const std::string &data) {
+    uint64_t hash = 0xCBF29CE484222325;
+    for (const auto c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001B3;
+    }
+    return hash;
+}
+
+/**
+ * @brief generate the source code without the fingerprint
+ */
+static std::string generate_body(const bytecode::Program &program, const bytecode::verify_result_t &verified) {
+    const auto &ops = program.get_ops();
+    if (ops.empty() || ops.back().code != bytecode::opcode_t::END)
+        throw std::logic_error("bytecode program is not terminated");
+    if (verified.depth.size() != ops.size()) throw std::logic_error("bytecode program is not verified");
+
+    std::unordered_map<const var_t *, std::size_t> var_index;
+    const auto                                     vars = collect_vars(ops, var_index);
+
+    // use fixed stack slots if the stack depth of each operation is known
+    bool exact = true;
+    for (const auto &d : verified.depth)
+        if (d.reachable() && d.min != d.max) exact = false;
+
+    std::vector<bool> target(ops.size(), false);
+    for (const auto &op : ops) {
+        if (op.code == bytecode::opcode_t::J || op.code == bytecode::opcode_t::JZ || op.code == bytecode::opcode_t::JNZ)
+            target.at(op.arg.target) = true;
+    }
+
+    std::ostringstream out;
+    out << PRELUDE << CONTEXT_SOURCE << "\n\n";
+    out << "extern \"C\" const unsigned stackm_aot_abi = " << ABI_VERSION << ";\n\n";
+    out << "extern \"C\" int stackm_aot_run(const stackm_aot_context *ctx) {\n";
+    out << "    alu::stack_t s[" << std::max<std::size_t>(verified.max_depth, 1) << "];\n";
+    if (!exact) out << "    std::size_t  sp = 0;\n";
+    out << "    alu::stack_t t;\n";
+    out << "    (void)t;\n";
+    for (std::size_t i = 0; i < vars.size(); ++i) {
+        const auto access = classify(*vars[i]);
+        if (access.kind == access_t::kind_t::local) {
+            out << "    const auto v" << i << " = static_cast<alu::stack_t *>(ctx->addr[" << i << "]);\n";
+        } else if (access.kind == access_t::kind_t::direct) {
+            out << "    const auto v" << i << " = ctx->addr[" << i << "];\n";
+        }
+    }
+    out << '\n';
+
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const auto &op = ops[i];
+        const auto &d  = verified.depth[i];
+
+        if (target[i]) out << "op_" << i << ":\n";
+        if (!d.reachable()) continue;
+
+        std::size_t pops;
+        std::size_t pushes;
+        if (!bytecode::stack_effect(op, pops, pushes)) throw std::logic_error("aot: unknown stack effect");
+
+        // stack slot relative to the stack depth before the operation (n = 1: top of stack, n = 0: next free slot)
+        auto slot = [&](std::size_t n) {
+            std::ostringstream sstr;
+            if (exact) sstr << "s[" << d.min - n << ']';
+            else if (n == 0)
+                sstr << "s[sp]";
+            else
+                sstr << "s[sp - " << n << ']';
+            return sstr.str();
+        };
+
+        // operands that would trap are reported as fault (see alu::div_fault)
+        auto division_check = [&](bytecode::opcode_t code) {
+            out << "    if (" << slot(1) << " == 0) return "
+                << FAULT_RESULT + static_cast<int>(StackMachine::fault_t::div_zero) << ";\n";
+            if (bytecode::is_signed_division(code))
+                out << "    if (" << slot(2) << " == UINT64_C(0x8000000000000000) && " << slot(1)
+                    << " == UINT64_MAX) return " << FAULT_RESULT + static_cast<int>(StackMachine::fault_t::div_overflow)
+                    << ";\n";
+        };
+
+        out << "    // " << i << ": " << bytecode::opcode_name(op.code) << '\n';
+        switch (bytecode::opcode_category(op.code)) {
+            case bytecode::category_t::control: break;
+            case bytecode::category_t::dup: out << "    " << slot(0) << " = " << slot(1) << ";\n"; break;
+            case bytecode::category_t::unary:
+                out << "    " << slot(1) << " = alu::" << ALU_FUNCTION[static_cast<std::size_t>(op.code)] << "("
+                    << slot(1) << ");\n";
+                break;
+            case bytecode::category_t::binary:
+                if (bytecode::is_division(op.code)) division_check(op.code);
+                out << "    " << slot(2) << " = alu::" << ALU_FUNCTION[static_cast<std::size_t>(op.code)] << "("
+                    << slot(2) << ", " << slot(1) << ");\n";
+                break;
+            case bytecode::category_t::fused: throw std::logic_error("aot: superinstruction in bytecode program");
+            default: throw std::logic_error("aot: invalid opcode category");
+        }
+
+        // control operations (NOP and POP_NULL: no code)
+        if (op.code == bytecode::opcode_t::END) {
+            out << "    return 0;\n";
+        } else if (op.code == bytecode::opcode_t::EXEC) {
+            if (pushes) {
+                out << "    if (ctx->exec_push(ctx->runtime, " << i << ", &t)) return 1;\n";
+                out << "    " << slot(0) << " = t;\n";
+            } else {
+                out << "    if (ctx->exec_pop(ctx->runtime, " << i << ", " << slot(1) << ")) return 1;\n";
+            }
+        } else if (op.code == bytecode::opcode_t::PUSH_CONST) {
+            out << "    " << slot(0) << " = UINT64_C(0x" << std::hex << op.arg.value << std::dec << ");\n";
+        } else if (op.code == bytecode::opcode_t::PUSH_VAR) {
+            const auto v      = var_index.at(op.arg.var);
+            const auto access = classify(*op.arg.var);
+            switch (access.kind) {
+                case access_t::kind_t::local: out << "    " << slot(0) << " = *v" << v << ";\n"; break;
+                case access_t::kind_t::direct:
+                    out << "    " << slot(0) << " = mem::load_" << access.type << "(v" << v << ");\n";
+                    break;
+                case access_t::kind_t::callback:
+                    out << "    if (ctx->load(ctx->runtime, " << v << ", &t)) return 1;\n";
+                    out << "    " << slot(0) << " = t;\n";
+                    break;
+                default: throw std::logic_error("aot: invalid access type");
+            }
+        } else if (op.code == bytecode::opcode_t::POP_VAR) {
+            const auto v      = var_index.at(op.arg.var);
+            const auto access = classify(*op.arg.var);
+            switch (access.kind) {
+                case access_t::kind_t::local:
+                    out << "    *v" << v << " = " << slot(1) << " & UINT64_C(0x" << std::hex << access.mask << std::dec
+                        << ");\n";
+                    break;
+                case access_t::kind_t::direct:
+                    out << "    mem::store_" << access.type << "(v" << v << ", " << slot(1) << ");\n";
+                    out << "    if (ctx->dirty[" << v << "]) *ctx->dirty[" << v << "] = 1;\n";
+                    break;
+                case access_t::kind_t::callback:
+                    out << "    if (ctx->store(ctx->runtime, " << v << ", " << slot(1) << ")) return 1;\n";
+                    break;
+                default: throw std::logic_error("aot: invalid access type");
+            }
+        } else if (op.code == bytecode::opcode_t::J) {
+            out << "    goto op_" << op.arg.target << ";\n";
+        } else if (op.code == bytecode::opcode_t::JZ || op.code == bytecode::opcode_t::JNZ) {
+            // the stack pointer has to be adjusted before the jump
+            if (!exact) {
+                out << "    --sp;\n";
+                pops = 0;
+            }
+            out << "    if (" << (exact ? slot(1) : slot(0)) << (op.code == bytecode::opcode_t::JZ ? " == " : " != ")
+                << "0) goto op_" << op.arg.target << ";\n";
+        }
+
+        if (!exact && pushes != pops) {
+            if (pushes > pops) out << "    sp += " << pushes - pops << ";\n";
+            else
+                out << "    sp -= " << pops - pushes << ";\n";
+        }
+    }
+
+    out << "}\n";
+    return out.str();
+}
+
+std::string aot::generate(const bytecode::Program &program, const bytecode::verify_result_t &verified) {
+    auto source = generate_body(program, verified);
+
+    std::ostringstream out;
+    out << "\nextern \"C\" const std::uint64_t stackm_aot_fingerprint = UINT64_C(0x" << std::hex << fnv1a(source)
+        << ");\n";
+    return source + out.str();
+}
+
+/**
+ * @brief runtime state that is passed to the callbacks
+ */
+struct runtime_t {
+    StackMachine                     *machine;  //*< stack machine for the special instructions
+    const std::vector<const var_t *> &vars;     //*< variables (index used by the generated code)
+    const std::vector<bytecode::op_t> &ops;     //*< bytecode program (EXEC operations)
+    std::exception_ptr                error;    //*< exception that was thrown by a callback
+};
+
+static int callback_load(void *runtime, std::size_t var, std::uint64_t *value) noexcept {
+    auto &rt = *static_cast<runtime_t *>(runtime);
+    try {
+        const auto &v = *rt.vars.at(var);
+        *value        = v.load();
+        return 0;
+    } catch (...) {
+        rt.error = std::current_exception();
+        return 1;
+    }
+}
+
+static int callback_store(void *runtime, std::size_t var, std::uint64_t value) noexcept {
+    auto &rt = *static_cast<runtime_t *>(runtime);
+    try {
+        const auto &v = *rt.vars.at(var);
+        v.store(value);
+        return 0;
+    } catch (...) {
+        rt.error = std::current_exception();
+        return 1;
+    }
+}
+
+static int callback_exec_push(void *runtime, std::size_t op, std::uint64_t *value) noexcept {
+    auto &rt = *static_cast<runtime_t *>(runtime);
+    try {
+        if (!rt.ops.at(op).arg.instr->exec()) return 1;  // fault
+        *value = rt.machine->pop();
+        return 0;
+    } catch (...) {
+        rt.error = std::current_exception();
+        return 1;
+    }
+}
+
+static int callback_exec_pop(void *runtime, std::size_t op, std::uint64_t value) noexcept {
+    auto &rt = *static_cast<runtime_t *>(runtime);
+    try {
+        rt.machine->push(value);
+        if (!rt.ops.at(op).arg.instr->exec()) return 1;  // fault
+        return 0;
+    } catch (...) {
+        rt.error = std::current_exception();
+        return 1;
+    }
+}
+
+/**
+ * @brief get the address of a symbol of a shared object
+ * @exception std::runtime_error symbol not found
+ */
+static void *symbol(void *handle, const std::string &path, const char *name) {
+    void *addr = dlsym(handle, name);
+    if (!addr) {
+        std::ostringstream sstr;
+        sstr << "'" << path << "' is not a compiled stack machine program (symbol " << name << " not found)";
+        throw std::runtime_error(sstr.str());
+    }
+    return addr;
+}
+
+aot::Program::Program(const std::string                 &path,
+                      const bytecode::Program           &program,
+                      const bytecode::verify_result_t   &verified)
+    : program(program) {
+    const auto expected = fnv1a(generate_body(program, verified));
+
+    // dlopen searches the library path for file names without a slash
+    const auto file = path.find('/') == std::string::npos ? "./" + path : path;
+
+    handle = dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        std::ostringstream sstr;
+        sstr << "failed to load '" << path << "': " << dlerror();
+        throw std::runtime_error(sstr.str());
+    }
+
+    try {
+        const auto abi         = *static_cast<const unsigned *>(symbol(handle, path, "stackm_aot_abi"));
+        const auto fingerprint = *static_cast<const std::uint64_t *>(symbol(handle, path, "stackm_aot_fingerprint"));
+        if (abi != ABI_VERSION) {
+            std::ostringstream sstr;
+            sstr << "'" << path << "' was compiled for interface version " << abi << " (expected " << ABI_VERSION
+                 << "). Recompile the program.";
+            throw std::runtime_error(sstr.str());
+        }
+        if (fingerprint != expected) {
+            std::ostringstream sstr;
+            sstr << "'" << path << "' was not compiled from this program. Recompile the program.";
+            throw std::runtime_error(sstr.str());
+        }
+        entry = symbol(handle, path, "stackm_aot_run");
+
+        // resolve direct access addresses
+        std::unordered_map<const var_t *, std::size_t> var_index;
+        vars = collect_vars(program.get_ops(), var_index);
+        addr.resize(vars.size(), nullptr);
+        dirty.resize(vars.size(), nullptr);
+        for (std::size_t i = 0; i < vars.size(); ++i) {
+            const auto &var    = *vars[i];
+            const auto  access = classify(var);
+            switch (access.kind) {
+                case access_t::kind_t::local: addr[i] = dynamic_cast<MemoryLocal &>(var.mem).get_cell(var.cell); break;
+                case access_t::kind_t::direct: {
+                    auto &real = dynamic_cast<MemoryReal &>(var.mem);
+                    addr[i]    = real.get_cell_addr(var.cell, access.size);
+                    dirty[i]   = real.get_dirty_flag(var.cell);
+                    break;
+                }
+                case access_t::kind_t::callback: break;
+                default: throw std::logic_error("aot: invalid access type");
+            }
+        }
+    } catch (...) {
+        dlclose(handle);
+        throw;
+    }
+}
+
+aot::Program::~Program() { dlclose(handle); }
+
+void aot::Program::run(StackMachine &machine) {
+    runtime_t          rt {&machine, vars, program.get_ops(), nullptr};
+    stackm_aot_context ctx {
+            addr.data(), dirty.data(), &rt, callback_load, callback_store, callback_exec_push, callback_exec_pop};
+    const auto         run    = reinterpret_cast<entry_t>(entry);
+    const auto         result = run(&ctx);
+    if (result >= FAULT_RESULT) machine.set_fault(static_cast<StackMachine::fault_t>(result - FAULT_RESULT));
+    else if (result && rt.error)
+        std::rethrow_exception(rt.error);
+}
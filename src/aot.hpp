@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "bytecode.hpp"
+
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace aot {
+
+/**
+ * @brief generate C++ source code for a bytecode program
+ * @details
+ *   The generated code is self-contained (no project headers required) and exports the symbols that are expected by
+ *   aot::Program:
+ *     - stackm_aot_abi:         interface version
+ *     - stackm_aot_fingerprint: fingerprint of the generated code
+ *     - stackm_aot_run:         execute the program once
+ *
+ *   Constants are embedded as literals, variables of local memories and byte/16/32 bit variables of shared memories
+ *   are accessed directly via pointers. All other variables and the special instructions (STDOUT, RAND, ...) are
+ *   handled by the runtime via callbacks.
+ *
+ *   The output only depends on the program (not on memory addresses), so the runtime can regenerate it to check that
+ *   a shared object matches the program.
+ * @param program bytecode program
+ * @param verified stack depths of the program (see bytecode::Program::verify)
+ * @return C++ source code
+ */
+[[nodiscard]] std::string generate(const bytecode::Program &program, const bytecode::verify_result_t &verified);
+
+/**
+ * @brief shared object that was compiled from the output of generate
+ */
+class Program {
+private:
+    void                      *handle = nullptr;  //*< dlopen handle
+    void                      *entry  = nullptr;  //*< stackm_aot_run
+    const bytecode::Program   &program;           //*< bytecode program (EXEC operations are executed via callbacks)
+    std::vector<const var_t *> vars;              //*< variables in the order of the generated code
+    std::vector<void *>        addr;              //*< direct access addresses of the variables (or nullptr)
+    std::vector<uint8_t *>     dirty;             //*< dirty flags of the direct access variables (or nullptr)
+
+public:
+    /**
+     * @brief load a compiled program
+     * @param path path of the shared object
+     * @param program bytecode program (has to outlive the aot program)
+     * @param verified stack depths of the program (see bytecode::Program::verify)
+     * @exception std::runtime_error failed to load the shared object or shared object does not match the program
+     */
+    Program(const std::string &path, const bytecode::Program &program, const bytecode::verify_result_t &verified);
+
+    ~Program();
+
+    Program(const Program &)            = delete;
+    Program &operator=(const Program &) = delete;
+
+    /**
+     * @brief execute the program until END is reached or an operation faults (see StackMachine::get_fault)
+     * @param machine stack machine that executes the special instructions
+     */
+    void run(StackMachine &machine);
+};
+
+}  // namespace aot
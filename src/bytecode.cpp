@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "bytecode.hpp"
+
+#include "alu.hpp"
+
+#include <stdexcept>
+
+#ifdef COMPILER_CLANG
+#    pragma clang diagnostic ignored "-Wgnu-label-as-value"
+#endif
+
+const char *bytecode::opcode_name(opcode_t code) {
+    static constexpr const char *NAMES[] = {
+#define BYTECODE_NAME_CONTROL(name)                 #name,
+#define BYTECODE_NAME_STACK(name, method)           #name,
+#define BYTECODE_NAME_FUSED(prefix, name, function) #prefix #name,
+            BYTECODE_CONTROL_OPS(BYTECODE_NAME_CONTROL) BYTECODE_STACK_OPS(BYTECODE_NAME_STACK)
+                    BYTECODE_FUSED_OPS(BYTECODE_NAME_FUSED)
+#undef BYTECODE_NAME_CONTROL
+#undef BYTECODE_NAME_STACK
+#undef BYTECODE_NAME_FUSED
+    };
+
+    const auto index = static_cast<std::size_t>(code);
+    return index < OPCODE_COUNT ? NAMES[index] : "???";
+}
+
+bool bytecode::stack_effect(const op_t &op, std::size_t &pops, std::size_t &pushes) {
+    switch (opcode_category(op.code)) {
+        case category_t::control: break;
+        case category_t::dup:
+            pops   = 1;
+            pushes = 2;
+            return true;
+        case category_t::unary:
+            pops   = 1;
+            pushes = 1;
+            return true;
+        case category_t::binary:
+            pops   = 2;
+            pushes = 1;
+            return true;
+        case category_t::fused: return false;  // only stored in op_t::fused
+        default: throw std::logic_error("invalid opcode category");
+    }
+
+    if (op.code == opcode_t::EXEC) {
+        if (dynamic_cast<const instr::PUSH *>(op.arg.instr)) {
+            pops   = 0;
+            pushes = 1;
+            return true;
+        } else if (dynamic_cast<const instr::POP *>(op.arg.instr)) {
+            pops   = 1;
+            pushes = 0;
+            return true;
+        }
+        return false;
+    }
+
+    if (op.code == opcode_t::PUSH_CONST || op.code == opcode_t::PUSH_VAR) {
+        pops   = 0;
+        pushes = 1;
+    } else if (op.code == opcode_t::POP_VAR || op.code == opcode_t::POP_NULL || op.code == opcode_t::JZ ||
+               op.code == opcode_t::JNZ) {
+        pops   = 1;
+        pushes = 0;
+    } else {
+        // NOP, END, J
+        pops   = 0;
+        pushes = 0;
+    }
+    return true;
+}
+
+/**
+ * @brief load operand of a superinstruction
+ * @param op PUSH_CONST or PUSH_VAR operation
+ * @return operand value
+ */
+static inline StackMachine::stack_t fused_load(const bytecode::op_t &op) {
+    if (op.code == bytecode::opcode_t::PUSH_CONST) return op.arg.value;
+    return op.arg.var->load();
+}
+
+/**
+ * @brief store result of a superinstruction
+ * @param op POP_VAR operation
+ * @param value value to store
+ */
+static inline void fused_store(const bytecode::op_t &op, StackMachine::stack_t value) {
+    op.arg.var->store(value);
+}
+
+void bytecode::Program::run(StackMachine &machine) {
+    if (ops.empty() || ops.back().code != opcode_t::END) throw std::logic_error("bytecode program is not terminated");
+    if (!verified || machine.max_size() < max_depth) throw std::logic_error("bytecode program is not verified");
+
+#ifdef COMPILER_GNU_CLANG
+    // direct threaded code: each op stores the address of its handler
+    static const void *const DISPATCH_TABLE[] = {
+#    define BYTECODE_LABEL_CONTROL(name)                 &&op_##name,
+#    define BYTECODE_LABEL_STACK(name, method)           &&op_##name,
+#    define BYTECODE_LABEL_FUSED(prefix, name, function) &&op_##prefix##name,
+            BYTECODE_CONTROL_OPS(BYTECODE_LABEL_CONTROL) BYTECODE_STACK_OPS(BYTECODE_LABEL_STACK)
+                    BYTECODE_FUSED_OPS(BYTECODE_LABEL_FUSED)
+#    undef BYTECODE_LABEL_CONTROL
+#    undef BYTECODE_LABEL_STACK
+#    undef BYTECODE_LABEL_FUSED
+    };
+
+    if (!threaded) {
+        for (auto &op : ops)
+            op.handler = DISPATCH_TABLE[static_cast<std::size_t>(op.fused)];
+        threaded = true;
+    }
+
+#    define OP(name) op_##name:
+#    define DISPATCH() goto *ip->handler
+#else
+#    define OP(name) case opcode_t::name:
+#    define DISPATCH() continue
+#endif
+#define NEXT()                                                                                                         \
+    ++ip;                                                                                                              \
+    DISPATCH()
+#define PREEMPTION_POINT()                                                                                             \
+    if (preempt) preempt->poll()
+
+    const op_t *const base    = ops.data();
+    const op_t       *ip      = base;
+    Preemption *const preempt = preemption;
+
+#ifdef COMPILER_GNU_CLANG
+    DISPATCH();
+#else
+    for (;;) {
+        switch (ip->fused) {
+#endif
+
+    OP(NOP) { NEXT(); }
+
+    OP(END) { return; }
+
+    OP(EXEC) {
+        if (!ip->arg.instr->exec()) return;  // fault
+        NEXT();
+    }
+
+    OP(PUSH_CONST) {
+        machine.push_unchecked(ip->arg.value);
+        NEXT();
+    }
+
+    OP(PUSH_VAR) {
+        machine.push_unchecked(ip->arg.var->load());
+        NEXT();
+    }
+
+    OP(POP_VAR) {
+        ip->arg.var->store(machine.pop_unchecked());
+        NEXT();
+    }
+
+    OP(POP_NULL) {
+        machine.pop_unchecked();
+        NEXT();
+    }
+
+    OP(J) {
+        PREEMPTION_POINT();
+        ip = base + ip->arg.target;
+        DISPATCH();
+    }
+
+    OP(JZ) {
+        PREEMPTION_POINT();
+        ip = machine.pop_unchecked() == 0 ? base + ip->arg.target : ip + 1;
+        DISPATCH();
+    }
+
+    OP(JNZ) {
+        PREEMPTION_POINT();
+        ip = machine.pop_unchecked() != 0 ? base + ip->arg.target : ip + 1;
+        DISPATCH();
+    }
+
+    OP(DUP) {
+        machine.push_unchecked(machine.top_unchecked());
+        NEXT();
+    }
+
+#define BYTECODE_HANDLER_UNARY(name, function)                                                                         \
+    OP(name) {                                                                                                         \
+        auto &X = machine.top_unchecked();                                                                             \
+        X       = alu::function(X);                                                                                    \
+        NEXT();                                                                                                        \
+    }
+    BYTECODE_UNARY_OPS(BYTECODE_HANDLER_UNARY)
+#undef BYTECODE_HANDLER_UNARY
+
+#define BYTECODE_HANDLER_BINARY(name, function)                                                                        \
+    OP(name) {                                                                                                         \
+        const auto R = machine.pop_unchecked();                                                                        \
+        auto      &L = machine.top_unchecked();                                                                        \
+        if constexpr (is_division(opcode_t::name)) {                                                                   \
+            const auto fault = alu::div_fault<is_signed_division(opcode_t::name)>(L, R);                               \
+            if (fault != StackMachine::fault_t::none) {                                                                \
+                machine.set_fault(fault);                                                                              \
+                return;                                                                                                \
+            }                                                                                                          \
+        }                                                                                                              \
+        L = alu::function(L, R);                                                                                       \
+        NEXT();                                                                                                        \
+    }
+    BYTECODE_BINARY_OPS(BYTECODE_HANDLER_BINARY)
+#undef BYTECODE_HANDLER_BINARY
+
+    OP(MOV) {
+        fused_store(ip[1], fused_load(ip[0]));
+        ip += 2;
+        DISPATCH();
+    }
+
+#define BYTECODE_HANDLER_LLO(prefix, name, function)                                                                   \
+    OP(prefix##name) {                                                                                                 \
+        const auto L = fused_load(ip[0]);                                                                              \
+        const auto R = fused_load(ip[1]);                                                                              \
+        machine.push_unchecked(alu::function(L, R));                                                                   \
+        ip += 3;                                                                                                       \
+        DISPATCH();                                                                                                    \
+    }
+    BYTECODE_FUSED_ARITH_OPS(BYTECODE_HANDLER_LLO, LLO_)
+    BYTECODE_FUSED_COMPARE_OPS(BYTECODE_HANDLER_LLO, LLO_)
+#undef BYTECODE_HANDLER_LLO
+
+#define BYTECODE_HANDLER_LOS(prefix, name, function)                                                                   \
+    OP(prefix##name) {                                                                                                 \
+        const auto L = fused_load(ip[0]);                                                                              \
+        const auto R = fused_load(ip[1]);                                                                              \
+        fused_store(ip[3], alu::function(L, R));                                                                       \
+        ip += 4;                                                                                                       \
+        DISPATCH();                                                                                                    \
+    }
+    BYTECODE_FUSED_ARITH_OPS(BYTECODE_HANDLER_LOS, LOS_)
+    BYTECODE_FUSED_COMPARE_OPS(BYTECODE_HANDLER_LOS, LOS_)
+#undef BYTECODE_HANDLER_LOS
+
+#define BYTECODE_HANDLER_CB(prefix, name, function, jump_if)                                                           \
+    OP(prefix##name) {                                                                                                 \
+        PREEMPTION_POINT();                                                                                            \
+        const auto L = fused_load(ip[0]);                                                                              \
+        const auto R = fused_load(ip[1]);                                                                              \
+        ip           = (alu::function(L, R) != 0) == (jump_if) ? base + ip[3].arg.target : ip + 4;                     \
+        DISPATCH();                                                                                                    \
+    }
+#define BYTECODE_HANDLER_CBZ(prefix, name, function)  BYTECODE_HANDLER_CB(prefix, name, function, false)
+#define BYTECODE_HANDLER_CBNZ(prefix, name, function) BYTECODE_HANDLER_CB(prefix, name, function, true)
+    BYTECODE_FUSED_COMPARE_OPS(BYTECODE_HANDLER_CBZ, CBZ_)
+    BYTECODE_FUSED_COMPARE_OPS(BYTECODE_HANDLER_CBNZ, CBNZ_)
+#undef BYTECODE_HANDLER_CB
+#undef BYTECODE_HANDLER_CBZ
+#undef BYTECODE_HANDLER_CBNZ
+
+#ifndef COMPILER_GNU_CLANG
+            default: throw std::logic_error("invalid opcode");
+        }
+    }
+#endif
+
+#undef OP
+#undef DISPATCH
+#undef NEXT
+#undef PREEMPTION_POINT
+}
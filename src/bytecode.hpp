@@ -0,0 +1,482 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "StackMachine.hpp"
+#include "instruction.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bytecode {
+
+/**
+ * @brief opcodes that are handled by the bytecode engine itself
+ * @details X(name)
+ */
+#define BYTECODE_CONTROL_OPS(X)                                                                                        \
+    X(NOP)                                                                                                             \
+    X(END)                                                                                                             \
+    X(EXEC)                                                                                                            \
+    X(PUSH_CONST)                                                                                                      \
+    X(PUSH_VAR)                                                                                                        \
+    X(POP_VAR)                                                                                                         \
+    X(POP_NULL)                                                                                                        \
+    X(J)                                                                                                               \
+    X(JZ)                                                                                                              \
+    X(JNZ)
+
+/**
+ * @brief stack operations that replace the top of stack (X = f(X))
+ * @details X(name, StackMachine method / alu function)
+ */
+#define BYTECODE_UNARY_OPS(X)                                                                                          \
+    X(NOT, linv)                                                                                                       \
+    X(INV, binv)                                                                                                       \
+    X(ITOF, itof)                                                                                                      \
+    X(ITOD, itod)                                                                                                      \
+    X(FTOI, ftoi)                                                                                                      \
+    X(DTOI, dtoi)                                                                                                      \
+    X(FTOD, ftod)                                                                                                      \
+    X(DTOF, dtof)                                                                                                      \
+    X(ABS, abs)                                                                                                        \
+    X(SQRT, sqrt)                                                                                                      \
+    X(CBRT, cbrt)                                                                                                      \
+    X(LN, ln)                                                                                                          \
+    X(LOG, log)                                                                                                        \
+    X(LG, lg)                                                                                                          \
+    X(SIN, sin)                                                                                                        \
+    X(COS, cos)                                                                                                        \
+    X(TAN, tan)                                                                                                        \
+    X(ASIN, asin)                                                                                                      \
+    X(ACOS, acos)                                                                                                      \
+    X(ATAN, atan)
+
+/**
+ * @brief stack operations that replace the two topmost values by one (L = f(L, R))
+ * @details
+ *   X(name, StackMachine method / alu function)
+ *
+ *   SHL and SHR are not part of the program language. They are only generated by the optimizer (see optimize).
+ */
+#define BYTECODE_BINARY_OPS(X)                                                                                         \
+    X(ADD, add)                                                                                                        \
+    X(SUB, sub)                                                                                                        \
+    X(MUL, mul)                                                                                                        \
+    X(MULS, muls)                                                                                                      \
+    X(DIV, div)                                                                                                        \
+    X(DIVS, divs)                                                                                                      \
+    X(MOD, mod)                                                                                                        \
+    X(MODS, mods)                                                                                                      \
+    X(POW, pow)                                                                                                        \
+    X(POWS, pows)                                                                                                      \
+    X(ADDF, addf)                                                                                                      \
+    X(SUBF, subf)                                                                                                      \
+    X(MULF, mulf)                                                                                                      \
+    X(DIVF, divf)                                                                                                      \
+    X(POWF, powf)                                                                                                      \
+    X(ADDD, addd)                                                                                                      \
+    X(SUBD, subd)                                                                                                      \
+    X(MULD, muld)                                                                                                      \
+    X(DIVD, divd)                                                                                                      \
+    X(POWD, powd)                                                                                                      \
+    X(AND, land)                                                                                                       \
+    X(OR, lor)                                                                                                         \
+    X(XOR, lxor)                                                                                                       \
+    X(BAND, band)                                                                                                      \
+    X(BOR, bor)                                                                                                        \
+    X(BXOR, bxor)                                                                                                      \
+    X(SHL, shl)                                                                                                        \
+    X(SHR, shr)                                                                                                        \
+    X(EQ, eq)                                                                                                          \
+    X(NE, ne)                                                                                                          \
+    X(LT, lt)                                                                                                          \
+    X(GT, gt)                                                                                                          \
+    X(LE, le)                                                                                                          \
+    X(GE, ge)                                                                                                          \
+    X(LTS, lts)                                                                                                        \
+    X(GTS, gts)                                                                                                        \
+    X(LES, les)                                                                                                        \
+    X(GES, ges)                                                                                                        \
+    X(LTD, ltd)                                                                                                        \
+    X(GTD, gtd)                                                                                                        \
+    X(LED, led)                                                                                                        \
+    X(GED, ged)                                                                                                        \
+    X(ATANXY, atanxy)
+
+/**
+ * @brief opcodes that map directly to a stack machine method
+ * @details X(name, StackMachine method)
+ */
+#define BYTECODE_STACK_OPS(X)                                                                                          \
+    X(DUP, dup)                                                                                                        \
+    BYTECODE_UNARY_OPS(X)                                                                                              \
+    BYTECODE_BINARY_OPS(X)
+
+/**
+ * @brief binary operations that can be part of a superinstruction
+ * @details X(prefix, name, alu function)
+ */
+#define BYTECODE_FUSED_ARITH_OPS(X, P)                                                                                 \
+    X(P, ADD, add)                                                                                                     \
+    X(P, SUB, sub)                                                                                                     \
+    X(P, MUL, mul)                                                                                                     \
+    X(P, MULS, muls)                                                                                                   \
+    X(P, ADDF, addf)                                                                                                   \
+    X(P, SUBF, subf)                                                                                                   \
+    X(P, MULF, mulf)                                                                                                   \
+    X(P, DIVF, divf)                                                                                                   \
+    X(P, ADDD, addd)                                                                                                   \
+    X(P, SUBD, subd)                                                                                                   \
+    X(P, MULD, muld)                                                                                                   \
+    X(P, DIVD, divd)                                                                                                   \
+    X(P, AND, land)                                                                                                    \
+    X(P, OR, lor)                                                                                                      \
+    X(P, XOR, lxor)                                                                                                    \
+    X(P, BAND, band)                                                                                                   \
+    X(P, BOR, bor)                                                                                                     \
+    X(P, BXOR, bxor)
+
+/**
+ * @brief relational operations that can be part of a superinstruction
+ * @details X(prefix, name, alu function)
+ */
+#define BYTECODE_FUSED_COMPARE_OPS(X, P)                                                                               \
+    X(P, EQ, eq)                                                                                                       \
+    X(P, NE, ne)                                                                                                       \
+    X(P, LT, lt)                                                                                                       \
+    X(P, GT, gt)                                                                                                       \
+    X(P, LE, le)                                                                                                       \
+    X(P, GE, ge)                                                                                                       \
+    X(P, LTS, lts)                                                                                                     \
+    X(P, GTS, gts)                                                                                                     \
+    X(P, LES, les)                                                                                                     \
+    X(P, GES, ges)                                                                                                     \
+    X(P, LTD, ltd)                                                                                                     \
+    X(P, GTD, gtd)                                                                                                     \
+    X(P, LED, led)                                                                                                     \
+    X(P, GED, ged)
+
+/**
+ * @brief superinstructions
+ * @details
+ *   X(prefix, name, alu function); the opcode is prefix##name
+ *
+ *   L = PUSH_CONST or PUSH_VAR, S = POP_VAR, OP = fused arithmetic or relational operation
+ *     - MOV:        L S
+ *     - LLO_<OP>:   L L OP
+ *     - LOS_<OP>:   L L OP S
+ *     - CBZ_<OP>:   L L OP JZ
+ *     - CBNZ_<OP>:  L L OP JNZ
+ *
+ *   A superinstruction replaces the handler of the first operation of the sequence and reads the operands of the
+ *   following operations. The following operations stay untouched, so jumps into the sequence stay valid.
+ */
+#define BYTECODE_FUSED_OPS(X)                                                                                          \
+    X(MOV, , )                                                                                                         \
+    BYTECODE_FUSED_ARITH_OPS(X, LLO_)                                                                                  \
+    BYTECODE_FUSED_COMPARE_OPS(X, LLO_)                                                                                \
+    BYTECODE_FUSED_ARITH_OPS(X, LOS_)                                                                                  \
+    BYTECODE_FUSED_COMPARE_OPS(X, LOS_)                                                                                \
+    BYTECODE_FUSED_COMPARE_OPS(X, CBZ_)                                                                                \
+    BYTECODE_FUSED_COMPARE_OPS(X, CBNZ_)
+
+/**
+ * @brief bytecode opcodes
+ * @details the order is defined by BYTECODE_CONTROL_OPS, BYTECODE_STACK_OPS and BYTECODE_FUSED_OPS
+ */
+enum class opcode_t : uint8_t {
+#define BYTECODE_ENUM_CONTROL(name)                 name,
+#define BYTECODE_ENUM_STACK(name, method)           name,
+#define BYTECODE_ENUM_FUSED(prefix, name, function) prefix##name,
+    BYTECODE_CONTROL_OPS(BYTECODE_ENUM_CONTROL) BYTECODE_STACK_OPS(BYTECODE_ENUM_STACK)
+            BYTECODE_FUSED_OPS(BYTECODE_ENUM_FUSED)
+#undef BYTECODE_ENUM_CONTROL
+#undef BYTECODE_ENUM_STACK
+#undef BYTECODE_ENUM_FUSED
+};
+
+/**
+ * @brief number of opcodes
+ */
+inline constexpr std::size_t OPCODE_COUNT = 0
+#define BYTECODE_COUNT(...) +1
+        BYTECODE_CONTROL_OPS(BYTECODE_COUNT) BYTECODE_STACK_OPS(BYTECODE_COUNT) BYTECODE_FUSED_OPS(BYTECODE_COUNT);
+#undef BYTECODE_COUNT
+
+/**
+ * @brief category of an opcode
+ */
+enum class category_t : uint8_t {
+    control,  //*< handled by the bytecode engine itself (BYTECODE_CONTROL_OPS)
+    dup,      //*< DUP
+    unary,    //*< BYTECODE_UNARY_OPS
+    binary,   //*< BYTECODE_BINARY_OPS
+    fused,    //*< superinstruction (BYTECODE_FUSED_OPS)
+};
+
+/**
+ * @brief category of each opcode (index: opcode)
+ */
+inline constexpr category_t OPCODE_CATEGORY[] = {
+#define BYTECODE_CATEGORY_CONTROL(name)                 category_t::control,
+#define BYTECODE_CATEGORY_UNARY(name, function)         category_t::unary,
+#define BYTECODE_CATEGORY_BINARY(name, function)        category_t::binary,
+#define BYTECODE_CATEGORY_FUSED(prefix, name, function) category_t::fused,
+        BYTECODE_CONTROL_OPS(BYTECODE_CATEGORY_CONTROL) category_t::dup, BYTECODE_UNARY_OPS(BYTECODE_CATEGORY_UNARY)
+                BYTECODE_BINARY_OPS(BYTECODE_CATEGORY_BINARY) BYTECODE_FUSED_OPS(BYTECODE_CATEGORY_FUSED)
+#undef BYTECODE_CATEGORY_CONTROL
+#undef BYTECODE_CATEGORY_UNARY
+#undef BYTECODE_CATEGORY_BINARY
+#undef BYTECODE_CATEGORY_FUSED
+};
+
+static_assert(sizeof(OPCODE_CATEGORY) / sizeof(OPCODE_CATEGORY[0]) == OPCODE_COUNT, "incomplete opcode categories");
+static_assert(OPCODE_CATEGORY[static_cast<std::size_t>(opcode_t::DUP)] == category_t::dup,
+              "BYTECODE_STACK_OPS has to start with DUP");
+
+/**
+ * @brief get the category of an opcode
+ */
+[[nodiscard]] constexpr category_t opcode_category(opcode_t code) {
+    return OPCODE_CATEGORY[static_cast<std::size_t>(code)];
+}
+
+/**
+ * @brief check if an opcode is a unary stack operation (BYTECODE_UNARY_OPS)
+ */
+[[nodiscard]] constexpr bool is_unary(opcode_t code) { return opcode_category(code) == category_t::unary; }
+
+/**
+ * @brief check if an opcode is a binary stack operation (BYTECODE_BINARY_OPS)
+ */
+[[nodiscard]] constexpr bool is_binary(opcode_t code) { return opcode_category(code) == category_t::binary; }
+
+/**
+ * @brief get the mnemonic of an opcode
+ * @param code opcode
+ * @return opcode name
+ */
+[[nodiscard]] const char *opcode_name(opcode_t code);
+
+/**
+ * @brief check if an opcode is an integer division or modulo
+ * @details these are the only stack operations that can fault at runtime (see StackMachine::fault_t)
+ */
+[[nodiscard]] constexpr bool is_division(opcode_t code) {
+    return code == opcode_t::DIV || code == opcode_t::DIVS || code == opcode_t::MOD || code == opcode_t::MODS;
+}
+
+/**
+ * @brief check if an opcode is a signed integer division or modulo
+ */
+[[nodiscard]] constexpr bool is_signed_division(opcode_t code) {
+    return code == opcode_t::DIVS || code == opcode_t::MODS;
+}
+
+struct op_t;
+
+/**
+ * @brief get the stack effect of an operation
+ * @param op operation
+ * @param pops number of values that the operation removes from the stack
+ * @param pushes number of values that the operation adds to the stack
+ * @return false if the stack effect of the operation is unknown
+ */
+[[nodiscard]] bool stack_effect(const op_t &op, std::size_t &pops, std::size_t &pushes);
+
+/**
+ * @brief single bytecode operation (opcode + operand)
+ */
+struct op_t {
+    const void *handler = nullptr;  //*< threaded code address (assigned by Program::run)
+    opcode_t    code;               //*< opcode
+    opcode_t    fused;              //*< superinstruction that starts at this op (equal to code if none)
+
+    union {
+        StackMachine::stack_t value;   //*< PUSH_CONST: value to push
+        var_t                *var;     //*< PUSH_VAR, POP_VAR: variable
+        std::size_t           target;  //*< J, JZ, JNZ: index of the jump target
+        Instruction          *instr;   //*< EXEC: instruction object that is executed
+    } arg;
+
+    explicit op_t(opcode_t code) : code(code), fused(code), arg() { arg.value = 0; }
+    op_t(opcode_t code, StackMachine::stack_t value) : code(code), fused(code), arg() { arg.value = value; }
+    op_t(opcode_t code, var_t &var) : code(code), fused(code), arg() { arg.var = &var; }
+    op_t(opcode_t code, Instruction &instr) : code(code), fused(code), arg() { arg.instr = &instr; }
+};
+
+/**
+ * @brief possible stack depths before the execution of an operation
+ */
+struct depth_t {
+    static constexpr std::size_t UNREACHABLE = SIZE_MAX;
+
+    std::size_t min = UNREACHABLE;  //*< min stack depth (UNREACHABLE if the operation is never executed)
+    std::size_t max = 0;            //*< max stack depth
+
+    [[nodiscard]] bool reachable() const { return min != UNREACHABLE; }
+};
+
+/**
+ * @brief result of the static stack depth verification
+ */
+struct verify_result_t {
+    std::vector<depth_t> depth;          //*< stack depth before each operation
+    std::size_t          max_depth = 0;  //*< max stack depth of the whole program
+};
+
+/**
+ * @brief exception that is thrown if a program fails the static stack depth verification
+ */
+class verify_error : public std::runtime_error {
+private:
+    std::size_t index;  //*< index of the operation that failed the verification
+
+public:
+    verify_error(std::size_t index, const std::string &what) : std::runtime_error(what), index(index) {}
+
+    /**
+     * @brief get the index of the operation that failed the verification
+     * @return operation index
+     */
+    [[nodiscard]] std::size_t get_index() const { return index; }
+};
+
+/**
+ * @brief asynchronous preemption request
+ * @details
+ *   pending is set by another thread. The program calls preempt at the next preemption point if pending is set.
+ *   preempt is executed on the stack of the interrupted program, the interrupted program continues after preempt
+ *   returns.
+ */
+class Preemption {
+public:
+    std::atomic<bool> pending {false};  //*< preemption requested
+
+    virtual ~Preemption() = default;
+
+    /**
+     * @brief handle the preemption request (pending is set)
+     */
+    virtual void preempt() = 0;
+
+    /**
+     * @brief preemption point
+     */
+    void poll() {
+        if (pending.load(std::memory_order_relaxed)) preempt();
+    }
+};
+
+/**
+ * @brief flat bytecode program
+ * @details
+ *   Executed by a direct threaded dispatch loop (computed goto) if the compiler supports it.
+ *   Otherwise a switch based dispatch loop is used.
+ */
+class Program {
+private:
+    std::vector<op_t> ops;                   //*< program
+    bool              threaded   = false;    //*< handler addresses of ops are valid
+    bool              verified   = false;    //*< stack depth of the program was verified (see verify)
+    std::size_t       max_depth  = 0;        //*< max stack depth (valid if verified)
+    Preemption       *preemption = nullptr;  //*< preemption request that is checked by run (nullptr: none)
+
+public:
+    /**
+     * @brief append operation
+     * @param op operation
+     */
+    void emit(const op_t &op) {
+        ops.emplace_back(op);
+        threaded = false;
+        verified = false;
+    }
+
+    /**
+     * @brief replace all operations
+     * @details the program has to be verified again
+     * @param new_ops new operations
+     */
+    void assign(std::vector<op_t> new_ops) {
+        ops      = std::move(new_ops);
+        threaded = false;
+        verified = false;
+    }
+
+    /**
+     * @brief access operation
+     * @param index operation index
+     * @return operation
+     */
+    [[nodiscard]] op_t &at(std::size_t index) {
+        threaded = false;
+        return ops.at(index);
+    }
+
+    /**
+     * @brief access all operations
+     * @return operations
+     */
+    [[nodiscard]] std::vector<op_t> &get_ops() {
+        threaded = false;
+        return ops;
+    }
+
+    /**
+     * @brief access all operations (const)
+     * @return operations
+     */
+    [[nodiscard]] const std::vector<op_t> &get_ops() const { return ops; }
+
+    /**
+     * @brief get number of operations
+     * @return number of operations
+     */
+    [[nodiscard]] std::size_t size() const { return ops.size(); }
+
+    /**
+     * @brief check a preemption request at each jump operation
+     * @details
+     *   Each loop contains a jump, code without a jump is executed in bounded time. A preemption is therefore handled
+     *   within the execution time of the longest jump free sequence of the program.
+     * @param request preemption request (nullptr: not preemptible, default)
+     */
+    void set_preemption(Preemption *request) { preemption = request; }
+
+    /**
+     * @brief determine the possible stack depths of all operations
+     * @details
+     *   Follows all possible execution paths, starting with an empty stack at the first operation.
+     *   The program is rejected if any path could pop from an empty stack or exceed the max stack size.
+     *
+     *   A verified program is executed without runtime stack checks by run.
+     *   Operations that are modified after the verification (at, get_ops) must keep their stack effect and jump
+     *   targets.
+     * @param stack_size max stack size
+     * @return stack depths
+     * @exception verify_error program failed the verification
+     */
+    verify_result_t verify(std::size_t stack_size);
+
+    /**
+     * @brief execute the program until END is reached or an operation faults
+     * @details
+     *   the stack is not checked by the operations --> the program has to be verified
+     *
+     *   If an operation faults, the execution stops and the fault register of the machine is set
+     *   (see StackMachine::get_fault). The stack content is undefined in this case.
+     * @param machine stack machine to operate on (has to provide the verified max stack depth)
+     */
+    void run(StackMachine &machine);
+};
+
+}  // namespace bytecode
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "control_flow.hpp"
+
+#include <stdexcept>
+
+control_flow::result_t control_flow::cleanup(const std::vector<node_t> &program) {
+    const auto N = program.size();
+    if (N == 0 || program.back().kind != kind_t::end) throw std::logic_error("program is not terminated");
+
+    result_t result;
+    result.keep.resize(N, false);
+    result.target.resize(N, 0);
+    result.position.resize(N, 0);
+
+    // first instruction that is executed if execution continues at index
+    // (the number of steps is limited to terminate for jump cycles)
+    auto resolve = [&](std::size_t index, bool &threaded) {
+        for (std::size_t steps = 0; steps <= N; ++steps) {
+            while (program[index].kind == kind_t::nop)
+                ++index;
+
+            if (program[index].kind != kind_t::jump || program[index].target == index) break;
+            index    = program[index].target;
+            threaded = true;
+        }
+        return index;
+    };
+
+    for (std::size_t i = 0; i < N; ++i) {
+        const auto &node = program[i];
+        if (node.kind != kind_t::jump && node.kind != kind_t::branch) continue;
+        if (node.target >= N) throw std::logic_error("invalid jump target");
+
+        bool threaded    = false;
+        result.target[i] = resolve(node.target, threaded);
+        if (threaded) ++result.threaded;
+    }
+
+    // reachability
+    std::vector<bool>        reachable(N, false);
+    std::vector<std::size_t> work;
+    auto                     visit = [&](std::size_t index) {
+        if (!reachable[index]) {
+            reachable[index] = true;
+            work.push_back(index);
+        }
+    };
+
+    visit(0);
+    while (!work.empty()) {
+        const auto index = work.back();
+        work.pop_back();
+
+        switch (program[index].kind) {
+            case kind_t::end: break;
+            case kind_t::jump: visit(result.target[index]); break;
+            case kind_t::branch:
+                visit(result.target[index]);
+                visit(index + 1);
+                break;
+            case kind_t::nop:
+            case kind_t::other: visit(index + 1); break;
+            default: throw std::logic_error("invalid control flow node kind");
+        }
+    }
+
+    // keep reachable instructions (backwards to know the next kept instruction of each jump)
+    std::size_t next = N - 1;
+    for (std::size_t i = N; i > 0; --i) {
+        const auto  index = i - 1;
+        const auto &node  = program[index];
+
+        bool keep = reachable[index];
+        if (node.kind == kind_t::nop) {
+            keep = false;
+            ++result.nops;
+        } else if (!reachable[index]) {
+            ++result.unreachable;
+        } else if (node.kind == kind_t::jump && result.target[index] == next && index != N - 1) {
+            keep = false;
+            ++result.redundant_jumps;
+        }
+
+        if (index == N - 1) keep = true;
+        result.keep[index] = keep;
+        if (keep) next = index;
+    }
+
+    std::size_t new_index = 0;
+    std::size_t pending   = 0;  // first old index without assigned position
+    for (std::size_t i = 0; i < N; ++i) {
+        if (!result.keep[i]) continue;
+        for (; pending <= i; ++pending)
+            result.position[pending] = new_index;
+        ++new_index;
+    }
+
+    return result;
+}
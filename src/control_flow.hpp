@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief control flow cleanup that is shared by the instruction list and the bytecode program
+ */
+namespace control_flow {
+
+/**
+ * @brief control flow behaviour of an instruction
+ */
+enum class kind_t : uint8_t {
+    nop,     //*< does nothing (label)
+    jump,    //*< unconditional jump
+    branch,  //*< conditional jump (continues with the next instruction if not taken)
+    end,     //*< end of the program
+    other,   //*< continues with the next instruction
+};
+
+/**
+ * @brief instruction as seen by the control flow cleanup
+ */
+struct node_t {
+    kind_t      kind;        //*< control flow behaviour
+    std::size_t target = 0;  //*< index of the jump target (jump, branch)
+};
+
+/**
+ * @brief result of the control flow cleanup
+ */
+struct result_t {
+    std::vector<bool>        keep;                 //*< instruction is part of the cleaned up program
+    std::vector<std::size_t> target;               //*< final jump target (old index) of each jump / branch
+    std::vector<std::size_t> position;             //*< new index of the first kept instruction at or after an old index
+    std::size_t              nops            = 0;  //*< number of removed nop instructions
+    std::size_t              threaded        = 0;  //*< number of jumps that were redirected past another jump
+    std::size_t              unreachable     = 0;  //*< number of removed unreachable instructions
+    std::size_t              redundant_jumps = 0;  //*< number of removed jumps to the next kept instruction
+};
+
+/**
+ * @brief remove labels and unreachable code, collapse jump chains
+ * @details
+ *   - jumps to a nop continue at the next instruction that is not a nop
+ *   - jumps to an unconditional jump are redirected to its target (jump chains are collapsed)
+ *   - instructions that are not reachable from the first instruction are removed
+ *   - unconditional jumps to the next kept instruction are removed
+ *
+ *   The last instruction of the program has to be an end instruction. It is always kept.
+ * @param program instructions of the program
+ * @return cleanup result
+ */
+[[nodiscard]] result_t cleanup(const std::vector<node_t> &program);
+
+}  // namespace control_flow
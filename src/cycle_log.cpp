@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "cycle_log.hpp"
+
+#include "time_str.hpp"
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <utility>
+
+namespace cycle_log {
+
+static constexpr int64_t NS_PER_S = 1000000000;
+
+int64_t now_ns() {
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NS_PER_S + now.tv_nsec;
+}
+
+void summary_t::add(const record_t &record) {
+    const auto exec = record.end - record.start;
+
+    ++cycles;
+    if (record.missed) ++overruns;
+    missed += record.missed;
+    worst = std::max(worst, std::chrono::nanoseconds(exec));
+    sum += static_cast<double>(exec);
+    mean = std::chrono::nanoseconds(static_cast<int64_t>(sum / static_cast<double>(cycles)));
+
+    std::size_t bucket = 0;
+    if (cycle_time.count() > 0) {
+        const auto percent = exec * 100 / cycle_time.count();
+        while (bucket < BUCKET_LIMITS.size() && percent >= static_cast<int64_t>(BUCKET_LIMITS[bucket]))
+            ++bucket;
+    }
+    ++histogram[bucket];
+}
+
+std::ostream &operator<<(std::ostream &out, const summary_t &summary) {
+    auto us = [](std::chrono::nanoseconds ns) { return static_cast<double>(ns.count()) / 1000.0; };
+
+    std::ostringstream sstr;
+    sstr << summary.cycles << " cycles, " << summary.overruns << " overruns (" << summary.missed
+         << " missed deadlines), " << summary.dropped << " not recorded";
+    if (summary.cycles) {
+        sstr << ", execution time mean/worst: " << std::fixed << std::setprecision(1) << us(summary.mean) << '/'
+             << us(summary.worst) << " us, histogram [% of cycle time]";
+        for (std::size_t i = 0; i < summary.histogram.size(); ++i) {
+            if (i < summary_t::BUCKET_LIMITS.size()) sstr << (i ? ", <" : " <") << summary_t::BUCKET_LIMITS[i];
+            else
+                sstr << ", >=" << summary_t::BUCKET_LIMITS.back();
+            sstr << ": " << summary.histogram[i];
+        }
+    }
+    return out << sstr.str();
+}
+
+Reporter::Source::Source(std::string name, std::chrono::nanoseconds cycle_time) : name(std::move(name)) {
+    total.cycle_time    = cycle_time;
+    interval.cycle_time = cycle_time;
+}
+
+Reporter::Reporter(std::chrono::seconds report_interval) : report_interval(report_interval) {}
+
+Reporter::~Reporter() { stop(); }
+
+Reporter::Source &Reporter::add(const std::string &name, std::chrono::nanoseconds cycle_time) {
+    std::lock_guard<std::mutex> lock(mutex);
+    sources.emplace_back(std::make_unique<Source>(name, cycle_time));
+    return *sources.back();
+}
+
+void Reporter::start() { thread = std::thread(&Reporter::work, this); }
+
+void Reporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_flag = true;
+    }
+    cv.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+void Reporter::print_summary(std::ostream &out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &source : sources)
+        drain(*source);
+    summary(out);
+}
+
+void Reporter::work() {
+    // lowest priority: the reporter must never delay a cycle
+    sched_param param {};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+
+    const auto interval_ns = std::chrono::nanoseconds(report_interval).count();
+    auto       last_report = now_ns();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop_flag) {
+        cv.wait_for(lock, POLL_INTERVAL, [this]() { return stop_flag; });
+
+        const auto now    = now_ns();
+        const bool report = interval_ns && now - last_report >= interval_ns;
+        for (auto &source : sources) {
+            drain(*source);
+
+            if (source->warn_overruns &&
+                now - source->last_warning >= std::chrono::nanoseconds(WARNING_INTERVAL).count())
+                warn(*source, now);
+
+            if (source->warn_faults &&
+                now - source->last_fault_warning >= std::chrono::nanoseconds(WARNING_INTERVAL).count())
+                warn_fault(*source, now);
+
+            if (report) {
+                std::cerr << now_str() << " cycle summary" << (source->name.empty() ? "" : " ") << source->name
+                          << " (last " << report_interval.count() << " s): " << source->interval << std::endl;
+                const auto cycle_time       = source->interval.cycle_time;
+                source->interval            = summary_t();
+                source->interval.cycle_time = cycle_time;
+            }
+        }
+        if (report) last_report = now;
+
+        if (summary_requested.exchange(false, std::memory_order_relaxed)) summary(std::cerr);
+    }
+
+    // overruns and skipped cycles of the last cycles
+    for (auto &source : sources) {
+        drain(*source);
+        if (source->warn_overruns) warn(*source, now_ns());
+        if (source->warn_faults) warn_fault(*source, now_ns());
+    }
+}
+
+void Reporter::drain(Source &source) {
+    const auto lost = source.dropped.exchange(0, std::memory_order_relaxed);
+    source.total.dropped += lost;
+    source.interval.dropped += lost;
+
+    const auto faults = source.faults.exchange(0, std::memory_order_acquire);
+    if (faults) {
+        source.warn_faults += faults;
+        source.warn_fault = source.fault.load(std::memory_order_relaxed);
+    }
+
+    record_t record {};
+    while (source.ring.pop(record)) {
+        source.total.add(record);
+        source.interval.add(record);
+        if (record.missed) {
+            ++source.warn_overruns;
+            source.warn_worst = std::max(source.warn_worst, record.end - record.start);
+        }
+    }
+}
+
+void Reporter::warn(Source &source, int64_t now) {
+    std::cerr << now_str() << " WARNING: " << source.name << (source.name.empty() ? "" : ": ")
+              << "cycle time exceeded";
+    if (source.warn_overruns > 1) std::cerr << ' ' << source.warn_overruns << " times";
+    std::cerr << " (worst cycle: " << std::fixed << std::setprecision(1)
+              << static_cast<double>(source.warn_worst) / 1000.0 << " us)" << std::endl;
+    std::cerr.unsetf(std::ios::floatfield);
+
+    source.warn_overruns = 0;
+    source.warn_worst    = 0;
+    source.last_warning  = now;
+}
+
+void Reporter::warn_fault(Source &source, int64_t now) {
+    std::cerr << now_str() << " WARNING: " << source.name << (source.name.empty() ? "" : ": ") << source.warn_fault
+              << " --> ";
+    if (source.warn_faults > 1) std::cerr << source.warn_faults << " cycles skipped" << std::endl;
+    else
+        std::cerr << "cycle skipped" << std::endl;
+
+    source.warn_faults        = 0;
+    source.last_fault_warning = now;
+}
+
+void Reporter::summary(std::ostream &out) const {
+    for (const auto &source : sources)
+        out << now_str() << " cycle summary" << (source->name.empty() ? "" : " ") << source->name << ": "
+            << source->total << std::endl;
+}
+
+}  // namespace cycle_log
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief cycle log: the cycle thread records each cycle, a reporter thread evaluates the records
+ * @details
+ *   The cycle thread only writes a record to the lock-free ring buffer of its source (no system call, no
+ *   allocation, no lock).
+ *   Messages (overrun warnings, summaries) are printed by the reporter thread.
+ */
+namespace cycle_log {
+
+/**
+ * @brief get the current time of CLOCK_MONOTONIC in ns
+ */
+int64_t now_ns();
+
+/**
+ * @brief record of one cycle
+ */
+struct record_t {
+    int64_t     start;   //*< begin of the cycle in ns (CLOCK_MONOTONIC)
+    int64_t     end;     //*< end of the cycle in ns (CLOCK_MONOTONIC)
+    std::size_t missed;  //*< number of deadlines that passed during the cycle (0: no overrun)
+};
+
+/**
+ * @brief lock-free ring buffer for one producer thread and one consumer thread
+ * @tparam T element type
+ * @tparam CAPACITY number of elements (power of two)
+ */
+template <typename T, std::size_t CAPACITY>
+class Ring final {
+    static_assert(CAPACITY != 0 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+private:
+    // head and tail are written by different threads --> separate cache lines
+    alignas(64) std::atomic<std::size_t> head {0};  //*< number of pushed elements (written by the producer)
+    alignas(64) std::atomic<std::size_t> tail {0};  //*< number of popped elements (written by the consumer)
+    std::array<T, CAPACITY> buffer {};
+
+public:
+    /**
+     * @brief add an element (producer)
+     * @return false: the ring is full, the element is dropped
+     */
+    bool push(const T &value) {
+        const auto pos = head.load(std::memory_order_relaxed);
+        if (pos - tail.load(std::memory_order_acquire) == CAPACITY) return false;
+
+        buffer[pos & (CAPACITY - 1)] = value;
+        head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief remove the oldest element (consumer)
+     * @return false: the ring is empty
+     */
+    bool pop(T &value) {
+        const auto pos = tail.load(std::memory_order_relaxed);
+        if (pos == head.load(std::memory_order_acquire)) return false;
+
+        value = buffer[pos & (CAPACITY - 1)];
+        tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+/**
+ * @brief summary of the recorded cycles
+ */
+struct summary_t {
+    //* upper bounds of the histogram buckets in percent of the cycle time (the last bucket has no upper bound)
+    static constexpr std::array<std::size_t, 5> BUCKET_LIMITS {25, 50, 75, 100, 200};
+
+    std::chrono::nanoseconds cycle_time {};  //*< cycle time (reference of the histogram)
+    std::size_t              cycles   = 0;   //*< number of recorded cycles
+    std::size_t              overruns = 0;   //*< number of cycles that exceeded the cycle time
+    std::size_t              missed   = 0;   //*< number of deadlines that passed during the cycles
+    std::size_t              dropped  = 0;   //*< number of cycles that were not recorded (ring buffer full)
+    std::chrono::nanoseconds mean {};        //*< mean execution time
+    std::chrono::nanoseconds worst {};       //*< max execution time
+
+    std::array<std::size_t, BUCKET_LIMITS.size() + 1> histogram {};  //*< execution time histogram
+
+    /**
+     * @brief add a cycle to the summary
+     */
+    void add(const record_t &record);
+
+private:
+    double sum = 0.0;  //*< sum of the execution times in ns
+};
+
+/**
+ * @brief print the summary (one line)
+ */
+std::ostream &operator<<(std::ostream &out, const summary_t &summary);
+
+/**
+ * @brief reporter thread
+ * @details
+ *   Evaluates the records of all sources every POLL_INTERVAL:
+ *     - overrun warnings and warnings about skipped cycles (FAULT SKIP) are combined: at most one warning of each
+ *       kind per source and WARNING_INTERVAL
+ *     - optional periodic summary of the cycles since the last summary
+ *     - summary on request (request_summary)
+ *
+ *   The reporter thread is executed with the scheduling policy SCHED_IDLE. It has to be started before the real-time
+ *   profile is applied, so it does not inherit the CPU affinity and scheduling policy of the cycle threads.
+ */
+class Reporter final {
+public:
+    //* max number of cycles of a source that are buffered between two polls of the reporter
+    static constexpr std::size_t RING_SIZE = 4096;
+
+    static constexpr std::chrono::milliseconds POLL_INTERVAL {100};
+    static constexpr std::chrono::seconds      WARNING_INTERVAL {1};
+
+    /**
+     * @brief cycles of a program or task
+     * @details the records are written by the thread that executes the cycles (at most one thread at a time)
+     */
+    class Source final {
+        friend class Reporter;
+
+    private:
+        std::string               name;  //*< name in the messages (empty: the only source)
+        Ring<record_t, RING_SIZE> ring;
+        std::atomic<std::size_t>  dropped {0};
+
+        summary_t   total;              //*< all cycles
+        summary_t   interval;           //*< cycles since the last periodic summary
+        std::size_t warn_overruns = 0;  //*< overruns since the last warning
+        int64_t     warn_worst    = 0;  //*< worst cycle since the last warning in ns
+        int64_t     last_warning  = 0;  //*< time of the last warning in ns
+
+        std::atomic<std::size_t>  faults {0};                    //*< skipped cycles that were not evaluated yet
+        std::atomic<const char *> fault {nullptr};               //*< description of the last fault
+        std::size_t               warn_faults        = 0;        //*< skipped cycles since the last fault warning
+        const char               *warn_fault         = nullptr;  //*< description of the last fault
+        int64_t                   last_fault_warning = 0;        //*< time of the last fault warning in ns
+
+    public:
+        Source(std::string name, std::chrono::nanoseconds cycle_time);
+
+        Source(const Source &)            = delete;
+        Source &operator=(const Source &) = delete;
+
+        /**
+         * @brief record a cycle (cycle thread only, lock-free)
+         */
+        void record(const record_t &record) {
+            if (!ring.push(record)) dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief record a cycle that was skipped because of a fault (cycle thread only, lock-free)
+         * @param description description of the fault (string literal, see StackMachine::fault_name)
+         */
+        void record_fault(const char *description) {
+            fault.store(description, std::memory_order_relaxed);
+            faults.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+private:
+    std::chrono::seconds                 report_interval;  //*< interval of the periodic summary (0: none)
+    std::atomic<bool>                    summary_requested {false};
+    std::vector<std::unique_ptr<Source>> sources;
+
+    std::thread             thread;
+    std::mutex              mutex;  //*< protects stop_flag and sources
+    std::condition_variable cv;
+    bool                    stop_flag = false;
+
+public:
+    /**
+     * @brief create reporter
+     * @param report_interval interval of the periodic summary (0: none)
+     */
+    explicit Reporter(std::chrono::seconds report_interval);
+
+    Reporter(const Reporter &)            = delete;
+    Reporter &operator=(const Reporter &) = delete;
+
+    ~Reporter();
+
+    /**
+     * @brief add a source
+     * @details can be called while the reporter thread is running
+     * @param name name in the messages (empty: the only source)
+     * @param cycle_time cycle time (overrun reference of the histogram)
+     * @return source (valid until the reporter is destroyed)
+     */
+    Source &add(const std::string &name, std::chrono::nanoseconds cycle_time);
+
+    /**
+     * @brief start the reporter thread
+     */
+    void start();
+
+    /**
+     * @brief evaluate the remaining records and stop the reporter thread
+     */
+    void stop();
+
+    /**
+     * @brief print the summary of all cycles at the next poll of the reporter (async-signal-safe)
+     */
+    void request_summary() { summary_requested.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief print the summary of all evaluated cycles (one line per source)
+     */
+    void print_summary(std::ostream &out);
+
+private:
+    /**
+     * @brief reporter thread
+     */
+    void work();
+
+    /**
+     * @brief evaluate the records of the ring buffer of a source (mutex locked)
+     */
+    static void drain(Source &source);
+
+    /**
+     * @brief print the combined overrun warning of a source (mutex locked)
+     */
+    static void warn(Source &source, int64_t now);
+
+    /**
+     * @brief print the combined warning about the skipped cycles of a source (mutex locked)
+     */
+    static void warn_fault(Source &source, int64_t now);
+
+    /**
+     * @brief print the summary of all sources (mutex locked)
+     */
+    void summary(std::ostream &out) const;
+};
+
+}  // namespace cycle_log
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "fusion.hpp"
+
+#include <array>
+
+/**
+ * @brief check if an operation pushes an operand that can be read by a superinstruction
+ */
+static inline bool is_load(const bytecode::op_t &op) {
+    return op.code == bytecode::opcode_t::PUSH_CONST || op.code == bytecode::opcode_t::PUSH_VAR;
+}
+
+/**
+ * @brief opcode mapping (index: opcode)
+ */
+using fusion_table_t = std::array<bytecode::opcode_t, bytecode::OPCODE_COUNT>;
+
+/**
+ * @brief get a table that maps each opcode to itself (not fused)
+ */
+static constexpr fusion_table_t identity_table() {
+    fusion_table_t table {};
+    for (std::size_t i = 0; i < table.size(); ++i)
+        table[i] = static_cast<bytecode::opcode_t>(i);
+    return table;
+}
+
+/**
+ * @brief superinstruction for L L OP (OP itself if OP can not be fused)
+ */
+static constexpr fusion_table_t FUSED_LLO = []() {
+    auto table = identity_table();
+#define FUSION_LLO(prefix, name, function)                                                                             \
+    table[static_cast<std::size_t>(bytecode::opcode_t::name)] = bytecode::opcode_t::prefix##name;
+    BYTECODE_FUSED_ARITH_OPS(FUSION_LLO, LLO_)
+    BYTECODE_FUSED_COMPARE_OPS(FUSION_LLO, LLO_)
+#undef FUSION_LLO
+    return table;
+}();
+
+/**
+ * @brief superinstruction for L L OP S (OP itself if OP can not be fused)
+ */
+static constexpr fusion_table_t FUSED_LOS = []() {
+    auto table = identity_table();
+#define FUSION_LOS(prefix, name, function)                                                                             \
+    table[static_cast<std::size_t>(bytecode::opcode_t::name)] = bytecode::opcode_t::prefix##name;
+    BYTECODE_FUSED_ARITH_OPS(FUSION_LOS, LOS_)
+    BYTECODE_FUSED_COMPARE_OPS(FUSION_LOS, LOS_)
+#undef FUSION_LOS
+    return table;
+}();
+
+/**
+ * @brief superinstruction for L L CMP JZ (CMP itself if CMP can not be fused)
+ */
+static constexpr fusion_table_t FUSED_CBZ = []() {
+    auto table = identity_table();
+#define FUSION_CBZ(prefix, name, function)                                                                             \
+    table[static_cast<std::size_t>(bytecode::opcode_t::name)] = bytecode::opcode_t::prefix##name;
+    BYTECODE_FUSED_COMPARE_OPS(FUSION_CBZ, CBZ_)
+#undef FUSION_CBZ
+    return table;
+}();
+
+/**
+ * @brief superinstruction for L L CMP JNZ (CMP itself if CMP can not be fused)
+ */
+static constexpr fusion_table_t FUSED_CBNZ = []() {
+    auto table = identity_table();
+#define FUSION_CBNZ(prefix, name, function)                                                                            \
+    table[static_cast<std::size_t>(bytecode::opcode_t::name)] = bytecode::opcode_t::prefix##name;
+    BYTECODE_FUSED_COMPARE_OPS(FUSION_CBNZ, CBNZ_)
+#undef FUSION_CBNZ
+    return table;
+}();
+
+/**
+ * @brief look up the superinstruction of an operation
+ */
+static inline bytecode::opcode_t fused(const fusion_table_t &table, bytecode::opcode_t code) {
+    return table[static_cast<std::size_t>(code)];
+}
+
+bytecode::fusion_stats_t bytecode::fuse(Program &program) {
+    auto          &ops = program.get_ops();
+    fusion_stats_t stats;
+
+    for (auto &op : ops)
+        op.fused = op.code;
+
+    const auto N = ops.size();
+    for (std::size_t i = 0; i < N;) {
+        // longest match first
+        if (i + 3 < N && is_load(ops[i]) && is_load(ops[i + 1])) {
+            const auto code = ops[i + 2].code;
+            const auto next = ops[i + 3].code;
+
+            if (next == opcode_t::JZ || next == opcode_t::JNZ) {
+                const auto super = fused(next == opcode_t::JNZ ? FUSED_CBNZ : FUSED_CBZ, code);
+                if (super != code) {
+                    ops[i].fused = super;
+                    ++stats.superinstructions;
+                    stats.instructions += 4;
+                    i += 4;
+                    continue;
+                }
+            } else if (next == opcode_t::POP_VAR) {
+                const auto super = fused(FUSED_LOS, code);
+                if (super != code) {
+                    ops[i].fused = super;
+                    ++stats.superinstructions;
+                    stats.instructions += 4;
+                    i += 4;
+                    continue;
+                }
+            }
+        }
+
+        if (i + 2 < N && is_load(ops[i]) && is_load(ops[i + 1])) {
+            const auto code  = ops[i + 2].code;
+            const auto super = fused(FUSED_LLO, code);
+            if (super != code) {
+                ops[i].fused = super;
+                ++stats.superinstructions;
+                stats.instructions += 3;
+                i += 3;
+                continue;
+            }
+        }
+
+        if (i + 1 < N && is_load(ops[i]) && ops[i + 1].code == opcode_t::POP_VAR) {
+            ops[i].fused = opcode_t::MOV;
+            ++stats.superinstructions;
+            stats.instructions += 2;
+            i += 2;
+            continue;
+        }
+
+        ++i;
+    }
+
+    return stats;
+}
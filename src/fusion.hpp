@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "bytecode.hpp"
+
+namespace bytecode {
+
+/**
+ * @brief result of the superinstruction fusion pass
+ */
+struct fusion_stats_t {
+    std::size_t superinstructions = 0;  //*< number of generated superinstructions
+    std::size_t instructions      = 0;  //*< number of operations that are covered by superinstructions
+};
+
+/**
+ * @brief fuse common operation sequences into superinstructions
+ * @details
+ *   Sets op_t::fused of the first operation of each recognized sequence (see BYTECODE_FUSED_OPS).
+ *   The operations themselves are not modified or removed, so jump targets stay valid.
+ *   Must run after all passes that modify the operations of the program.
+ *
+ * @param program program to optimize
+ * @return fusion statistics
+ */
+fusion_stats_t fuse(Program &program);
+
+}  // namespace bytecode
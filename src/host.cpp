@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "host.hpp"
+
+#include "time_str.hpp"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace host {
+
+static constexpr int64_t NS_PER_S = 1000000000;
+
+/**
+ * @brief get the current time of CLOCK_MONOTONIC in ns
+ */
+static int64_t now_ns() {
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NS_PER_S + now.tv_nsec;
+}
+
+/**
+ * @brief deadline queue order (min heap)
+ */
+template <typename T>
+static bool later(const T *a, const T *b) {
+    return a->deadline > b->deadline;
+}
+
+std::vector<std::string> read_manifest(const std::string &path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::ostringstream sstr;
+        sstr << "failed to open manifest '" << path << "'";
+        throw std::runtime_error(sstr.str());
+    }
+
+    const auto               base = std::filesystem::path(path).parent_path();
+    std::vector<std::string> files;
+    std::string              line;
+    while (std::getline(file, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+
+        const std::filesystem::path program(line);
+        files.emplace_back(program.is_absolute() ? program.string() : (base / program).string());
+    }
+
+    if (files.empty()) {
+        std::ostringstream sstr;
+        sstr << "manifest '" << path << "' contains no program";
+        throw std::runtime_error(sstr.str());
+    }
+
+    return files;
+}
+
+std::ostream &operator<<(std::ostream &out, const task_stats_t &stats) {
+    std::ostringstream sstr;
+    sstr << stats.name << ": " << stats.cycles << " cycles, " << stats.overruns << " overruns, " << stats.skipped
+         << " skipped, " << stats.stolen << " stolen";
+    if (stats.failed) sstr << ", failed";
+    return out << sstr.str();
+}
+
+Pool::Pool(std::size_t threads) {
+    if (threads == 0) throw std::invalid_argument("number of worker threads must not be zero");
+
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        workers.emplace_back(std::make_unique<worker_t>());
+}
+
+Pool::~Pool() { stop(); }
+
+void Pool::add(const std::string &name, Machine &machine) {
+    auto task        = std::make_unique<task_t>();
+    task->name       = name;
+    task->machine    = &machine;
+    task->cycle_time = machine.get_cycle_time().count();
+    task->overrun    = machine.get_overrun_policy();
+    task->remaining  = machine.get_cycles();
+    task->inf        = machine.get_cycles() == 0;
+    task->deadline   = 0;
+    tasks.emplace_back(std::move(task));
+}
+
+void Pool::start() {
+    if (reporter) {
+        for (auto &task : tasks) {
+            task->log = &reporter->add(task->name, std::chrono::nanoseconds(task->cycle_time));
+            task->machine->set_fault_log(task->log);
+        }
+    }
+
+    const auto now = now_ns();
+
+    // distribute the machines round robin
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        tasks[i]->deadline = now;
+        push(*workers[i % workers.size()], tasks[i].get());
+    }
+    active = tasks.size();
+
+    for (std::size_t i = 0; i < workers.size(); ++i)
+        workers[i]->thread = std::thread(&Pool::work, this, i);
+}
+
+void Pool::stop() {
+    stop_flag = true;
+    for (auto &worker : workers)
+        if (worker->thread.joinable()) worker->thread.join();
+}
+
+std::vector<task_stats_t> Pool::get_stats() const {
+    std::vector<task_stats_t> stats;
+    stats.reserve(tasks.size());
+    for (const auto &task : tasks)
+        stats.push_back({task->name, task->cycles, task->overruns, task->skipped, task->stolen, task->failed});
+    return stats;
+}
+
+std::size_t Pool::get_failed() const {
+    return static_cast<std::size_t>(std::count_if(
+            tasks.begin(), tasks.end(), [](const std::unique_ptr<task_t> &task) { return task->failed.load(); }));
+}
+
+Pool::task_t *Pool::pop_due(worker_t &worker, int64_t now, bool steal) {
+    std::unique_lock<std::mutex> lock(worker.mutex, std::defer_lock);
+    if (steal) {
+        if (!lock.try_lock()) return nullptr;
+    } else {
+        lock.lock();
+    }
+
+    if (worker.queue.empty() || worker.queue.front()->deadline > now) return nullptr;
+
+    std::pop_heap(worker.queue.begin(), worker.queue.end(), later<task_t>);
+    auto *task = worker.queue.back();
+    worker.queue.pop_back();
+    return task;
+}
+
+void Pool::push(worker_t &worker, task_t *task) {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.queue.push_back(task);
+    std::push_heap(worker.queue.begin(), worker.queue.end(), later<task_t>);
+}
+
+void Pool::work(std::size_t index) {
+    auto &self = *workers[index];
+
+    while (!stop_flag && active) {
+        auto  now  = now_ns();
+        auto *task = pop_due(self, now, false);
+
+        // steal a due cycle from another worker (starting with the next worker)
+        for (std::size_t i = 1; !task && i < workers.size(); ++i) {
+            task = pop_due(*workers[(index + i) % workers.size()], now, true);
+            if (task) ++task->stolen;
+        }
+
+        if (!task) {
+            auto wakeup = now + std::chrono::nanoseconds(STEAL_INTERVAL).count();
+            {
+                std::lock_guard<std::mutex> lock(self.mutex);
+                if (!self.queue.empty()) wakeup = std::min(wakeup, self.queue.front()->deadline);
+            }
+
+            timespec ts {};
+            ts.tv_sec  = wakeup / NS_PER_S;
+            ts.tv_nsec = wakeup % NS_PER_S;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);  // interrupted: check the queues again
+            continue;
+        }
+
+        const auto begin = now_ns();
+        try {
+            task->machine->run();
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: " << task->name << ": execution failed: " << e.what() << std::endl;
+            task->failed = true;
+            --active;
+            continue;
+        }
+        ++task->cycles;
+        now = now_ns();
+
+        std::size_t missed = 0;
+        const bool  done   = !task->inf && --task->remaining == 0;
+        if (!done) {
+            task->deadline += task->cycle_time;
+            if (now >= task->deadline) {
+                ++task->overruns;
+                missed = static_cast<std::size_t>((now - task->deadline) / task->cycle_time) + 1;
+
+                if (task->overrun == scheduler::overrun_t::skip) {
+                    task->deadline += static_cast<int64_t>(missed) * task->cycle_time;
+                    task->skipped += missed;
+                }
+            }
+        }
+
+        // no output in the worker thread: overrun warnings are printed (rate limited) by the reporter
+        if (task->log) task->log->record({begin, now, missed});
+
+        if (done) {
+            --active;
+            continue;
+        }
+
+        push(self, task);
+    }
+}
+
+}  // namespace host
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "Machine.hpp"
+#include "cycle_log.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief execute multiple programs in one process (host mode)
+ * @details
+ *   Each program has its own Machine and cycle time. The cycles are executed by a fixed pool of worker threads:
+ *     - each worker has a deadline queue (min heap, earliest begin of the next cycle first)
+ *     - a worker executes the due cycles of its own queue
+ *     - if no cycle of its own queue is due, it steals a due cycle from the queue of another worker
+ *     - after a cycle the machine is queued at the worker that executed it
+ *   A machine is executed by at most one worker at a time.
+ */
+namespace host {
+
+/**
+ * @brief read a manifest file
+ * @details one program file per line, empty lines and lines starting with # are ignored.
+ *          Relative paths are relative to the directory of the manifest.
+ * @param path path of the manifest
+ * @return program files
+ * @exception std::runtime_error failed to read the manifest
+ */
+std::vector<std::string> read_manifest(const std::string &path);
+
+/**
+ * @brief statistics of a machine
+ */
+struct task_stats_t {
+    std::string name;      //*< program name
+    std::size_t cycles;    //*< number of executed cycles
+    std::size_t overruns;  //*< number of cycles that exceeded the cycle time
+    std::size_t skipped;   //*< number of dropped cycles (OVERRUN SKIP)
+    std::size_t stolen;    //*< number of cycles that were stolen from the queue of another worker
+    bool        failed;    //*< the execution was stopped by an error
+};
+
+/**
+ * @brief print the statistics of a machine (one line)
+ */
+std::ostream &operator<<(std::ostream &out, const task_stats_t &stats);
+
+/**
+ * @brief worker pool that executes the cycles of multiple machines
+ */
+class Pool final {
+public:
+    //* max time an idle worker sleeps before it checks the queues of the other workers again
+    static constexpr std::chrono::microseconds STEAL_INTERVAL {200};
+
+private:
+    /**
+     * @brief machine that is executed by the pool
+     */
+    struct task_t {
+        std::string              name;        //*< program name
+        Machine                 *machine;     //*< machine
+        int64_t                  cycle_time;  //*< cycle time in ns
+        scheduler::overrun_t     overrun;     //*< overrun policy
+        std::size_t              remaining;   //*< number of remaining cycles
+        bool                     inf;         //*< infinite number of cycles
+        int64_t                  deadline;    //*< begin of the next cycle in ns (CLOCK_MONOTONIC)
+        std::atomic<std::size_t> cycles {0};
+        std::atomic<std::size_t> overruns {0};
+        std::atomic<std::size_t> skipped {0};
+        std::atomic<std::size_t> stolen {0};
+        std::atomic<bool>        failed {false};
+
+        cycle_log::Reporter::Source *log = nullptr;  //*< cycle log (nullptr: none)
+    };
+
+    /**
+     * @brief worker thread
+     */
+    struct worker_t {
+        std::mutex            mutex;  //*< protects queue
+        std::vector<task_t *> queue;  //*< deadline queue (min heap)
+        std::thread           thread;
+    };
+
+    std::vector<std::unique_ptr<task_t>>   tasks;
+    std::vector<std::unique_ptr<worker_t>> workers;
+    std::atomic<bool>                      stop_flag {false};
+    std::atomic<std::size_t>               active {0};  //*< number of tasks that are not finished
+
+    cycle_log::Reporter *reporter = nullptr;  //*< reporter of the overruns (nullptr: none)
+
+public:
+    /**
+     * @brief create pool
+     * @param threads number of worker threads
+     * @exception std::invalid_argument threads is zero
+     */
+    explicit Pool(std::size_t threads);
+
+    Pool(const Pool &)            = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    ~Pool();
+
+    /**
+     * @brief add a machine
+     * @details has to be called before start. The cycle time, overrun policy and number of cycles are taken from the
+     *          machine.
+     * @param name program name (messages and statistics)
+     * @param machine initialized machine (has to outlive the pool)
+     */
+    void add(const std::string &name, Machine &machine);
+
+    /**
+     * @brief record the cycles of all machines in the cycle log of a reporter
+     * @details has to be called before start. Overruns are reported (rate limited) by the reporter thread.
+     * @param reporter reporter (has to outlive the pool)
+     */
+    void set_reporter(cycle_log::Reporter &reporter) { this->reporter = &reporter; }
+
+    /**
+     * @brief start the worker threads
+     * @details the first cycle of all machines is due immediately. Adds a source per machine to the reporter (see
+     *          set_reporter).
+     */
+    void start();
+
+    /**
+     * @brief check if any machine still has cycles to execute
+     */
+    [[nodiscard]] bool running() const { return active.load() != 0; }
+
+    /**
+     * @brief stop the execution and join the worker threads
+     */
+    void stop();
+
+    /**
+     * @brief get the statistics of all machines
+     */
+    [[nodiscard]] std::vector<task_stats_t> get_stats() const;
+
+    /**
+     * @brief get the number of machines that were stopped by an error
+     */
+    [[nodiscard]] std::size_t get_failed() const;
+
+private:
+    /**
+     * @brief worker thread
+     * @param index worker index
+     */
+    void work(std::size_t index);
+
+    /**
+     * @brief remove the task with the earliest deadline from the queue of a worker if it is due
+     * @param worker worker
+     * @param now current time in ns
+     * @param steal do not wait for the lock of the queue
+     * @return due task (nullptr: no due task)
+     */
+    static task_t *pop_due(worker_t &worker, int64_t now, bool steal);
+
+    /**
+     * @brief add a task to the queue of a worker
+     */
+    static void push(worker_t &worker, task_t *task);
+};
+
+}  // namespace host
@@ -5,19 +5,72 @@
 
 #include "instruction.hpp"
 
-std::size_t instr::J::dummy = 0;
+#include <stdexcept>
 
-bool instr::PUSH_const::exec() {
-    machine.push(src.value);
-    return true;
+void var_t::resolve() {
+    if (is_resolved()) return;
+
+    if (auto local = dynamic_cast<MemoryLocal *>(&mem)) {
+        addr     = local->get_cell(cell);
+        load_fn  = &mem_access::load_native;
+        store_fn = &mem_access::store_native;
+    } else if (auto real = dynamic_cast<MemoryReal *>(&mem)) {
+        if (real->has_bit_cache() && mem_access::is_bit(data_type)) {
+            const auto access = mem_access::bit_accessor(data_type, real->get_cell_size());
+            addr              = real->get_bit_cell(cell, data_type, index);
+            load_fn           = access.load;
+            store_fn          = access.store;
+            cached            = true;
+            return;
+        }
+
+        const auto access = mem_access::accessor(data_type, real->get_cell_size());
+        addr              = real->get_var_addr(cell, data_type, index);
+        load_fn           = access.load;
+        store_fn          = access.store;
+        dirty             = real->get_dirty_flag(cell);
+    } else {
+        throw std::logic_error("unknown memory type");
+    }
 }
 
-bool instr::PUSH_var::exec() {
-    machine.push(src.mem.load(src.cell, src.data_type, src.index));
-    return true;
+template <typename Trace>
+std::unique_ptr<instr::PUSH> instr::make_push(StackMachine &machine, var_t &var) {
+    var.resolve();
+
+    if (dynamic_cast<MemoryLocal *>(&var.mem))
+        return std::make_unique<PUSH_local<Trace>>(machine, static_cast<const StackMachine::stack_t *>(var.addr));
+
+    const auto &real = dynamic_cast<const MemoryReal &>(var.mem);
+    return mem_access::visit(var.data_type, real.get_cell_size(), [&](auto access) -> std::unique_ptr<PUSH> {
+        typedef decltype(access) A;
+        if constexpr (mem_access::is_bit(A::data_type)) {
+            if (var.cached)
+                return std::make_unique<PUSH_bit<Trace, A::data_type, A::cell_size>>(machine, var.addr, var.index);
+        }
+        return std::make_unique<PUSH_real<Trace, A::data_type, A::cell_size>>(machine, var.addr, var.index);
+    });
 }
 
-bool instr::POP_var::exec() {
-    dst.mem.store(machine.pop(), dst.cell, dst.data_type, dst.index);
-    return true;
+template <typename Trace>
+std::unique_ptr<instr::POP> instr::make_pop(StackMachine &machine, var_t &var) {
+    var.resolve();
+
+    if (dynamic_cast<MemoryLocal *>(&var.mem))
+        return std::make_unique<POP_local<Trace>>(machine, static_cast<StackMachine::stack_t *>(var.addr));
+
+    const auto &real = dynamic_cast<const MemoryReal &>(var.mem);
+    return mem_access::visit(var.data_type, real.get_cell_size(), [&](auto access) -> std::unique_ptr<POP> {
+        typedef decltype(access) A;
+        if constexpr (mem_access::is_bit(A::data_type)) {
+            if (var.cached)
+                return std::make_unique<POP_bit<Trace, A::data_type, A::cell_size>>(machine, var.addr, var.index);
+        }
+        return std::make_unique<POP_real<Trace, A::data_type, A::cell_size>>(machine, var.addr, var.index, var.dirty);
+    });
 }
+
+template std::unique_ptr<instr::PUSH> instr::make_push<tracing::off>(StackMachine &machine, var_t &var);
+template std::unique_ptr<instr::PUSH> instr::make_push<tracing::on>(StackMachine &machine, var_t &var);
+template std::unique_ptr<instr::POP>  instr::make_pop<tracing::off>(StackMachine &machine, var_t &var);
+template std::unique_ptr<instr::POP>  instr::make_pop<tracing::on>(StackMachine &machine, var_t &var);
@@ -5,10 +5,12 @@
 
 #pragma once
 
+#include <memory>
 #include <utility>
 
 #include "Memory.hpp"
 #include "StackMachine.hpp"
+#include "memory_access.hpp"
 
 struct var_t {
     Memory               &mem;
@@ -18,8 +20,40 @@ struct var_t {
     bool                  init       = false;
     StackMachine::stack_t init_value = 0;
 
+    void                *addr     = nullptr;  //*< address of the base cell (valid after resolve)
+    mem_access::load_t   load_fn  = nullptr;  //*< specialized load function (valid after resolve)
+    mem_access::store_t  store_fn = nullptr;  //*< specialized store function (valid after resolve)
+    bool                 cached   = false;    //*< addr is a cached bit cell (see MemoryReal::enable_bit_cache)
+    uint8_t             *dirty    = nullptr;  //*< dirty flag of the process image (see MemoryReal::get_dirty_flag)
+
     var_t(Memory &mem, Memory::dtype_t data_type, std::size_t cell, std::size_t index = 0)
         : mem(mem), data_type(data_type), cell(cell), index(index) {}
+
+    /**
+     * @brief check the access to the variable and resolve its address and access functions
+     * @details does nothing if the variable is already resolved
+     * @exception std::runtime_error memory cell size is to large for the data type
+     * @exception std::out_of_range memory cell or bit index out of range
+     */
+    void resolve();
+
+    /**
+     * @brief check if the variable is resolved
+     */
+    [[nodiscard]] bool is_resolved() const { return addr != nullptr; }
+
+    /**
+     * @brief load the variable (unchecked, variable has to be resolved)
+     */
+    [[nodiscard]] StackMachine::stack_t load() const { return load_fn(addr, index); }
+
+    /**
+     * @brief store the variable (unchecked, variable has to be resolved)
+     */
+    void store(StackMachine::stack_t value) const {
+        store_fn(addr, index, value);
+        if (dirty) *dirty = 1;
+    }
 };
 
 struct const_t {
@@ -38,6 +72,10 @@ protected:
 public:
     virtual ~Instruction() = default;
 
+    /**
+     * @brief execute the instruction
+     * @return false: stop the execution of the program (end of program or fault, see StackMachine::get_fault)
+     */
     virtual bool exec() = 0;
 };
 
@@ -58,8 +96,9 @@ protected:
     virtual bool cond() = 0;
 
 public:
-    void set_target(std::size_t new_target) { target = new_target; }
-    bool exec() override {
+    void        set_target(std::size_t new_target) { target = new_target; }
+    std::size_t get_target() const { return target; }
+    bool        exec() override {
         if (cond()) ip = target;
         return true;
     }
@@ -70,22 +109,68 @@ protected:
     explicit PUSH(StackMachine &machine) : Instruction(machine) {}
 };
 
+template <typename Trace>
 class PUSH_const : public PUSH {
 private:
     const_t &src;
 
 public:
     explicit PUSH_const(StackMachine &machine, const_t &src) : PUSH(machine), src(src) {}
-    bool exec() override;
+    bool exec() override {
+        machine.push<Trace>(src.value);
+        return true;
+    }
 };
 
+template <typename Trace>
 class PUSH_var : public PUSH {
 private:
     var_t &src;
 
 public:
     explicit PUSH_var(StackMachine &machine, var_t &src) : PUSH(machine), src(src) {}
-    bool exec() override;
+    bool exec() override {
+        machine.push<Trace>(src.mem.load(src.cell, src.data_type, src.index));
+        return true;
+    }
+};
+
+/**
+ * @brief push a cell of a local memory
+ */
+template <typename Trace>
+class PUSH_local : public PUSH {
+private:
+    const StackMachine::stack_t *src;
+
+public:
+    explicit PUSH_local(StackMachine &machine, const StackMachine::stack_t *src) : PUSH(machine), src(src) {}
+    bool exec() override {
+        machine.push<Trace>(*src);
+        return true;
+    }
+};
+
+/**
+ * @brief push a variable of a real memory
+ * @details data type and memory cell size are resolved at load time (see make_push)
+ * @tparam Trace tracing policy
+ * @tparam T data type
+ * @tparam CELL_SIZE memory cell size
+ */
+template <typename Trace, Memory::dtype_t T, std::size_t CELL_SIZE>
+class PUSH_real : public PUSH {
+private:
+    const void *src;
+    std::size_t index;
+
+public:
+    explicit PUSH_real(StackMachine &machine, const void *src, std::size_t index)
+        : PUSH(machine), src(src), index(index) {}
+    bool exec() override {
+        machine.push<Trace>(mem_access::load<T, CELL_SIZE>(src, index));
+        return true;
+    }
 };
 
 class POP : public Instruction {
@@ -95,589 +180,756 @@ protected:
 public:
 };
 
+template <typename Trace>
 class POP_var : public POP {
 private:
     var_t &dst;
 
 public:
     explicit POP_var(StackMachine &machine, var_t &dst) : POP(machine), dst(dst) {}
-    bool exec() override;
+    bool exec() override {
+        dst.mem.store(machine.pop<Trace>(), dst.cell, dst.data_type, dst.index);
+        return true;
+    }
 };
 
+/**
+ * @brief pop to a cell of a local memory
+ */
+template <typename Trace>
+class POP_local : public POP {
+private:
+    StackMachine::stack_t *dst;
+
+public:
+    explicit POP_local(StackMachine &machine, StackMachine::stack_t *dst) : POP(machine), dst(dst) {}
+    bool exec() override {
+        *dst = machine.pop<Trace>();
+        return true;
+    }
+};
+
+/**
+ * @brief pop to a variable of a real memory
+ * @details data type and memory cell size are resolved at load time (see make_pop)
+ * @tparam Trace tracing policy
+ * @tparam T data type
+ * @tparam CELL_SIZE memory cell size
+ */
+template <typename Trace, Memory::dtype_t T, std::size_t CELL_SIZE>
+class POP_real : public POP {
+private:
+    void       *dst;
+    std::size_t index;
+    uint8_t    *dirty;  //*< dirty flag of the process image (nullptr: none)
+
+public:
+    explicit POP_real(StackMachine &machine, void *dst, std::size_t index, uint8_t *dirty)
+        : POP(machine), dst(dst), index(index), dirty(dirty) {}
+    bool exec() override {
+        mem_access::store<T, CELL_SIZE>(dst, index, machine.pop<Trace>());
+        if (dirty) *dirty = 1;
+        return true;
+    }
+};
+
+/**
+ * @brief push a bit variable with cached memory cell (see MemoryReal::enable_bit_cache)
+ * @tparam Trace tracing policy
+ * @tparam T data type (le1 or be1)
+ * @tparam CELL_SIZE memory cell size
+ */
+template <typename Trace, Memory::dtype_t T, std::size_t CELL_SIZE>
+class PUSH_bit : public PUSH {
+private:
+    const void *src;
+    std::size_t index;
+
+public:
+    explicit PUSH_bit(StackMachine &machine, const void *src, std::size_t index)
+        : PUSH(machine), src(src), index(index) {}
+    bool exec() override {
+        machine.push<Trace>(mem_access::load_bit<T, CELL_SIZE>(src, index));
+        return true;
+    }
+};
+
+/**
+ * @brief pop to a bit variable with cached memory cell (see MemoryReal::enable_bit_cache)
+ * @tparam Trace tracing policy
+ * @tparam T data type (le1 or be1)
+ * @tparam CELL_SIZE memory cell size
+ */
+template <typename Trace, Memory::dtype_t T, std::size_t CELL_SIZE>
+class POP_bit : public POP {
+private:
+    void       *dst;
+    std::size_t index;
+
+public:
+    explicit POP_bit(StackMachine &machine, void *dst, std::size_t index) : POP(machine), dst(dst), index(index) {}
+    bool exec() override {
+        mem_access::store_bit<T, CELL_SIZE>(dst, index, machine.pop<Trace>());
+        return true;
+    }
+};
+
+/**
+ * @brief create a push instruction that is specialized for the data type and memory of a variable
+ * @details resolves the variable (see var_t::resolve)
+ * @tparam Trace tracing policy
+ * @param machine stack machine
+ * @param var variable
+ * @return push instruction
+ */
+template <typename Trace>
+std::unique_ptr<PUSH> make_push(StackMachine &machine, var_t &var);
+
+/**
+ * @brief create a pop instruction that is specialized for the data type and memory of a variable
+ * @details resolves the variable (see var_t::resolve)
+ * @tparam Trace tracing policy
+ * @param machine stack machine
+ * @param var variable
+ * @return pop instruction
+ */
+template <typename Trace>
+std::unique_ptr<POP> make_pop(StackMachine &machine, var_t &var);
+
+template <typename Trace>
 class ADD : public OnStack {
 public:
     explicit ADD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.add();
+        machine.add<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class SUB : public OnStack {
 public:
     explicit SUB(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.sub();
+        machine.sub<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class MUL : public OnStack {
 public:
     explicit MUL(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.mul();
+        machine.mul<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class MULS : public OnStack {
 public:
     explicit MULS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.muls();
+        machine.muls<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class DIV : public OnStack {
 public:
     explicit DIV(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.div();
-        return true;
+        machine.div<Trace>();
+        return !machine.faulted();
     }
 };
 
+template <typename Trace>
 class DIVS : public OnStack {
 public:
     explicit DIVS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.divs();
-        return true;
+        machine.divs<Trace>();
+        return !machine.faulted();
     }
 };
 
+template <typename Trace>
 class MOD : public OnStack {
 public:
     explicit MOD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.mod();
-        return true;
+        machine.mod<Trace>();
+        return !machine.faulted();
     }
 };
 
+template <typename Trace>
 class MODS : public OnStack {
 public:
     explicit MODS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.mods();
-        return true;
+        machine.mods<Trace>();
+        return !machine.faulted();
     }
 };
 
+template <typename Trace>
 class POW : public OnStack {
 public:
     explicit POW(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.pow();
+        machine.pow<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class POWS : public OnStack {
 public:
     explicit POWS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.pows();
+        machine.pows<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ADDF : public OnStack {
 public:
     explicit ADDF(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.addf();
+        machine.addf<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class SUBF : public OnStack {
 public:
     explicit SUBF(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.subf();
+        machine.subf<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class MULF : public OnStack {
 public:
     explicit MULF(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.mulf();
+        machine.mulf<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class DIVF : public OnStack {
 public:
     explicit DIVF(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.divf();
+        machine.divf<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class POWF : public OnStack {
 public:
     explicit POWF(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.powf();
+        machine.powf<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ADDD : public OnStack {
 public:
     explicit ADDD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.addd();
+        machine.addd<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class SUBD : public OnStack {
 public:
     explicit SUBD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.subd();
+        machine.subd<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class MULD : public OnStack {
 public:
     explicit MULD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.muld();
+        machine.muld<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class DIVD : public OnStack {
 public:
     explicit DIVD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.divd();
+        machine.divd<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class POWD : public OnStack {
 public:
     explicit POWD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.powd();
+        machine.powd<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class NOT : public OnStack {
 public:
     explicit NOT(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.linv();
+        machine.linv<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class AND : public OnStack {
 public:
     explicit AND(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.land();
+        machine.land<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class OR : public OnStack {
 public:
     explicit OR(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.lor();
+        machine.lor<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class XOR : public OnStack {
 public:
     explicit XOR(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.lxor();
+        machine.lxor<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class INV : public OnStack {
 public:
     explicit INV(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.binv();
+        machine.binv<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class BAND : public OnStack {
 public:
     explicit BAND(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.band();
+        machine.band<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class BOR : public OnStack {
 public:
     explicit BOR(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.bor();
+        machine.bor<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class BXOR : public OnStack {
 public:
     explicit BXOR(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.bxor();
+        machine.bxor<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ITOF : public OnStack {
 public:
     explicit ITOF(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.itof();
+        machine.itof<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ITOD : public OnStack {
 public:
     explicit ITOD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.itod();
+        machine.itod<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class FTOI : public OnStack {
 public:
     explicit FTOI(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ftoi();
+        machine.ftoi<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class DTOI : public OnStack {
 public:
     explicit DTOI(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.dtoi();
+        machine.dtoi<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class FTOD : public OnStack {
 public:
     explicit FTOD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ftod();
+        machine.ftod<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class DTOF : public OnStack {
 public:
     explicit DTOF(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.dtof();
+        machine.dtof<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class EQ : public OnStack {
 public:
     explicit EQ(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.eq();
+        machine.eq<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class NE : public OnStack {
 public:
     explicit NE(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ne();
+        machine.ne<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LT : public OnStack {
 public:
     explicit LT(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.lt();
+        machine.lt<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class GT : public OnStack {
 public:
     explicit GT(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.gt();
+        machine.gt<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LE : public OnStack {
 public:
     explicit LE(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.le();
+        machine.le<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class GE : public OnStack {
 public:
     explicit GE(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ge();
+        machine.ge<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LTS : public OnStack {
 public:
     explicit LTS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.lts();
+        machine.lts<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class GTS : public OnStack {
 public:
     explicit GTS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.gts();
+        machine.gts<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LES : public OnStack {
 public:
     explicit LES(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.les();
+        machine.les<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class GES : public OnStack {
 public:
     explicit GES(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ges();
+        machine.ges<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LTD : public OnStack {
 public:
     explicit LTD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ltd();
+        machine.ltd<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class GTD : public OnStack {
 public:
     explicit GTD(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.gtd();
+        machine.gtd<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LED : public OnStack {
 public:
     explicit LED(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.led();
+        machine.led<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class GED : public OnStack {
 public:
     explicit GED(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ged();
+        machine.ged<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ABS : public OnStack {
 public:
     explicit ABS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.abs();
+        machine.abs<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class SQRT : public OnStack {
 public:
     explicit SQRT(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.sqrt();
+        machine.sqrt<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class CBRT : public OnStack {
 public:
     explicit CBRT(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.cbrt();
+        machine.cbrt<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LN : public OnStack {
 public:
     explicit LN(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.ln();
+        machine.ln<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LOG : public OnStack {
 public:
     explicit LOG(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.log();
+        machine.log<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class LG : public OnStack {
 public:
     explicit LG(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.lg();
+        machine.lg<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class SIN : public OnStack {
 public:
     explicit SIN(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.sin();
+        machine.sin<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class COS : public OnStack {
 public:
     explicit COS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.cos();
+        machine.cos<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class TAN : public OnStack {
 public:
     explicit TAN(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.tan();
+        machine.tan<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ASIN : public OnStack {
 public:
     explicit ASIN(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.asin();
+        machine.asin<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ACOS : public OnStack {
 public:
     explicit ACOS(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.acos();
+        machine.acos<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ATAN : public OnStack {
 public:
     explicit ATAN(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.atan();
+        machine.atan<Trace>();
         return true;
     }
 };
 
+template <typename Trace>
 class ATANXY : public OnStack {
 public:
     explicit ATANXY(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.atanxy();
+        machine.atanxy<Trace>();
         return true;
     }
 };
 
 class J : public Jump {
-private:
-    static std::size_t dummy;
-
 public:
-    explicit J(StackMachine &machine) : Jump(machine, dummy) {}
+    explicit J(StackMachine &machine, std::size_t &ip) : Jump(machine, ip) {}
 
 protected:
     bool cond() override { return true; }
 };
 
+template <typename Trace>
 class JZ : public Jump {
 public:
     explicit JZ(StackMachine &machine, std::size_t &ip) : Jump(machine, ip) {}
 
 protected:
-    bool cond() override { return machine.pop() == 0; }
+    bool cond() override { return machine.pop<Trace>() == 0; }
 };
 
+template <typename Trace>
 class JNZ : public Jump {
 public:
     explicit JNZ(StackMachine &machine, std::size_t &ip) : Jump(machine, ip) {}
 
 protected:
-    bool cond() override { return machine.pop() != 0; }
+    bool cond() override { return machine.pop<Trace>() != 0; }
 };
 
 class LABEL : public Instruction {
@@ -689,11 +941,12 @@ public:
     bool exec() override { return true; }
 };
 
+template <typename Trace>
 class DUP : public OnStack {
 public:
     explicit DUP(StackMachine &machine) : OnStack(machine) {}
     bool exec() override {
-        machine.dup();
+        machine.dup<Trace>();
         return true;
     }
 };
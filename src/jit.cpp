@@ -0,0 +1,657 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "jit.hpp"
+
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__x86_64__) && defined(OS_POSIX)
+#    define JIT_X86_64
+#    include <array>
+#    include <cerrno>
+#    include <cstdint>
+#    include <sys/mman.h>
+#endif
+
+bool jit::available() {
+#ifdef JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef JIT_X86_64
+
+/**
+ * @brief runtime context of the generated code
+ */
+struct context_t {
+    StackMachine::stack_t *stack;    //*< stack slots (first member: loaded by the generated code)
+    StackMachine          *machine;  //*< stack machine for operations without native implementation
+    std::exception_ptr     error;    //*< exception that was thrown by a helper function (null: fault)
+};
+
+/** @brief signature of the generated code: returns 0 on success */
+typedef int (*entry_t)(context_t *);
+
+/**
+ * @brief load variable into a stack slot
+ * @details called by the generated code
+ * @return 0 on success, 1 if an exception was thrown (stored in the context)
+ */
+static int helper_load(context_t *ctx, const var_t *var, std::size_t slot) noexcept {
+    try {
+        ctx->stack[slot] = var->load();
+        return 0;
+    } catch (...) {
+        ctx->error = std::current_exception();
+        return 1;
+    }
+}
+
+/**
+ * @brief store a stack slot in a variable
+ * @details called by the generated code
+ * @return 0 on success, 1 if an exception was thrown (stored in the context)
+ */
+static int helper_store(context_t *ctx, const var_t *var, std::size_t slot) noexcept {
+    try {
+        var->store(ctx->stack[slot]);
+        return 0;
+    } catch (...) {
+        ctx->error = std::current_exception();
+        return 1;
+    }
+}
+
+/** @brief stack machine method of a stack operation */
+typedef void (StackMachine::*method_t)();
+
+/**
+ * @brief stack machine method of each opcode (nullptr: not a stack operation)
+ */
+static constexpr method_t STACK_METHOD[] = {
+#    define JIT_METHOD_CONTROL(name)                 nullptr,
+#    define JIT_METHOD_STACK(name, method)           &StackMachine::method<>,
+#    define JIT_METHOD_FUSED(prefix, name, function) nullptr,
+        BYTECODE_CONTROL_OPS(JIT_METHOD_CONTROL) BYTECODE_STACK_OPS(JIT_METHOD_STACK)
+                BYTECODE_FUSED_OPS(JIT_METHOD_FUSED)
+#    undef JIT_METHOD_CONTROL
+#    undef JIT_METHOD_STACK
+#    undef JIT_METHOD_FUSED
+};
+
+/**
+ * @brief execute an operation without native implementation on the stack machine
+ * @details
+ *   called by the generated code.
+ *   The operands (stack slots starting at slot) are pushed to the stack machine. After the execution the results are
+ *   moved back to the stack slots.
+ * @return 0 on success, 1 if an exception was thrown (stored in the context) or the operation faulted
+ */
+static int helper_fallback(context_t *ctx, const bytecode::op_t *op, std::size_t slot, std::size_t pops) noexcept {
+    try {
+        auto &machine = *ctx->machine;
+        for (std::size_t i = 0; i < pops; ++i)
+            machine.push(ctx->stack[slot + i]);
+
+        if (op->code == bytecode::opcode_t::EXEC) {
+            op->arg.instr->exec();
+        } else {
+            const auto method = STACK_METHOD[static_cast<std::size_t>(op->code)];
+            if (!method) throw std::logic_error("jit: operation can not be executed by the stack machine");
+            (machine.*method)();
+        }
+
+        // the fault stays in the fault register of the machine
+        if (machine.faulted()) {
+            machine.clr();
+            return 1;
+        }
+
+        for (std::size_t i = machine.size(); i > 0; --i)
+            ctx->stack[slot + i - 1] = machine.pop();
+        return 0;
+    } catch (...) {
+        ctx->error = std::current_exception();
+        return 1;
+    }
+}
+
+/**
+ * @brief minimal x86-64 machine code emitter
+ * @details
+ *   Register usage of the generated code:
+ *     - rbx: stack slots (callee saved)
+ *     - r12: context (callee saved)
+ *     - rax, rcx, xmm0: scratch
+ *
+ *   Stack slots are always addressed as [rbx + disp32].
+ */
+class Assembler {
+private:
+    std::vector<uint8_t> buf;
+
+public:
+    /** @brief condition codes (second byte of Jcc rel32 / SETcc is 0x80 / 0x90 + cc) */
+    enum cc_t : uint8_t {
+        B  = 0x2,
+        AE = 0x3,
+        E  = 0x4,
+        NE = 0x5,
+        BE = 0x6,
+        A  = 0x7,
+        L  = 0xC,
+        GE = 0xD,
+        LE = 0xE,
+        G  = 0xF,
+    };
+
+    [[nodiscard]] std::size_t pos() const { return buf.size(); }
+    [[nodiscard]] const std::vector<uint8_t> &data() const { return buf; }
+
+    void bytes(std::initializer_list<uint8_t> b) { buf.insert(buf.end(), b); }
+
+    void imm32(uint32_t value) {
+        for (int i = 0; i < 4; ++i)
+            buf.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void imm64(uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            buf.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void patch32(std::size_t at, uint32_t value) {
+        for (std::size_t i = 0; i < 4; ++i)
+            buf[at + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    /** @brief ModRM + disp32 for [rbx + 8 * slot] */
+    void slot(uint8_t reg, std::size_t slot) {
+        buf.push_back(static_cast<uint8_t>(0x80 | (reg << 3) | 0x3));
+        imm32(static_cast<uint32_t>(slot * sizeof(StackMachine::stack_t)));
+    }
+
+    // rax <-> stack slot
+    void load_rax(std::size_t s) {
+        bytes({0x48, 0x8B});
+        slot(0, s);
+    }
+    void store_rax(std::size_t s) {
+        bytes({0x48, 0x89});
+        slot(0, s);
+    }
+    void load_rcx(std::size_t s) {
+        bytes({0x48, 0x8B});
+        slot(1, s);
+    }
+
+    /** @brief mov qword [slot], simm32 */
+    void store_imm32(std::size_t s, uint32_t value) {
+        bytes({0x48, 0xC7});
+        slot(0, s);
+        imm32(value);
+    }
+
+    void mov_rax_imm64(uint64_t value) {
+        bytes({0x48, 0xB8});
+        imm64(value);
+    }
+
+    /** @brief <op> rax, [slot] (op: 0x03 add, 0x2B sub, 0x23 and, 0x0B or, 0x33 xor, 0x3B cmp) */
+    void alu_rax(uint8_t opcode, std::size_t s) {
+        bytes({0x48, opcode});
+        slot(0, s);
+    }
+
+    void imul_rax(std::size_t s) {
+        bytes({0x48, 0x0F, 0xAF});
+        slot(0, s);
+    }
+
+    /** @brief SSE operation with xmm0 and [slot] (prefix 0xF3: single, 0xF2: double, 0x66: ucomisd) */
+    void sse(uint8_t prefix, uint8_t opcode, std::size_t s) {
+        bytes({prefix, 0x0F, opcode});
+        slot(0, s);
+    }
+
+    /** @brief movd eax, xmm0 (zero extends to rax) */
+    void movd_eax_xmm0() { bytes({0x66, 0x0F, 0x7E, 0xC0}); }
+
+    /** @brief rax = condition ? 1 : 0 */
+    void setcc_rax(cc_t cc) { bytes({0x0F, static_cast<uint8_t>(0x90 | cc), 0xC0, 0x0F, 0xB6, 0xC0}); }
+
+    void test_rax() { bytes({0x48, 0x85, 0xC0}); }
+
+    /**
+     * @brief jump with 32 bit displacement
+     * @return position of the displacement (for patch32)
+     */
+    std::size_t jmp() {
+        bytes({0xE9});
+        imm32(0);
+        return pos() - 4;
+    }
+
+    std::size_t jcc(cc_t cc) {
+        bytes({0x0F, static_cast<uint8_t>(0x80 | cc)});
+        imm32(0);
+        return pos() - 4;
+    }
+
+    /**
+     * @brief call helper function f(ctx, arg1, arg2, arg3)
+     * @return position of the displacement of the error jump (for patch32)
+     */
+    std::size_t call(const void *function, uint64_t arg1, uint64_t arg2, uint64_t arg3 = 0) {
+        bytes({0x4C, 0x89, 0xE7});  // mov rdi, r12
+        bytes({0x48, 0xBE});        // mov rsi, imm64
+        imm64(arg1);
+        bytes({0x48, 0xBA});  // mov rdx, imm64
+        imm64(arg2);
+        bytes({0x48, 0xB9});  // mov rcx, imm64
+        imm64(arg3);
+        mov_rax_imm64(reinterpret_cast<uintptr_t>(function));
+        bytes({0xFF, 0xD0});  // call rax
+        bytes({0x85, 0xC0});  // test eax, eax
+        return jcc(NE);
+    }
+
+    void prologue() {
+        bytes({0x53});              // push rbx
+        bytes({0x41, 0x54});        // push r12
+        bytes({0x55});              // push rbp (stack alignment)
+        bytes({0x49, 0x89, 0xFC});  // mov r12, rdi
+        bytes({0x48, 0x8B, 0x1F});  // mov rbx, [rdi]
+    }
+
+    void epilogue(bool error) {
+        if (error) bytes({0xB8, 0x01, 0x00, 0x00, 0x00});  // mov eax, 1
+        else
+            bytes({0x31, 0xC0});  // xor eax, eax
+        bytes({0x5D});            // pop rbp
+        bytes({0x41, 0x5C});      // pop r12
+        bytes({0x5B});            // pop rbx
+        bytes({0xC3});            // ret
+    }
+};
+
+static_assert(offsetof(context_t, stack) == 0);
+
+/**
+ * @brief how the code generator translates an operation
+ */
+enum class emit_t : uint8_t {
+    fallback,          //*< call of helper_fallback (no native implementation)
+    nop,               //*< no code
+    end,               //*< return
+    push_const,        //*< store the constant in the stack slot
+    push_var,          //*< load the variable (direct for local le64 variables)
+    pop_var,           //*< store the variable (direct for local le64 variables)
+    jump,              //*< jmp
+    branch,            //*< jcc; x86: condition code
+    dup,               //*< copy of the top of stack
+    binary_int,        //*< <op> rax, [R]; x86: opcode
+    mul,               //*< imul rax, [R]
+    shift,             //*< shl/shr [L], cl; x86: opcode extension
+    logic,             //*< logic operation on (L != 0) and (R != 0); x86: opcode of <op> al, cl
+    lnot,              //*< X == 0
+    inv,               //*< not [X]
+    compare_int,       //*< cmp + setcc; x86: condition code
+    binary_float,      //*< SSE single precision; x86: opcode
+    binary_double,     //*< SSE double precision; x86: opcode
+    compare_double,    //*< L <cc> R; x86: condition code
+    compare_double_r,  //*< R <cc> L (a < b is evaluated as b > a); x86: condition code
+    ftod,              //*< cvtss2sd
+    dtof,              //*< cvtsd2ss
+    abs,               //*< clear the sign bit
+    sqrt,              //*< sqrtsd
+};
+
+/**
+ * @brief translation of an opcode
+ */
+struct emit_rule_t {
+    emit_t  kind = emit_t::fallback;
+    uint8_t x86  = 0;  //*< opcode, opcode extension or condition code (see emit_t)
+};
+
+/**
+ * @brief translation of each opcode (index: opcode)
+ */
+static constexpr std::array<emit_rule_t, bytecode::OPCODE_COUNT> EMIT_RULES = []() {
+    using bytecode::opcode_t;
+
+    std::array<emit_rule_t, bytecode::OPCODE_COUNT> rules {};
+    auto rule = [&rules](opcode_t code, emit_t kind, uint8_t x86 = 0) {
+        rules[static_cast<std::size_t>(code)] = {kind, x86};
+    };
+
+    rule(opcode_t::NOP, emit_t::nop);
+    rule(opcode_t::POP_NULL, emit_t::nop);
+    rule(opcode_t::END, emit_t::end);
+    rule(opcode_t::PUSH_CONST, emit_t::push_const);
+    rule(opcode_t::PUSH_VAR, emit_t::push_var);
+    rule(opcode_t::POP_VAR, emit_t::pop_var);
+    rule(opcode_t::J, emit_t::jump);
+    rule(opcode_t::JZ, emit_t::branch, Assembler::E);
+    rule(opcode_t::JNZ, emit_t::branch, Assembler::NE);
+    rule(opcode_t::DUP, emit_t::dup);
+    rule(opcode_t::ADD, emit_t::binary_int, 0x03);
+    rule(opcode_t::SUB, emit_t::binary_int, 0x2B);
+    rule(opcode_t::BAND, emit_t::binary_int, 0x23);
+    rule(opcode_t::BOR, emit_t::binary_int, 0x0B);
+    rule(opcode_t::BXOR, emit_t::binary_int, 0x33);
+    rule(opcode_t::MUL, emit_t::mul);
+    rule(opcode_t::MULS, emit_t::mul);
+    rule(opcode_t::SHL, emit_t::shift, 4);
+    rule(opcode_t::SHR, emit_t::shift, 5);
+    rule(opcode_t::AND, emit_t::logic, 0x20);
+    rule(opcode_t::OR, emit_t::logic, 0x08);
+    rule(opcode_t::XOR, emit_t::logic, 0x30);
+    rule(opcode_t::NOT, emit_t::lnot);
+    rule(opcode_t::INV, emit_t::inv);
+    rule(opcode_t::EQ, emit_t::compare_int, Assembler::E);
+    rule(opcode_t::NE, emit_t::compare_int, Assembler::NE);
+    rule(opcode_t::LT, emit_t::compare_int, Assembler::B);
+    rule(opcode_t::GT, emit_t::compare_int, Assembler::A);
+    rule(opcode_t::LE, emit_t::compare_int, Assembler::BE);
+    rule(opcode_t::GE, emit_t::compare_int, Assembler::AE);
+    rule(opcode_t::LTS, emit_t::compare_int, Assembler::L);
+    rule(opcode_t::GTS, emit_t::compare_int, Assembler::G);
+    rule(opcode_t::LES, emit_t::compare_int, Assembler::LE);
+    rule(opcode_t::GES, emit_t::compare_int, Assembler::GE);
+    rule(opcode_t::ADDF, emit_t::binary_float, 0x58);
+    rule(opcode_t::SUBF, emit_t::binary_float, 0x5C);
+    rule(opcode_t::MULF, emit_t::binary_float, 0x59);
+    rule(opcode_t::DIVF, emit_t::binary_float, 0x5E);
+    rule(opcode_t::ADDD, emit_t::binary_double, 0x58);
+    rule(opcode_t::SUBD, emit_t::binary_double, 0x5C);
+    rule(opcode_t::MULD, emit_t::binary_double, 0x59);
+    rule(opcode_t::DIVD, emit_t::binary_double, 0x5E);
+    rule(opcode_t::LTD, emit_t::compare_double_r, Assembler::A);
+    rule(opcode_t::LED, emit_t::compare_double_r, Assembler::AE);
+    rule(opcode_t::GTD, emit_t::compare_double, Assembler::A);
+    rule(opcode_t::GED, emit_t::compare_double, Assembler::AE);
+    rule(opcode_t::FTOD, emit_t::ftod);
+    rule(opcode_t::DTOF, emit_t::dtof);
+    rule(opcode_t::ABS, emit_t::abs);
+    rule(opcode_t::SQRT, emit_t::sqrt);
+    return rules;
+}();
+
+/**
+ * @brief get the stack depth before each operation
+ * @details
+ *   The depth has to be independent of the execution path. Unreachable operations get the depth SIZE_MAX.
+ * @exception std::runtime_error stack depth depends on the execution path
+ */
+static std::vector<std::size_t> stack_depths(const bytecode::verify_result_t &verified) {
+    static_assert(bytecode::depth_t::UNREACHABLE == SIZE_MAX);
+
+    std::vector<std::size_t> depth;
+    depth.reserve(verified.depth.size());
+    for (std::size_t i = 0; i < verified.depth.size(); ++i) {
+        const auto &d = verified.depth[i];
+        if (d.reachable() && d.min != d.max) {
+            std::ostringstream sstr;
+            sstr << "stack depth at instruction " << i << " depends on the execution path";
+            throw std::runtime_error(sstr.str());
+        }
+        depth.push_back(d.min);
+    }
+
+    return depth;
+}
+
+jit::Program::Program(const bytecode::Program &program, const bytecode::verify_result_t &verified) {
+    const auto &ops = program.get_ops();
+    if (ops.empty() || ops.back().code != bytecode::opcode_t::END)
+        throw std::logic_error("bytecode program is not terminated");
+    if (verified.depth.size() != ops.size()) throw std::logic_error("bytecode program is not verified");
+
+    const auto depth = stack_depths(verified);
+    spill.resize(std::max<std::size_t>(verified.max_depth, 1));
+
+    Assembler                                     a;
+    std::vector<std::size_t>                      op_pos(ops.size());
+    std::vector<std::pair<std::size_t, std::size_t>> jumps;   // (displacement position, target operation)
+    std::vector<std::size_t>                      faults;  // displacement positions of error jumps
+
+    const auto L = [](std::size_t d) { return d - 2; };  // left operand of a binary operation
+    const auto R = [](std::size_t d) { return d - 1; };  // right operand of a binary operation / unary operand
+
+    a.prologue();
+
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        op_pos[i]       = a.pos();
+        const auto &op = ops[i];
+        const auto  d  = depth[i];
+        if (d == SIZE_MAX) continue;  // unreachable
+
+        auto binary_int = [&](uint8_t opcode) {
+            a.load_rax(L(d));
+            a.alu_rax(opcode, R(d));
+            a.store_rax(L(d));
+        };
+
+        auto compare_int = [&](Assembler::cc_t cc) {
+            a.load_rax(L(d));
+            a.alu_rax(0x3B, R(d));
+            a.setcc_rax(cc);
+            a.store_rax(L(d));
+        };
+
+        auto binary_float = [&](uint8_t opcode) {
+            a.sse(0xF3, 0x10, L(d));  // movss xmm0, [L]
+            a.sse(0xF3, opcode, R(d));
+            a.movd_eax_xmm0();
+            a.store_rax(L(d));
+        };
+
+        auto binary_double = [&](uint8_t opcode) {
+            a.sse(0xF2, 0x10, L(d));  // movsd xmm0, [L]
+            a.sse(0xF2, opcode, R(d));
+            a.sse(0xF2, 0x11, L(d));  // movsd [L], xmm0
+        };
+
+        // a < b is evaluated as b > a (seta/setae are false for unordered operands)
+        auto compare_double = [&](std::size_t first, std::size_t second, Assembler::cc_t cc) {
+            a.sse(0xF2, 0x10, first);   // movsd xmm0, [first]
+            a.sse(0x66, 0x2E, second);  // ucomisd xmm0, [second]
+            a.setcc_rax(cc);
+            a.store_rax(L(d));
+        };
+
+        // logic operation on (L != 0) and (R != 0); opcode: 0x20 and, 0x08 or, 0x30 xor (r/m8, r8)
+        auto logic = [&](uint8_t opcode) {
+            a.load_rax(L(d));
+            a.test_rax();
+            a.bytes({0x0F, 0x95, 0xC1});  // setne cl
+            a.load_rax(R(d));
+            a.test_rax();
+            a.bytes({0x0F, 0x95, 0xC0});  // setne al
+            a.bytes({opcode, 0xC8});      // <op> al, cl
+            a.bytes({0x0F, 0xB6, 0xC0});  // movzx eax, al
+            a.store_rax(L(d));
+        };
+
+        const auto &rule = EMIT_RULES[static_cast<std::size_t>(op.code)];
+        const auto  cc   = static_cast<Assembler::cc_t>(rule.x86);
+
+        bool native = true;
+        switch (rule.kind) {
+            case emit_t::nop: break;
+            case emit_t::end: a.epilogue(false); break;
+            case emit_t::push_const: {
+                const auto value = op.arg.value;
+                if (static_cast<StackMachine::stack_t>(static_cast<int64_t>(static_cast<int32_t>(value))) == value) {
+                    a.store_imm32(d, static_cast<uint32_t>(value));
+                } else {
+                    a.mov_rax_imm64(value);
+                    a.store_rax(d);
+                }
+                break;
+            }
+            case emit_t::push_var: {
+                auto &var   = *op.arg.var;
+                auto *local = dynamic_cast<MemoryLocal *>(&var.mem);
+                if (local && var.data_type == Memory::dtype_t::le64) {
+                    a.mov_rax_imm64(reinterpret_cast<uintptr_t>(local->get_cell(var.cell)));
+                    a.bytes({0x48, 0x8B, 0x00});  // mov rax, [rax]
+                    a.store_rax(d);
+                } else {
+                    faults.push_back(a.call(reinterpret_cast<const void *>(&helper_load),
+                                            reinterpret_cast<uintptr_t>(&var),
+                                            d));
+                }
+                break;
+            }
+            case emit_t::pop_var: {
+                auto &var   = *op.arg.var;
+                auto *local = dynamic_cast<MemoryLocal *>(&var.mem);
+                if (local && var.data_type == Memory::dtype_t::le64) {
+                    a.load_rcx(R(d));
+                    a.mov_rax_imm64(reinterpret_cast<uintptr_t>(local->get_cell(var.cell)));
+                    a.bytes({0x48, 0x89, 0x08});  // mov [rax], rcx
+                } else {
+                    faults.push_back(a.call(reinterpret_cast<const void *>(&helper_store),
+                                            reinterpret_cast<uintptr_t>(&var),
+                                            R(d)));
+                }
+                break;
+            }
+            case emit_t::jump: jumps.emplace_back(a.jmp(), op.arg.target); break;
+            case emit_t::branch:
+                a.load_rax(R(d));
+                a.test_rax();
+                jumps.emplace_back(a.jcc(cc), op.arg.target);
+                break;
+            case emit_t::dup:
+                a.load_rax(R(d));
+                a.store_rax(d);
+                break;
+            case emit_t::binary_int: binary_int(rule.x86); break;
+            case emit_t::mul:
+                // the lower 64 bit of the product do not depend on the signedness
+                a.load_rax(L(d));
+                a.imul_rax(R(d));
+                a.store_rax(L(d));
+                break;
+            case emit_t::shift:
+                // the shift count is masked to 6 bit by the cpu
+                a.load_rcx(R(d));
+                a.bytes({0x48, 0xD3});  // shl/shr qword [slot], cl
+                a.slot(rule.x86, L(d));
+                break;
+            case emit_t::logic: logic(rule.x86); break;
+            case emit_t::lnot:
+                a.load_rax(R(d));
+                a.test_rax();
+                a.setcc_rax(Assembler::E);
+                a.store_rax(R(d));
+                break;
+            case emit_t::inv:
+                a.bytes({0x48, 0xF7});  // not qword [slot]
+                a.slot(2, R(d));
+                break;
+            case emit_t::compare_int: compare_int(cc); break;
+            case emit_t::binary_float: binary_float(rule.x86); break;
+            case emit_t::binary_double: binary_double(rule.x86); break;
+            case emit_t::compare_double: compare_double(L(d), R(d), cc); break;
+            case emit_t::compare_double_r: compare_double(R(d), L(d), cc); break;
+            case emit_t::ftod:
+                a.sse(0xF3, 0x5A, R(d));  // cvtss2sd xmm0, [slot]
+                a.sse(0xF2, 0x11, R(d));  // movsd [slot], xmm0
+                break;
+            case emit_t::dtof:
+                a.sse(0xF2, 0x5A, R(d));  // cvtsd2ss xmm0, [slot]
+                a.movd_eax_xmm0();
+                a.store_rax(R(d));
+                break;
+            case emit_t::abs:
+                a.bytes({0x48, 0x0F, 0xBA});  // btr qword [slot], 63
+                a.slot(6, R(d));
+                a.bytes({63});
+                break;
+            case emit_t::sqrt:
+                a.sse(0xF2, 0x51, R(d));  // sqrtsd xmm0, [slot]
+                a.sse(0xF2, 0x11, R(d));  // movsd [slot], xmm0
+                break;
+            case emit_t::fallback: {
+                std::size_t pops;
+                std::size_t pushes;
+                static_cast<void>(bytecode::stack_effect(op, pops, pushes));
+                faults.push_back(a.call(reinterpret_cast<const void *>(&helper_fallback),
+                                        reinterpret_cast<uintptr_t>(&op),
+                                        d - pops,
+                                        pops));
+                native = false;
+                break;
+            }
+            default: throw std::logic_error("jit: invalid emit rule");
+        }
+
+        if (native) ++native_ops;
+        else
+            ++fallback_ops;
+    }
+
+    const auto fault_pos = a.pos();
+    a.epilogue(true);
+
+    for (auto &jump : jumps)
+        a.patch32(jump.first, static_cast<uint32_t>(op_pos[jump.second] - (jump.first + 4)));
+    for (auto &fault : faults)
+        a.patch32(fault, static_cast<uint32_t>(fault_pos - (fault + 4)));
+
+    // W^X: write the code to a writable mapping and make it executable afterwards
+    const auto &data = a.data();
+    void       *mem  = mmap(nullptr, data.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        std::ostringstream sstr;
+        sstr << "failed to allocate memory for native code: " << strerror(errno);
+        throw std::runtime_error(sstr.str());
+    }
+    std::memcpy(mem, data.data(), data.size());
+
+    if (mprotect(mem, data.size(), PROT_READ | PROT_EXEC)) {
+        const int err = errno;
+        munmap(mem, data.size());
+        std::ostringstream sstr;
+        sstr << "failed to make native code executable: " << strerror(err);
+        throw std::runtime_error(sstr.str());
+    }
+
+    code      = mem;
+    code_size = data.size();
+}
+
+jit::Program::~Program() {
+    if (code) munmap(code, code_size);
+}
+
+void jit::Program::run(StackMachine &machine) {
+    context_t  ctx {spill.data(), &machine, nullptr};
+    const auto entry = reinterpret_cast<entry_t>(code);
+    if (entry(&ctx) && ctx.error) std::rethrow_exception(ctx.error);
+}
+
+#else
+
+jit::Program::Program(const bytecode::Program &, const bytecode::verify_result_t &) {
+    throw std::runtime_error("native code generation is not supported on this platform");
+}
+
+jit::Program::~Program() = default;
+
+void jit::Program::run(StackMachine &) { throw std::logic_error("native code generation is not supported"); }
+
+#endif
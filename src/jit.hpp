@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "bytecode.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace jit {
+
+/**
+ * @brief check if the native code generator supports the current platform
+ * @return true if supported (x86-64, POSIX)
+ */
+[[nodiscard]] bool available();
+
+/**
+ * @brief native x86-64 translation of a bytecode program
+ * @details
+ *   The operand stack is kept in a fixed spill area. The stack depth of each operation is known from the verification
+ *   of the bytecode program, so each stack slot is addressed directly and no stack pointer is maintained at runtime.
+ *   Operations without native implementation (EXEC, POW, trigonometric functions, ...) are executed by the stack
+ *   machine: the stack content is moved to the stack machine, the operation is executed and the result is moved back.
+ *
+ *   The generated code is placed in an mmap'd buffer that is made executable (and read only) after code generation.
+ */
+class Program {
+private:
+    void                              *code      = nullptr;  //*< executable code
+    std::size_t                        code_size = 0;        //*< size of the code buffer
+    std::vector<StackMachine::stack_t> spill;                //*< stack slots
+    std::size_t                        native_ops   = 0;     //*< number of operations with native implementation
+    std::size_t                        fallback_ops = 0;     //*< number of operations executed by the stack machine
+
+public:
+    /**
+     * @brief translate a bytecode program to native code
+     * @param program bytecode program (has to outlive the jit program)
+     * @param verified stack depths of the program (see bytecode::Program::verify)
+     * @exception std::runtime_error the program can not be translated
+     */
+    Program(const bytecode::Program &program, const bytecode::verify_result_t &verified);
+
+    ~Program();
+
+    Program(const Program &)            = delete;
+    Program &operator=(const Program &) = delete;
+
+    /**
+     * @brief execute the program until END is reached or an operation faults (see StackMachine::get_fault)
+     * @param machine stack machine that executes the operations without native implementation
+     */
+    void run(StackMachine &machine);
+
+    /**
+     * @brief get number of operations with native implementation
+     * @return number of operations
+     */
+    [[nodiscard]] std::size_t get_native_ops() const { return native_ops; }
+
+    /**
+     * @brief get number of operations that are executed by the stack machine
+     * @return number of operations
+     */
+    [[nodiscard]] std::size_t get_fallback_ops() const { return fallback_ops; }
+
+    /**
+     * @brief get size of the generated code
+     * @return code size in bytes
+     */
+    [[nodiscard]] std::size_t get_code_size() const { return code_size; }
+};
+
+}  // namespace jit
@@ -5,43 +5,293 @@
 
 #include "Machine.hpp"
 
-#include "cxxitimer.hpp"
 #include "cxxopts.hpp"
 #include "cxxsignal.hpp"
+#include "cycle_log.hpp"
+#include "host.hpp"
 #include "license.hpp"
+#include "rt.hpp"
+#include "scheduler.hpp"
+#include "special_instructions.hpp"
+#include "split_string.hpp"
+#include "tasks.hpp"
 #include "time_str.hpp"
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <sysexits.h>
 #include <thread>
 
-static volatile bool terminate = false;
+static volatile bool terminate   = false;
+static volatile bool print_stats = false;
 
 class TerminateHandler final : public cxxsignal::SignalHandler {
 public:
     explicit TerminateHandler(int signal_number) : cxxsignal::SignalHandler(signal_number) {}
 
-    void handler(int signal_number, siginfo_t *, ucontext_t *) override { terminate = true; }
+    void handler(int, siginfo_t *, ucontext_t *) override { terminate = true; }
 };
 
-class CycleTimeWarning final : public cxxsignal::SignalHandler {
-private:
-    bool waiting;
-
+class StatisticsRequest final : public cxxsignal::SignalHandler {
 public:
-    explicit CycleTimeWarning(int signal_number) : cxxsignal::SignalHandler(signal_number), waiting(false) {}
+    explicit StatisticsRequest(int signal_number) : cxxsignal::SignalHandler(signal_number) {}
+
+    void handler(int, siginfo_t *, ucontext_t *) override { print_stats = true; }
+};
 
-    void handler(int signal_number, siginfo_t *, ucontext_t *context) override {
-        if (!waiting) std::cerr << now_str() << " WARNING: cycle time exceeded" << std::endl;
+/**
+ * @brief apply the real-time options of the command line to a profile
+ * @exception std::runtime_error invalid option
+ */
+static void cli_profile(cxxopts::ParseResult &opts, rt::profile_t &profile) {
+    if (opts.count("sched")) {
+        const auto sched = split_string(opts["sched"].as<std::string>(), ':');
+        if (sched.empty() || sched.size() > 2) throw std::runtime_error("invalid scheduling policy");
+        rt::set_policy(profile, sched[0], sched.size() == 2 ? sched[1] : std::string());
     }
+    if (opts.count("cpu")) profile.cpus = rt::parse_cpus(opts["cpu"].as<std::string>());
+    if (opts.count("mlockall")) profile.lock_memory = true;
+}
 
-    bool _wait() {
-        waiting  = true;
-        auto ret = wait();
-        waiting  = false;
-        return ret;
+/**
+ * @brief execute multiple programs in one process (host mode)
+ * @param opts command line options
+ * @param files program files
+ * @param stack_size machine stack size
+ * @param engine execution engine
+ * @return exit code
+ */
+static int run_host(cxxopts::ParseResult          &opts,
+                    const std::vector<std::string> &files,
+                    std::size_t                     stack_size,
+                    Machine::engine_t               engine) {
+    const bool verbose = opts.count("verbose");
+
+    std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    if (opts.count("threads")) threads = opts["threads"].as<std::size_t>();
+
+    std::chrono::seconds report_interval {};
+    if (opts.count("report")) report_interval = std::chrono::seconds(opts["report"].as<std::size_t>());
+
+    // the pool is destroyed (threads joined) before the reporter, the machines and the shared memories
+    cycle_log::Reporter                   reporter(report_interval);
+    SharedMemoryCache                     shm_cache;
+    std::vector<std::unique_ptr<Machine>> machines;
+    std::unique_ptr<host::Pool>           pool;
+    try {
+        pool = std::make_unique<host::Pool>(threads);
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+        return EX_USAGE;
     }
-};
+
+    for (const auto &file : files) {
+        try {
+            auto machine = std::make_unique<Machine>(stack_size, verbose, opts.count("debug"), engine);
+            machine->set_shm_cache(&shm_cache);
+            machine->load_file(file);
+            if (machine->has_trigger()) throw std::runtime_error("setting TRIGGER is not supported in host mode");
+            if (!machine->get_tasks().empty())
+                throw std::runtime_error("sections __PROGRAM <task> <period> are not supported in host mode");
+            if (!machine->get_rt_profile().empty())
+                std::cerr << now_str() << " WARNING: " << file
+                          << ": real-time settings are ignored in host mode (use the command line options)"
+                          << std::endl;
+            machine->init();
+
+            pool->add(std::filesystem::path(file).stem().string(), *machine);
+            machines.emplace_back(std::move(machine));
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: " << file << ": " << e.what() << std::endl;
+            return EX_DATAERR;
+        }
+    }
+
+    // the reporter thread is created before the real-time profile is applied: it must not compete with the cycles
+    try {
+        reporter.start();
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: failed to start reporter: " << e.what() << std::endl;
+        return EX_OSERR;
+    }
+    pool->set_reporter(reporter);
+
+    // the worker threads inherit the profile
+    rt::profile_t rt_profile;
+    try {
+        cli_profile(opts, rt_profile);
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+        return EX_USAGE;
+    }
+
+    if (!rt_profile.empty()) {
+        try {
+            rt::apply(rt_profile);
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: failed to apply real-time profile: " << e.what() << std::endl;
+            return EX_OSERR;
+        }
+        if (verbose) std::cerr << now_str() << " real-time profile: " << rt_profile << std::endl;
+    }
+
+    if (verbose)
+        std::cerr << now_str() << " host: " << machines.size() << " programs, " << shm_cache.size()
+                  << " shared memories, " << threads << " worker threads" << std::endl;
+
+    auto report = [&]() {
+        for (const auto &stats : pool->get_stats())
+            std::cerr << now_str() << " cycle statistics " << stats << std::endl;
+        reporter.request_summary();
+    };
+
+    pool->start();
+    while (pool->running() && !terminate) {
+        const timespec poll {0, 10000000};
+        nanosleep(&poll, nullptr);
+
+        if (print_stats) {
+            print_stats = false;
+            report();
+        }
+    }
+    pool->stop();
+
+    if (opts.count("stats")) {
+        for (const auto &stats : pool->get_stats())
+            std::cerr << now_str() << " cycle statistics " << stats << std::endl;
+    }
+
+    // exit summary (also if terminated by a signal)
+    reporter.stop();
+    if (terminate || opts.count("stats")) reporter.print_summary(std::cerr);
+
+    return pool->get_failed() ? EX_DATAERR : EX_OK;
+}
+
+/**
+ * @brief execute a program with multiple tasks (sections __PROGRAM <task> <period>)
+ * @param opts command line options
+ * @param machine initialized machine
+ * @param reporter started reporter (overruns and cycle summaries of the tasks)
+ * @return exit code
+ */
+static int run_tasks(cxxopts::ParseResult &opts, Machine &machine, cycle_log::Reporter &reporter) {
+    tasks::Executive executive(machine);
+    executive.set_reporter(reporter);
+
+    auto print_task_stats = [&]() {
+        for (const auto &stats : executive.get_stats())
+            std::cerr << now_str() << " task statistics " << stats << std::endl;
+    };
+
+    auto report = [&]() {
+        print_task_stats();
+        reporter.request_summary();
+    };
+
+    if (opts.count("verbose")) {
+        std::cerr << now_str() << " tasks (highest priority first):";
+        for (const auto &stats : executive.get_stats())
+            std::cerr << ' ' << stats.name;
+        std::cerr << std::endl;
+    }
+
+    executive.start();
+    while (executive.running() && !terminate) {
+        try {
+            executive.dispatch();
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: execution failed: " << e.what() << std::endl;
+            return EX_DATAERR;
+        }
+
+        if (print_stats) {
+            print_stats = false;
+            report();
+        }
+
+        try {
+            while (executive.running() && !executive.sleep() && !terminate) {
+                if (print_stats) {
+                    print_stats = false;
+                    report();
+                }
+            }
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+            return EX_OSERR;
+        }
+    }
+    executive.stop();
+
+    if (opts.count("stats")) print_task_stats();
+
+    // exit summary (also if terminated by a signal)
+    reporter.stop();
+    if (terminate || opts.count("stats")) reporter.print_summary(std::cerr);
+
+    return EX_OK;
+}
+
+/**
+ * @brief execute the cycles back-to-back with a virtual clock (simulation mode)
+ * @details the virtual clock (STIME, MTIME, CTIME, TTIME) advances by the cycle time per cycle
+ * @param opts command line options
+ * @param machine initialized machine
+ * @param cycles number of cycles
+ * @return exit code
+ */
+static int run_simulation(cxxopts::ParseResult &opts, Machine &machine, std::size_t cycles) {
+    if (!machine.get_tasks().empty()) {
+        std::cerr << now_str() << " ERROR: sections __PROGRAM <task> <period> are not supported in simulation mode"
+                  << std::endl;
+        return EX_USAGE;
+    }
+    if (machine.has_trigger())
+        std::cerr << now_str() << " WARNING: setting TRIGGER is ignored in simulation mode" << std::endl;
+
+    uint64_t seed = 0;
+    if (opts.count("seed")) seed = opts["seed"].as<uint64_t>();
+    instr_special::simulate(seed);
+
+    // skipped cycles (FAULT SKIP) are reported rate limited, the cycles are executed without a delay
+    cycle_log::Reporter reporter(std::chrono::seconds(0));
+    machine.set_fault_log(&reporter.add(std::string(), machine.get_cycle_time()));
+    try {
+        reporter.start();
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: failed to start reporter: " << e.what() << std::endl;
+        return EX_OSERR;
+    }
+
+    const auto  cycle_time = machine.get_cycle_time();
+    const auto  start      = std::chrono::steady_clock::now();
+    std::size_t executed   = 0;
+    for (; executed < cycles && !terminate; ++executed) {
+        try {
+            machine.run();
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: execution failed in cycle " << executed << ": " << e.what()
+                      << std::endl;
+            return EX_DATAERR;
+        }
+        instr_special::advance_clock(cycle_time);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    reporter.stop();
+
+    const std::chrono::duration<double> simulated = cycle_time * executed;
+
+    std::ostringstream sstr;
+    sstr << std::fixed << std::setprecision(3) << executed << " cycles (" << simulated.count() << " s simulated) in "
+         << elapsed.count() << " s: " << std::setprecision(0) << static_cast<double>(executed) / elapsed.count()
+         << " cycles/s";
+    std::cerr << now_str() << " simulation: " << sstr.str() << std::endl;
+
+    return EX_OK;
+}
 
 int main(int argc, char **argv) {
     const std::string exe_name = std::filesystem::path(argv[0]).filename().string();
@@ -56,13 +306,57 @@ int main(int argc, char **argv) {
     options.add_options()("h,help", "Show usage information");
     options.add_options()("d,debug", "Print what the stack machine executes");
     options.add_options()("v,verbose", "Print program status information");
+    options.add_options()("reference",
+                          "Execute the program with the reference interpreter (one instruction object per "
+                          "instruction) instead of the bytecode engine");
+    options.add_options()("jit",
+                          "Translate the program to native code (x86-64 only). Falls back to the bytecode engine if "
+                          "the program can not be translated");
+    options.add_options()("aot",
+                          "Execute a shared object that was compiled from the program by shm-stack-machine-aot",
+                          cxxopts::value<std::string>());
+    options.add_options()("listing", "Print the optimized bytecode program and exit");
+    options.add_options()("stats",
+                          "Print the cycle statistics (overruns, wake latency) on exit. The statistics are also "
+                          "printed if SIGUSR1 is received");
+    options.add_options()("report",
+                          "Print a summary of the cycles (overruns, worst cycle, execution time histogram) every "
+                          "SECONDS seconds (one line per task or program)",
+                          cxxopts::value<std::size_t>());
+    options.add_options()("wait",
+                          "How the next cycle is awaited: SLEEP, SPIN (busy wait) or HYBRID[:US] (sleep, busy wait "
+                          "the last US microseconds, default 50). Overrides the setting WAIT",
+                          cxxopts::value<std::string>());
+    options.add_options()("simulate",
+                          "Execute N cycles as fast as possible with a virtual clock (STIME, MTIME, CTIME and TTIME "
+                          "advance by the cycle time per cycle) and print the throughput",
+                          cxxopts::value<std::size_t>());
+    options.add_options()("seed",
+                          "Seed of the random number generator (RAND, RANDF, RANDD) in simulation mode (default: 0)",
+                          cxxopts::value<uint64_t>());
+    options.add_options()("sched",
+                          "Scheduling policy and priority of the cycles: OTHER, FIFO or RR (e.g. FIFO:80). Overrides "
+                          "the setting SCHED",
+                          cxxopts::value<std::string>());
+    options.add_options()("cpu", "CPUs the cycles are executed on (e.g. 2 or 2,4-7). Overrides the setting CPU",
+                          cxxopts::value<std::string>());
+    options.add_options()("mlockall", "Lock all current and future memory pages in RAM (setting MLOCKALL)");
+    options.add_options()("manifest",
+                          "Execute the programs that are listed in a file (one path per line) in one process (host "
+                          "mode)",
+                          cxxopts::value<std::string>());
+    options.add_options()("threads",
+                          "Number of worker threads in host mode (default: number of CPUs)",
+                          cxxopts::value<std::size_t>());
     options.add_options()("version", "print version information");
     options.add_options()("license", "show licences");
 
-    options.add_options()("file", "The file to execute", cxxopts::value<std::string>());
+    options.add_options()("file",
+                          "The file to execute. Multiple files are executed in one process (host mode)",
+                          cxxopts::value<std::vector<std::string>>());
 
     options.parse_positional({"file"});
-    options.positional_help("PROGRAM_FILE");
+    options.positional_help("PROGRAM_FILE...");
 
     auto opts = options.parse(argc, argv);
 
@@ -76,7 +370,6 @@ int main(int argc, char **argv) {
         std::cout << "  - cxxshm (https://github.com/NikolasK-source/cxxshm)" << std::endl;
         std::cout << "  - cxxendian (https://github.com/NikolasK-source/cxxendian)" << std::endl;
         std::cout << "  - cxxsignal (https://github.com/NikolasK-source/cxxsignal)" << std::endl;
-        std::cout << "  - cxxitimer (https://github.com/NikolasK-source/cxxitimer)" << std::endl;
         return EX_OK;
     }
 
@@ -93,19 +386,39 @@ int main(int argc, char **argv) {
         return EX_OK;
     }
 
-    if (!opts.count("file")) {
+    std::vector<std::string> files;
+    if (opts.count("file")) files = opts["file"].as<std::vector<std::string>>();
+    if (opts.count("manifest")) {
+        try {
+            const auto manifest = host::read_manifest(opts["manifest"].as<std::string>());
+            files.insert(files.end(), manifest.begin(), manifest.end());
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+            return EX_NOINPUT;
+        }
+    }
+
+    if (files.empty()) {
         std::cerr << "File is mandatory!" << std::endl;
         return EX_USAGE;
     }
 
-    TerminateHandler sigint_handler(SIGINT);
-    TerminateHandler sigterm_handler(SIGTERM);
-    TerminateHandler sigquit_handler(SIGQUIT);
+    const bool host_mode = files.size() > 1 || opts.count("manifest");
+    if (host_mode && (opts.count("aot") || opts.count("listing") || opts.count("simulate"))) {
+        std::cerr << "The options --aot, --listing and --simulate can not be used with multiple programs" << std::endl;
+        return exit_usage();
+    }
+
+    TerminateHandler  sigint_handler(SIGINT);
+    TerminateHandler  sigterm_handler(SIGTERM);
+    TerminateHandler  sigquit_handler(SIGQUIT);
+    StatisticsRequest sigusr1_handler(SIGUSR1);
 
     try {
         sigint_handler.establish();
         sigterm_handler.establish();
         sigquit_handler.establish();
+        sigusr1_handler.establish();
     } catch (const std::exception &e) {
         std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
         return EX_OSERR;
@@ -114,21 +427,41 @@ int main(int argc, char **argv) {
     std::size_t stack_size = 32;
     if (opts.count("stack-size")) { stack_size = opts["stack-size"].as<std::size_t>(); }
 
+    auto engine = Machine::engine_t::bytecode;
+    if (opts.count("reference") + opts.count("jit") + opts.count("aot") > 1) {
+        std::cerr << "The options --reference, --jit and --aot can not be combined" << std::endl;
+        return exit_usage();
+    } else if (opts.count("reference")) {
+        engine = Machine::engine_t::reference;
+    } else if (opts.count("jit")) {
+        engine = Machine::engine_t::jit;
+    } else if (opts.count("aot")) {
+        engine = Machine::engine_t::aot;
+    }
+
+    if (host_mode) return run_host(opts, files, stack_size, engine);
+
     std::unique_ptr<Machine> machine;
     try {
-        machine = std::make_unique<Machine>(stack_size, opts.count("verbose"), opts.count("debug"));
+        machine = std::make_unique<Machine>(stack_size, opts.count("verbose"), opts.count("debug"), engine);
+        if (opts.count("aot")) machine->set_aot_library(opts["aot"].as<std::string>());
     } catch (const std::exception &e) {
         std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
         return EX_USAGE;
     }
 
     try {
-        machine->load_file(opts["file"].as<std::string>());
+        machine->load_file(files.front());
     } catch (const std::exception &e) {
         std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
         return EX_DATAERR;
     }
 
+    if (opts.count("listing")) {
+        machine->print_listing(std::cout);
+        return EX_OK;
+    }
+
     try {
         machine->init();
     } catch (const std::exception &e) {
@@ -136,21 +469,102 @@ int main(int argc, char **argv) {
         return EX_DATAERR;
     }
 
-    const auto cycle_ms = machine->get_cycle_time_ms();
+    // no real-time profile, no scheduler
+    if (opts.count("simulate")) {
+        const auto cycles = opts["simulate"].as<std::size_t>();
+        if (cycles == 0) {
+            std::cerr << "The number of simulated cycles must be greater than 0" << std::endl;
+            return exit_usage();
+        }
+        return run_simulation(opts, *machine, cycles);
+    }
 
-    CycleTimeWarning       timer_handler(SIGALRM);
-    cxxitimer::ITimer_Real timer(static_cast<double>(cycle_ms) / 1000.0);
+    // event driven: the cycle time is the max interval between two cycles (no scheduler)
+    const bool triggered = machine->has_trigger();
 
+    // the reporter thread is created before the real-time profile is applied: it must not compete with the cycles
+    // event driven: only the skipped cycles (FAULT SKIP) are reported, there are no overruns
+    std::unique_ptr<cycle_log::Reporter> reporter;
+    cycle_log::Reporter::Source         *cycle_source = nullptr;
+    std::chrono::seconds                 report_interval {};
+    if (opts.count("report") && !triggered) report_interval = std::chrono::seconds(opts["report"].as<std::size_t>());
     try {
-        timer_handler.establish();
-        timer.start();
+        reporter = std::make_unique<cycle_log::Reporter>(report_interval);
+        if (machine->get_tasks().empty()) {
+            cycle_source = &reporter->add(std::string(), machine->get_cycle_time());
+            machine->set_fault_log(cycle_source);
+        }
+        reporter->start();
     } catch (const std::exception &e) {
-        std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+        std::cerr << now_str() << " ERROR: failed to start reporter: " << e.what() << std::endl;
         return EX_OSERR;
     }
 
+    // real-time profile: after load_file and init, so the parser does not allocate or fault pages in the cycles
+    rt::profile_t rt_profile = machine->get_rt_profile();
+    try {
+        cli_profile(opts, rt_profile);
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+        return exit_usage();
+    }
+
+    if (!rt_profile.empty()) {
+        try {
+            rt::apply(rt_profile);
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: failed to apply real-time profile: " << e.what() << std::endl;
+            return EX_OSERR;
+        }
+        if (opts.count("verbose")) std::cerr << now_str() << " real-time profile: " << rt_profile << std::endl;
+    }
+
+    scheduler::wait_policy_t wait_policy = machine->get_wait_policy();
+    if (opts.count("wait")) {
+        try {
+            const auto wait = split_string(opts["wait"].as<std::string>(), ':');
+            if (wait.empty() || wait.size() > 2) throw std::runtime_error("invalid wait mode");
+            wait_policy = scheduler::parse_wait(wait[0], wait.size() == 2 ? wait[1] : std::string());
+        } catch (const std::exception &e) {
+            std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+            return exit_usage();
+        }
+    }
+
+    // a busy wait occupies the CPU, other threads of the process or other processes are delayed on the same CPU
+    if (wait_policy.mode != scheduler::wait_t::sleep && rt_profile.cpus.empty() && !machine->has_trigger())
+        std::cerr << now_str() << " WARNING: busy wait without CPU affinity (setting CPU or option --cpu)" << std::endl;
+    if (opts.count("verbose")) std::cerr << now_str() << " wait mode: " << wait_policy << std::endl;
+
+    if (!machine->get_tasks().empty()) {
+        if (wait_policy.mode != scheduler::wait_t::sleep)
+            std::cerr << now_str() << " WARNING: wait mode " << wait_policy << " is not supported with tasks"
+                      << std::endl;
+        return run_tasks(opts, *machine, *reporter);
+    }
+
+    std::unique_ptr<scheduler::Scheduler> cycle_scheduler;
+    try {
+        cycle_scheduler = std::make_unique<scheduler::Scheduler>(machine->get_cycle_time(),
+                                                                 machine->get_overrun_policy());
+        cycle_scheduler->set_wait(wait_policy);
+    } catch (const std::exception &e) {
+        std::cerr << now_str() << " ERROR: " << e.what() << std::endl;
+        return EX_DATAERR;
+    }
+
+    auto report = [&]() {
+        if (triggered) return;
+        std::cerr << now_str() << " cycle statistics: " << cycle_scheduler->get_stats() << std::endl;
+        reporter->request_summary();
+    };
+
+    if (!triggered) cycle_scheduler->start();
+
     bool inf = machine->get_cycles() == 0;
     for (std::size_t i = machine->get_cycles(); (i || inf) && !terminate; --i) {
+        cycle_log::record_t record {};
+        record.start = cycle_log::now_ns();
         try {
             machine->run();
         } catch (const std::exception &e) {
@@ -158,8 +572,30 @@ int main(int argc, char **argv) {
             return EX_DATAERR;
         }
 
+        if (print_stats) {
+            print_stats = false;
+            report();
+        }
+
         try {
-            timer_handler._wait();
+            if (!triggered) {
+                // no output in the cycle thread: overrun warnings are printed (rate limited) by the reporter
+                record.end    = cycle_log::now_ns();
+                record.missed = cycle_scheduler->next_cycle();
+                cycle_source->record(record);
+
+                // the last cycle does not wait
+                if (inf || i > 1) {
+                    while (!cycle_scheduler->sleep() && !terminate) {
+                        if (print_stats) {
+                            print_stats = false;
+                            report();
+                        }
+                    }
+                }
+            } else if (inf || i > 1) {
+                machine->wait_trigger();
+            }
         } catch (const std::exception &e) {
             if (terminate) break;
             std::cerr << now_str() << "ERROR: " << e.what() << std::endl;
@@ -167,5 +603,12 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (opts.count("stats") && !triggered)
+        std::cerr << now_str() << " cycle statistics: " << cycle_scheduler->get_stats() << std::endl;
+
+    // exit summary (also if terminated by a signal)
+    reporter->stop();
+    if ((terminate || opts.count("stats")) && !triggered) reporter->print_summary(std::cerr);
+
     return 0;
 }
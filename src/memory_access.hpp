@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "Memory.hpp"
+#include "StackMachine.hpp"
+
+#include "cxxendian/endian.hpp"
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief unchecked load/store of the memory data types
+ * @details
+ *   The functions operate on the address of the base cell of a variable. Bounds, cell size and bit index have to be
+ *   checked before (see MemoryReal::get_var_addr).
+ *
+ *   The data type and the memory cell size are template parameters, so each variable access compiles to a fixed
+ *   sequence of memcpy / byte swap / shift operations.
+ */
+namespace mem_access {
+
+typedef StackMachine::stack_t stack_t;
+
+typedef stack_t (*load_t)(const void *addr, std::size_t index);         //*< load function
+typedef void (*store_t)(void *addr, std::size_t index, stack_t value);  //*< store function
+
+/**
+ * @brief unsigned integer with N bytes
+ */
+template <std::size_t N>
+struct word;
+template <>
+struct word<1> {
+    typedef uint8_t type;
+};
+template <>
+struct word<2> {
+    typedef uint16_t type;
+};
+template <>
+struct word<4> {
+    typedef uint32_t type;
+};
+template <>
+struct word<8> {
+    typedef uint64_t type;
+};
+
+/**
+ * @brief check if a data type is a bit
+ */
+constexpr bool is_bit(Memory::dtype_t data_type) {
+    return data_type == Memory::dtype_t::le1 || data_type == Memory::dtype_t::be1;
+}
+
+/**
+ * @brief get the number of bytes that are accessed
+ * @param data_type data type
+ * @param cell_size memory cell size (bits access the whole cell)
+ * @return number of bytes
+ */
+constexpr std::size_t access_size(Memory::dtype_t data_type, std::size_t cell_size) {
+    switch (data_type) {
+        case Memory::dtype_t::le1:
+        case Memory::dtype_t::be1: return cell_size;
+        case Memory::dtype_t::byte: return 1;
+        case Memory::dtype_t::le16:
+        case Memory::dtype_t::be16: return 2;
+        case Memory::dtype_t::le32:
+        case Memory::dtype_t::be32:
+        case Memory::dtype_t::le32r:
+        case Memory::dtype_t::be32r: return 4;
+        case Memory::dtype_t::le64:
+        case Memory::dtype_t::be64:
+        case Memory::dtype_t::le64r:
+        case Memory::dtype_t::be64r:
+        case Memory::dtype_t::le64r4:
+        case Memory::dtype_t::be64r4: return 8;
+        default: throw std::logic_error("invalid data type");
+    }
+}
+
+/**
+ * @brief check if a data type is stored little endian
+ */
+constexpr bool is_little_endian(Memory::dtype_t data_type) {
+    return data_type != Memory::dtype_t::be1 && data_type != Memory::dtype_t::be16 &&
+           data_type != Memory::dtype_t::be32 && data_type != Memory::dtype_t::be32r &&
+           data_type != Memory::dtype_t::be64 && data_type != Memory::dtype_t::be64r &&
+           data_type != Memory::dtype_t::be64r4;
+}
+
+/**
+ * @brief get the size of the registers that are stored in reversed order
+ * @return register size in bytes (0: not reversed)
+ */
+constexpr std::size_t reg_size(Memory::dtype_t data_type) {
+    if (data_type == Memory::dtype_t::le32r || data_type == Memory::dtype_t::be32r ||
+        data_type == Memory::dtype_t::le64r || data_type == Memory::dtype_t::be64r)
+        return 2;
+    if (data_type == Memory::dtype_t::le64r4 || data_type == Memory::dtype_t::be64r4) return 4;
+    return 0;
+}
+
+/**
+ * @brief read a word and convert it to host byte order
+ */
+template <typename W, bool LE>
+[[nodiscard]] inline W read(const void *addr) {
+    W data;
+    std::memcpy(&data, addr, sizeof(data));
+    if constexpr (sizeof(W) > 1) {
+        if (endian::HostEndianness.isLittle() != LE) data = endian::swap(data);
+    }
+    return data;
+}
+
+/**
+ * @brief convert a word from host byte order and write it
+ */
+template <typename W, bool LE>
+inline void write(void *addr, W data) {
+    if constexpr (sizeof(W) > 1) {
+        if (endian::HostEndianness.isLittle() != LE) data = endian::swap(data);
+    }
+    std::memcpy(addr, &data, sizeof(data));
+}
+
+/**
+ * @brief reverse the order of the registers of a word
+ * @details the operation is its own inverse
+ */
+template <typename W, std::size_t REG_SIZE>
+[[nodiscard]] inline W reverse_regs(W data) {
+    if constexpr (REG_SIZE == 0) {
+        return data;
+    } else if constexpr (sizeof(W) == 4) {
+        static_assert(REG_SIZE == 2);
+        return static_cast<W>((data >> 16) | (data << 16));
+    } else if constexpr (REG_SIZE == 4) {
+        static_assert(sizeof(W) == 8);
+        return (data >> 32) | (data << 32);
+    } else {
+        static_assert(sizeof(W) == 8 && REG_SIZE == 2);
+        return (data << 48) | ((data & 0xFFFF0000) << 16) | ((data >> 16) & 0xFFFF0000) | (data >> 48);
+    }
+}
+
+/**
+ * @brief load a variable
+ * @tparam T data type
+ * @tparam CELL_SIZE memory cell size
+ * @param addr address of the base cell
+ * @param index bit index (bits only)
+ * @return loaded value
+ */
+template <Memory::dtype_t T, std::size_t CELL_SIZE>
+[[nodiscard]] inline stack_t load(const void *addr, std::size_t index) {
+    typedef typename word<access_size(T, CELL_SIZE)>::type W;
+
+    const auto data = read<W, is_little_endian(T)>(addr);
+    if constexpr (is_bit(T)) return (data >> index) & 0x1;
+    else
+        return reverse_regs<W, reg_size(T)>(data);
+}
+
+/**
+ * @brief store a variable
+ * @tparam T data type
+ * @tparam CELL_SIZE memory cell size
+ * @param addr address of the base cell
+ * @param index bit index (bits only)
+ * @param value value to store (bits: any nonzero value sets the bit)
+ */
+template <Memory::dtype_t T, std::size_t CELL_SIZE>
+inline void store(void *addr, std::size_t index, stack_t value) {
+    typedef typename word<access_size(T, CELL_SIZE)>::type W;
+
+    if constexpr (is_bit(T)) {
+        const auto mask = static_cast<W>(W(1) << index);
+        auto       data = read<W, is_little_endian(T)>(addr);
+        data            = value != 0 ? static_cast<W>(data | mask) : static_cast<W>(data & ~mask);
+        write<W, is_little_endian(T)>(addr, data);
+    } else {
+        write<W, is_little_endian(T)>(addr, reverse_regs<W, reg_size(T)>(static_cast<W>(value)));
+    }
+}
+
+typedef MemoryReal::bit_cell_t bit_cell_t;
+
+/**
+ * @brief get the position of a bit in the raw memory cell
+ * @tparam T data type (le1 or be1)
+ * @tparam CELL_SIZE memory cell size
+ * @param index bit index
+ */
+template <Memory::dtype_t T, std::size_t CELL_SIZE>
+[[nodiscard]] inline std::size_t raw_bit(std::size_t index) {
+    static_assert(is_bit(T));
+    if (endian::HostEndianness.isLittle() == is_little_endian(T)) return index;
+    return (CELL_SIZE - 1 - index / 8) * 8 + index % 8;
+}
+
+/**
+ * @brief load a bit variable from its cached memory cell
+ * @param addr address of the bit_cell_t
+ * @param index bit index
+ */
+template <Memory::dtype_t T, std::size_t CELL_SIZE>
+[[nodiscard]] inline stack_t load_bit(const void *addr, std::size_t index) {
+    return (static_cast<const bit_cell_t *>(addr)->value >> raw_bit<T, CELL_SIZE>(index)) & 0x1;
+}
+
+/**
+ * @brief store a bit variable in its cached memory cell
+ * @details the bit is recorded in the set/clear masks of the cell
+ * @param addr address of the bit_cell_t
+ * @param index bit index
+ * @param value value to store (any nonzero value sets the bit)
+ */
+template <Memory::dtype_t T, std::size_t CELL_SIZE>
+inline void store_bit(void *addr, std::size_t index, stack_t value) {
+    auto      &cell = *static_cast<bit_cell_t *>(addr);
+    const auto mask = uint64_t(1) << raw_bit<T, CELL_SIZE>(index);
+    if (value != 0) {
+        cell.value |= mask;
+        cell.set |= mask;
+        cell.clear &= ~mask;
+    } else {
+        cell.value &= ~mask;
+        cell.clear |= mask;
+        cell.set &= ~mask;
+    }
+}
+
+/**
+ * @brief load a cell of a local memory (host byte order)
+ */
+[[nodiscard]] inline stack_t load_native(const void *addr, std::size_t) { return *static_cast<const stack_t *>(addr); }
+
+/**
+ * @brief store a cell of a local memory (host byte order)
+ */
+inline void store_native(void *addr, std::size_t, stack_t value) { *static_cast<stack_t *>(addr) = value; }
+
+/**
+ * @brief compile time combination of data type and memory cell size
+ */
+template <Memory::dtype_t T, std::size_t CELL_SIZE>
+struct access_t {
+    static constexpr Memory::dtype_t data_type = T;
+    static constexpr std::size_t     cell_size = CELL_SIZE;
+};
+
+/**
+ * @brief call visitor with the access_t that matches the memory cell size
+ * @tparam T data type
+ * @tparam MAX_CELL_SIZE max memory cell size that can be accessed with the data type
+ */
+template <Memory::dtype_t T, std::size_t MAX_CELL_SIZE, typename Visitor>
+decltype(auto) visit_cell(std::size_t cell_size, Visitor &&visitor) {
+    switch (cell_size) {
+        case 1: return visitor(access_t<T, 1>());
+        case 2:
+            if constexpr (MAX_CELL_SIZE >= 2) return visitor(access_t<T, 2>());
+            break;
+        case 4:
+            if constexpr (MAX_CELL_SIZE >= 4) return visitor(access_t<T, 4>());
+            break;
+        case 8:
+            if constexpr (MAX_CELL_SIZE >= 8) return visitor(access_t<T, 8>());
+            break;
+        default: throw std::invalid_argument("invalid cell size");
+    }
+
+    std::ostringstream sstr;
+    sstr << "Memory cell size is to large to access " << MAX_CELL_SIZE * 8 << " bit.";
+    throw std::runtime_error(sstr.str());
+}
+
+/**
+ * @brief call visitor with access_t<data_type, cell_size>
+ * @details instantiates the visitor for all valid combinations of data type and memory cell size
+ * @param data_type data type
+ * @param cell_size memory cell size
+ * @param visitor generic callable that accepts access_t
+ * @return return value of the visitor
+ * @exception std::runtime_error memory cell size is to large for the data type
+ */
+template <typename Visitor>
+decltype(auto) visit(Memory::dtype_t data_type, std::size_t cell_size, Visitor &&visitor) {
+    switch (data_type) {
+        case Memory::dtype_t::le1: return visit_cell<Memory::dtype_t::le1, 8>(cell_size, visitor);
+        case Memory::dtype_t::be1: return visit_cell<Memory::dtype_t::be1, 8>(cell_size, visitor);
+        case Memory::dtype_t::byte: return visit_cell<Memory::dtype_t::byte, 1>(cell_size, visitor);
+        case Memory::dtype_t::le16: return visit_cell<Memory::dtype_t::le16, 2>(cell_size, visitor);
+        case Memory::dtype_t::be16: return visit_cell<Memory::dtype_t::be16, 2>(cell_size, visitor);
+        case Memory::dtype_t::le32: return visit_cell<Memory::dtype_t::le32, 4>(cell_size, visitor);
+        case Memory::dtype_t::be32: return visit_cell<Memory::dtype_t::be32, 4>(cell_size, visitor);
+        case Memory::dtype_t::le32r: return visit_cell<Memory::dtype_t::le32r, 4>(cell_size, visitor);
+        case Memory::dtype_t::be32r: return visit_cell<Memory::dtype_t::be32r, 4>(cell_size, visitor);
+        case Memory::dtype_t::le64: return visit_cell<Memory::dtype_t::le64, 8>(cell_size, visitor);
+        case Memory::dtype_t::be64: return visit_cell<Memory::dtype_t::be64, 8>(cell_size, visitor);
+        case Memory::dtype_t::le64r: return visit_cell<Memory::dtype_t::le64r, 8>(cell_size, visitor);
+        case Memory::dtype_t::be64r: return visit_cell<Memory::dtype_t::be64r, 8>(cell_size, visitor);
+        case Memory::dtype_t::le64r4: return visit_cell<Memory::dtype_t::le64r4, 8>(cell_size, visitor);
+        case Memory::dtype_t::be64r4: return visit_cell<Memory::dtype_t::be64r4, 8>(cell_size, visitor);
+        default: throw std::logic_error("invalid data type");
+    }
+}
+
+/**
+ * @brief load and store function of a data type
+ */
+struct accessor_t {
+    load_t  load;   //*< load function
+    store_t store;  //*< store function
+};
+
+/**
+ * @brief get the load and store function of a data type
+ * @param data_type data type
+ * @param cell_size memory cell size
+ * @return load and store function
+ * @exception std::runtime_error memory cell size is to large for the data type
+ */
+[[nodiscard]] inline accessor_t accessor(Memory::dtype_t data_type, std::size_t cell_size) {
+    return visit(data_type, cell_size, [](auto access) {
+        typedef decltype(access) A;
+        return accessor_t {&load<A::data_type, A::cell_size>, &store<A::data_type, A::cell_size>};
+    });
+}
+
+/**
+ * @brief get the load and store function of a bit variable with cached memory cell (see bit_cell_t)
+ * @param data_type data type (le1 or be1)
+ * @param cell_size memory cell size
+ * @return load and store function
+ */
+[[nodiscard]] inline accessor_t bit_accessor(Memory::dtype_t data_type, std::size_t cell_size) {
+    if (!is_bit(data_type)) throw std::logic_error("not a bit data type");
+
+    return visit(data_type, cell_size, [](auto access) {
+        typedef decltype(access) A;
+        if constexpr (is_bit(A::data_type))
+            return accessor_t {&load_bit<A::data_type, A::cell_size>, &store_bit<A::data_type, A::cell_size>};
+        else
+            return accessor_t {nullptr, nullptr};
+    });
+}
+
+}  // namespace mem_access
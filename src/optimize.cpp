@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "optimize.hpp"
+
+#include "alu.hpp"
+#include "control_flow.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+using bytecode::opcode_t;
+
+/** @brief alu function of a unary stack operation */
+typedef StackMachine::stack_t (*unary_t)(StackMachine::stack_t);
+
+/** @brief alu function of a binary stack operation */
+typedef StackMachine::stack_t (*binary_t)(StackMachine::stack_t, StackMachine::stack_t);
+
+/**
+ * @brief alu function of each unary stack operation (index: opcode, nullptr: not a unary operation)
+ */
+static constexpr std::array<unary_t, bytecode::OPCODE_COUNT> UNARY_FUNCTION = []() {
+    std::array<unary_t, bytecode::OPCODE_COUNT> table {};
+#define OPTIMIZE_UNARY(name, function) table[static_cast<std::size_t>(opcode_t::name)] = &alu::function;
+    BYTECODE_UNARY_OPS(OPTIMIZE_UNARY)
+#undef OPTIMIZE_UNARY
+    return table;
+}();
+
+/**
+ * @brief alu function of each binary stack operation (index: opcode, nullptr: not a binary operation)
+ */
+static constexpr std::array<binary_t, bytecode::OPCODE_COUNT> BINARY_FUNCTION = []() {
+    std::array<binary_t, bytecode::OPCODE_COUNT> table {};
+#define OPTIMIZE_BINARY(name, function) table[static_cast<std::size_t>(opcode_t::name)] = &alu::function;
+    BYTECODE_BINARY_OPS(OPTIMIZE_BINARY)
+#undef OPTIMIZE_BINARY
+    return table;
+}();
+
+/**
+ * @brief evaluate a unary stack operation
+ * @param code operation
+ * @param X operand
+ * @return result
+ */
+static StackMachine::stack_t eval_unary(opcode_t code, StackMachine::stack_t X) {
+    const auto function = UNARY_FUNCTION[static_cast<std::size_t>(code)];
+    if (!function) throw std::logic_error("optimize: not a unary operation");
+    return function(X);
+}
+
+/**
+ * @brief evaluate a binary stack operation
+ * @param code operation
+ * @param L left operand
+ * @param R right operand
+ * @param result result of the operation
+ * @return false if the operation would fail at runtime (integer division by zero / overflow)
+ */
+static bool eval_binary(opcode_t code, StackMachine::stack_t L, StackMachine::stack_t R,
+                        StackMachine::stack_t &result) {
+    const auto function = BINARY_FUNCTION[static_cast<std::size_t>(code)];
+    if (!function) throw std::logic_error("optimize: not a binary operation");
+
+    if (bytecode::is_division(code)) {
+        if (R == 0) return false;
+        if (bytecode::is_signed_division(code) &&
+            alu::as_signed(L) == std::numeric_limits<StackMachine::signed_stack_t>::min() && alu::as_signed(R) == -1)
+            return false;
+    }
+
+    result = function(L, R);
+    return true;
+}
+
+/**
+ * @brief check if a binary operation with the constant right operand R does not modify the left operand
+ */
+static bool is_identity(opcode_t code, StackMachine::stack_t R) {
+    if (code == opcode_t::ADD || code == opcode_t::SUB || code == opcode_t::BOR || code == opcode_t::BXOR ||
+        code == opcode_t::SHL || code == opcode_t::SHR)
+        return R == 0;
+    if (code == opcode_t::MUL || code == opcode_t::MULS || code == opcode_t::DIV || code == opcode_t::DIVS ||
+        code == opcode_t::POW)
+        return R == 1;
+    if (code == opcode_t::BAND) return R == ~StackMachine::stack_t(0);
+    return false;
+}
+
+/**
+ * @brief check if a control flow node is a jump or branch
+ */
+static bool is_jump(const control_flow::node_t &node) {
+    return node.kind == control_flow::kind_t::jump || node.kind == control_flow::kind_t::branch;
+}
+
+/**
+ * @brief get the exponent of a power of two
+ * @return exponent or -1 if value is not a power of two
+ */
+static int log2_exact(StackMachine::stack_t value) {
+    if (value == 0 || (value & (value - 1)) != 0) return -1;
+
+    int n = 0;
+    while (value >>= 1)
+        ++n;
+    return n;
+}
+
+bytecode::optimize_result_t bytecode::optimize(Program &program) {
+    const auto       &ops = program.get_ops();
+    optimize_result_t result;
+    auto             &origin = result.origin;
+
+    // remove labels and unreachable operations, collapse jump chains
+    std::vector<control_flow::node_t> nodes(ops.size(), {control_flow::kind_t::other});
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const auto code = ops[i].code;
+        if (code == opcode_t::NOP) nodes[i].kind = control_flow::kind_t::nop;
+        else if (code == opcode_t::END)
+            nodes[i].kind = control_flow::kind_t::end;
+        else if (code == opcode_t::J)
+            nodes[i] = {control_flow::kind_t::jump, ops[i].arg.target};
+        else if (code == opcode_t::JZ || code == opcode_t::JNZ)
+            nodes[i] = {control_flow::kind_t::branch, ops[i].arg.target};
+    }
+    const auto flow = control_flow::cleanup(nodes);
+    result.threaded = flow.threaded;
+
+    std::vector<bool> target(ops.size(), false);
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        if (flow.keep[i] && is_jump(nodes[i])) target[flow.target[i]] = true;
+    }
+
+    std::vector<op_t>        out;
+    std::vector<std::size_t> new_index(ops.size());
+
+    // operations before barrier must not be combined with the following operations (jump target)
+    std::size_t barrier = 0;
+
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const auto &op = ops[i];
+
+        if (target[i]) barrier = out.size();
+        new_index[i] = out.size();
+
+        // number of preceding operations that can be combined with op
+        const auto avail = out.size() - barrier;
+        op_t      *t1    = avail >= 1 ? &out[out.size() - 1] : nullptr;
+        op_t      *t2    = avail >= 2 ? &out[out.size() - 2] : nullptr;
+
+        auto merge_origin = [&](std::size_t pos) {
+            origin[pos].first = std::min(origin[pos].first, i);
+            origin[pos].last  = std::max(origin[pos].last, i);
+        };
+
+        auto drop_last = [&]() {
+            out.pop_back();
+            origin.pop_back();
+        };
+
+        auto append = [&](const op_t &new_op, origin_t from) {
+            out.push_back(new_op);
+            origin.push_back(from);
+        };
+
+        const bool c1 = t1 && t1->code == opcode_t::PUSH_CONST;
+        const bool c2 = t2 && t2->code == opcode_t::PUSH_CONST;
+
+        if (!flow.keep[i]) continue;
+
+        if (op.code == opcode_t::POP_NULL && t1 &&
+            (t1->code == opcode_t::PUSH_CONST || t1->code == opcode_t::PUSH_VAR || t1->code == opcode_t::DUP)) {
+            drop_last();
+            continue;
+        }
+
+        if (op.code == opcode_t::DUP && c1) {
+            const auto from = origin.back();
+            append(*t1, {from.first, i});
+            continue;
+        }
+
+        if (bytecode::is_unary(op.code) && c1) {
+            t1->arg.value = eval_unary(op.code, t1->arg.value);
+            merge_origin(out.size() - 1);
+            ++result.folded;
+            continue;
+        }
+
+        if (bytecode::is_binary(op.code) && c1 && c2) {
+            StackMachine::stack_t value;
+            if (eval_binary(op.code, t2->arg.value, t1->arg.value, value)) {
+                t2->arg.value = value;
+                drop_last();
+                merge_origin(out.size() - 1);
+                ++result.folded;
+                continue;
+            }
+        }
+
+        if (bytecode::is_binary(op.code) && c1) {
+            const auto R = t1->arg.value;
+            const auto n = log2_exact(R);
+
+            if (is_identity(op.code, R)) {
+                drop_last();
+                ++result.reduced;
+                continue;
+            }
+
+            if (op.code == opcode_t::POW && R == 2) {
+                *t1 = op_t(opcode_t::DUP);
+                append(op_t(opcode_t::MUL), {i, i});
+                ++result.reduced;
+                continue;
+            }
+
+            if ((op.code == opcode_t::MUL || op.code == opcode_t::MULS || op.code == opcode_t::DIV) && n > 0) {
+                t1->arg.value = static_cast<StackMachine::stack_t>(n);
+                append(op_t(op.code == opcode_t::DIV ? opcode_t::SHR : opcode_t::SHL), {i, i});
+                ++result.reduced;
+                continue;
+            }
+
+            if (op.code == opcode_t::MOD && n >= 0) {
+                t1->arg.value = R - 1;
+                append(op_t(opcode_t::BAND), {i, i});
+                ++result.reduced;
+                continue;
+            }
+        }
+
+        append(op, {i, i});
+        if (is_jump(nodes[i])) out.back().arg.target = flow.target[i];
+    }
+
+    for (auto &op : out) {
+        if (op.code == opcode_t::J || op.code == opcode_t::JZ || op.code == opcode_t::JNZ)
+            op.arg.target = new_index[op.arg.target];
+    }
+
+    result.removed = ops.size() - out.size();
+    program.assign(std::move(out));
+    return result;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "bytecode.hpp"
+
+#include <vector>
+
+namespace bytecode {
+
+/**
+ * @brief range of operations of the original program
+ */
+struct origin_t {
+    std::size_t first;  //*< index of the first operation
+    std::size_t last;   //*< index of the last operation
+};
+
+/**
+ * @brief result of the optimization pass
+ */
+struct optimize_result_t {
+    std::size_t           folded   = 0;  //*< number of operations that were evaluated at load time
+    std::size_t           reduced  = 0;  //*< number of operations that were replaced by cheaper operations
+    std::size_t           removed  = 0;  //*< number of operations that were removed from the program
+    std::size_t           threaded = 0;  //*< number of jumps that were redirected past another jump
+    std::vector<origin_t> origin;        //*< operations of the original program each operation was generated from
+};
+
+/**
+ * @brief constant folding and peephole optimization
+ * @details
+ *   Labels (NOP) and unreachable operations are removed and jump chains are collapsed (see control_flow::cleanup).
+ *
+ *   Rewrites the program in a single pass. Each operation is appended to the optimized program and combined with the
+ *   preceding operations if possible:
+ *     - PUSH_CONST a; PUSH_CONST b; OP         --> PUSH_CONST OP(a, b)
+ *     - PUSH_CONST a; OP                       --> PUSH_CONST OP(a)
+ *     - PUSH_CONST a; DUP                      --> PUSH_CONST a; PUSH_CONST a
+ *     - PUSH_CONST 2; POW                      --> DUP; MUL
+ *     - PUSH_CONST 2^n; MUL / MULS             --> PUSH_CONST n; SHL
+ *     - PUSH_CONST 2^n; DIV                    --> PUSH_CONST n; SHR
+ *     - PUSH_CONST 2^n; MOD                    --> PUSH_CONST 2^n - 1; BAND
+ *     - x + 0, x - 0, x | 0, x ^ 0, x * 1, x / 1, x ** 1  --> x
+ *     - PUSH_CONST, PUSH_VAR or DUP; POP_NULL  --> (removed)
+ *
+ *   Operations that could fail at runtime (integer division by zero) are not folded.
+ *   Floating point operations are only folded, never rewritten (x + 0.0 is not x for x = -0.0).
+ *   Operations are never combined across a jump target. Jump targets are adjusted to the optimized program.
+ *
+ *   The program has to be verified again afterwards (see Program::verify). Must run before fuse.
+ * @param program program to optimize
+ * @return optimization statistics
+ */
+optimize_result_t optimize(Program &program);
+
+}  // namespace bytecode
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "rt.hpp"
+
+#include "split_string.hpp"
+#include <algorithm>
+#include <alloca.h>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <malloc.h>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace rt {
+
+/**
+ * @brief get the native scheduling policy
+ */
+static int native_policy(policy_t policy) {
+    switch (policy) {
+        case policy_t::fifo: return SCHED_FIFO;
+        case policy_t::rr: return SCHED_RR;
+        case policy_t::other: return SCHED_OTHER;
+        default: throw std::logic_error("invalid scheduling policy");
+    }
+}
+
+/**
+ * @brief parse a non negative integer
+ */
+static int parse_int(const std::string &str) {
+    std::size_t end;
+    const auto  value = std::stoi(str, &end, 0);
+    if (end != str.size() || value < 0) throw std::runtime_error("not a non negative integer");
+    return value;
+}
+
+void set_policy(profile_t &profile, const std::string &policy, const std::string &priority) {
+    std::string name = policy;
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::toupper(c); });
+
+    if (name == "OTHER") profile.policy = policy_t::other;
+    else if (name == "FIFO")
+        profile.policy = policy_t::fifo;
+    else if (name == "RR")
+        profile.policy = policy_t::rr;
+    else {
+        std::ostringstream sstr;
+        sstr << "invalid scheduling policy '" << policy << "' (expected OTHER, FIFO or RR)";
+        throw std::runtime_error(sstr.str());
+    }
+
+    const int min = sched_get_priority_min(native_policy(profile.policy));
+    const int max = sched_get_priority_max(native_policy(profile.policy));
+
+    profile.priority = min;
+    if (!priority.empty()) {
+        try {
+            profile.priority = parse_int(priority);
+        } catch (const std::exception &) {
+            std::ostringstream sstr;
+            sstr << "failed to parse '" << priority << "' as scheduling priority";
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    if (profile.priority < min || profile.priority > max) {
+        std::ostringstream sstr;
+        sstr << "scheduling priority " << profile.priority << " out of range (" << name << ": " << min << ".." << max
+             << ')';
+        throw std::runtime_error(sstr.str());
+    }
+
+    profile.set_policy = true;
+}
+
+std::vector<int> parse_cpus(const std::string &list) {
+    std::vector<int> cpus;
+    for (const auto &entry : split_string(list, ',')) {
+        const auto range = split_string(entry, '-');
+        try {
+            if (range.size() == 1) {
+                cpus.push_back(parse_int(range[0]));
+            } else if (range.size() == 2) {
+                const int first = parse_int(range[0]);
+                const int last  = parse_int(range[1]);
+                if (last < first) throw std::runtime_error("invalid range");
+                for (int cpu = first; cpu <= last; ++cpu)
+                    cpus.push_back(cpu);
+            } else {
+                throw std::runtime_error("invalid range");
+            }
+        } catch (const std::exception &) {
+            std::ostringstream sstr;
+            sstr << "invalid CPU list '" << list << "'";
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    if (cpus.empty()) {
+        std::ostringstream sstr;
+        sstr << "invalid CPU list '" << list << "'";
+        throw std::runtime_error(sstr.str());
+    }
+
+    for (const auto cpu : cpus) {
+        if (cpu >= CPU_SETSIZE) {
+            std::ostringstream sstr;
+            sstr << "CPU " << cpu << " out of range (max " << CPU_SETSIZE - 1 << ')';
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    return cpus;
+}
+
+/**
+ * @brief write to each page of the given number of stack bytes below the current stack frame
+ * @details not inlined: the stack frame is released when the function returns, the pages remain mapped
+ */
+#ifdef COMPILER_GNU_CLANG
+__attribute__((noinline))
+#endif
+static void prefault_stack(std::size_t size) {
+    rlimit limit {};
+    if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && size > limit.rlim_cur / 2) {
+        std::ostringstream sstr;
+        sstr << "stack prefault size " << size << " exceeds half of the stack size limit (" << limit.rlim_cur << ')';
+        throw std::runtime_error(sstr.str());
+    }
+
+    const auto page  = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    auto      *stack = static_cast<volatile unsigned char *>(alloca(size));
+    for (std::size_t i = 0; i < size; i += page)
+        stack[i] = 0;
+}
+
+void apply(const profile_t &profile) {
+    if (profile.lock_memory) {
+        // freed memory remains in the process (no new page faults if it is allocated again)
+        mallopt(M_TRIM_THRESHOLD, -1);
+        mallopt(M_MMAP_MAX, 0);
+
+        if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+            const int          err = errno;
+            std::ostringstream sstr;
+            sstr << "mlockall failed: " << std::strerror(err);
+            if (err == ENOMEM || err == EPERM) sstr << " (RLIMIT_MEMLOCK too small or CAP_IPC_LOCK missing)";
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    // locked stack pages are still faulted in on first use
+    const auto stack_prefault = std::max(profile.stack_prefault, profile.lock_memory ? DEFAULT_STACK_PREFAULT : 0);
+    if (stack_prefault) prefault_stack(stack_prefault);
+
+    if (!profile.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const auto cpu : profile.cpus)
+            CPU_SET(static_cast<std::size_t>(cpu), &set);
+
+        if (sched_setaffinity(0, sizeof(set), &set)) {
+            std::ostringstream sstr;
+            sstr << "sched_setaffinity failed: " << std::strerror(errno);
+            throw std::runtime_error(sstr.str());
+        }
+    }
+
+    if (profile.set_policy) {
+        sched_param param {};
+        param.sched_priority = profile.priority;
+        if (sched_setscheduler(0, native_policy(profile.policy), &param)) {
+            const int          err = errno;
+            std::ostringstream sstr;
+            sstr << "sched_setscheduler failed: " << std::strerror(err);
+            if (err == EPERM) sstr << " (RLIMIT_RTPRIO too small or CAP_SYS_NICE missing)";
+            throw std::runtime_error(sstr.str());
+        }
+    }
+}
+
+std::ostream &operator<<(std::ostream &out, const profile_t &profile) {
+    static const char *const POLICY_NAME[] = {"SCHED_OTHER", "SCHED_FIFO", "SCHED_RR"};
+
+    std::ostringstream sstr;
+    if (profile.set_policy) sstr << POLICY_NAME[static_cast<int>(profile.policy)] << ' ' << profile.priority;
+    else
+        sstr << "policy unchanged";
+
+    if (!profile.cpus.empty()) {
+        sstr << ", CPU";
+        for (std::size_t i = 0; i < profile.cpus.size(); ++i)
+            sstr << (i ? "," : " ") << profile.cpus[i];
+    }
+
+    if (profile.lock_memory) sstr << ", memory locked";
+    const auto stack_prefault = std::max(profile.stack_prefault, profile.lock_memory ? DEFAULT_STACK_PREFAULT : 0);
+    if (stack_prefault) sstr << ", " << stack_prefault / 1024 << " KiB stack prefaulted";
+
+    return out << sstr.str();
+}
+
+}  // namespace rt
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief real-time execution profile (scheduling policy, CPU affinity, locked memory)
+ * @details
+ *   The profile is applied after the program was loaded and initialized, so the allocations and page faults of the
+ *   parser do not interfere with the cycles.
+ */
+namespace rt {
+
+//* number of stack bytes that are prefaulted if the memory is locked (and STACK_PREFAULT is not set)
+static constexpr std::size_t DEFAULT_STACK_PREFAULT = 256 * 1024;
+
+/**
+ * @brief scheduling policy
+ */
+enum class policy_t {
+    other,  //*< SCHED_OTHER (default time sharing)
+    fifo,   //*< SCHED_FIFO
+    rr,     //*< SCHED_RR
+};
+
+/**
+ * @brief real-time execution profile
+ */
+struct profile_t {
+    bool             set_policy     = false;            //*< change the scheduling policy
+    policy_t         policy         = policy_t::other;  //*< scheduling policy
+    int              priority       = 0;                //*< static priority (0 for SCHED_OTHER)
+    std::vector<int> cpus;                              //*< allowed CPUs (empty: not changed)
+    bool             lock_memory    = false;            //*< mlockall(MCL_CURRENT | MCL_FUTURE)
+    std::size_t      stack_prefault = 0;                //*< number of stack bytes to prefault
+
+    /**
+     * @brief check if the profile changes anything
+     */
+    [[nodiscard]] bool empty() const { return !set_policy && cpus.empty() && !lock_memory && !stack_prefault; }
+};
+
+/**
+ * @brief set the scheduling policy of a profile
+ * @param profile profile
+ * @param policy OTHER, FIFO or RR (case insensitive)
+ * @param priority static priority (empty: lowest priority of the policy)
+ * @exception std::runtime_error invalid policy or priority
+ */
+void set_policy(profile_t &profile, const std::string &policy, const std::string &priority);
+
+/**
+ * @brief parse a CPU list
+ * @param list comma separated CPU numbers or ranges (e.g. 2,4-7)
+ * @return CPU numbers
+ * @exception std::runtime_error invalid CPU list
+ */
+std::vector<int> parse_cpus(const std::string &list);
+
+/**
+ * @brief apply a profile to the calling process
+ * @details order: lock memory, prefault stack, CPU affinity, scheduling policy
+ * @exception std::runtime_error failed to apply the profile (e.g. missing privileges)
+ */
+void apply(const profile_t &profile);
+
+/**
+ * @brief print a profile (one line)
+ */
+std::ostream &operator<<(std::ostream &out, const profile_t &profile);
+
+}  // namespace rt
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace scheduler {
+
+static constexpr int64_t NS_PER_S = 1000000000;
+
+/**
+ * @brief get the current time of CLOCK_MONOTONIC in ns
+ */
+static int64_t now_ns() {
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NS_PER_S + now.tv_nsec;
+}
+
+/**
+ * @brief hint to the CPU that the thread is busy waiting
+ */
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+wait_policy_t parse_wait(const std::string &mode, const std::string &spin_us) {
+    std::string name = mode;
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::toupper(c); });
+
+    wait_policy_t policy;
+    if (name == "SLEEP") policy.mode = wait_t::sleep;
+    else if (name == "SPIN")
+        policy.mode = wait_t::spin;
+    else if (name == "HYBRID")
+        policy.mode = wait_t::hybrid;
+    else {
+        std::ostringstream sstr;
+        sstr << "invalid wait mode '" << mode << "' (expected SLEEP, SPIN or HYBRID)";
+        throw std::runtime_error(sstr.str());
+    }
+
+    if (policy.mode != wait_t::hybrid) {
+        if (!spin_us.empty()) {
+            std::ostringstream sstr;
+            sstr << "wait mode " << name << " has no spin time";
+            throw std::runtime_error(sstr.str());
+        }
+        return policy;
+    }
+
+    policy.spin = wait_policy_t::DEFAULT_SPIN;
+    if (!spin_us.empty()) {
+        std::size_t end   = 0;
+        long long   value = -1;
+        try {
+            value = std::stoll(spin_us, &end, 0);
+        } catch (const std::exception &) { end = 0; }
+
+        if (end != spin_us.size() || value <= 0 || value > INT64_MAX / 1000) {
+            std::ostringstream sstr;
+            sstr << "invalid spin time '" << spin_us << "' (expected a positive number of us)";
+            throw std::runtime_error(sstr.str());
+        }
+        policy.spin = std::chrono::microseconds(value);
+    }
+
+    return policy;
+}
+
+std::ostream &operator<<(std::ostream &out, const wait_policy_t &policy) {
+    switch (policy.mode) {
+        case wait_t::sleep: return out << "SLEEP";
+        case wait_t::spin: return out << "SPIN";
+        case wait_t::hybrid:
+            return out << "HYBRID " << std::chrono::duration_cast<std::chrono::microseconds>(policy.spin).count()
+                       << " us";
+        default: throw std::logic_error("invalid wait mode");
+    }
+}
+
+Scheduler::Scheduler(std::chrono::nanoseconds cycle_time, overrun_t overrun)
+    : cycle_time(cycle_time.count()), overrun(overrun), deadline(0), window(LATENCY_WINDOW) {
+    if (cycle_time.count() <= 0) throw std::invalid_argument("cycle time must be greater than zero");
+}
+
+void Scheduler::start() { deadline = now_ns() + cycle_time; }
+
+std::size_t Scheduler::next_cycle() {
+    ++cycles;
+
+    const auto now = now_ns();
+    if (now < deadline) return 0;
+
+    ++overruns;
+    last_start = 0;  // the next period contains the missed deadlines
+    const auto missed = static_cast<std::size_t>((now - deadline) / cycle_time) + 1;
+    if (overrun == overrun_t::skip) {
+        // first regular deadline in the future
+        deadline += static_cast<int64_t>(missed) * cycle_time;
+        skipped += missed;
+    }
+    return missed;
+}
+
+bool Scheduler::sleep() {
+    if (now_ns() < deadline) {
+        // hybrid: wake up early and busy wait for the rest
+        const auto wakeup_ns = wait.mode == wait_t::hybrid ? deadline - wait.spin.count() : deadline;
+
+        if (wait.mode != wait_t::spin && now_ns() < wakeup_ns) {
+            timespec wakeup {};
+            wakeup.tv_sec  = wakeup_ns / NS_PER_S;
+            wakeup.tv_nsec = wakeup_ns % NS_PER_S;
+
+            // returns the error number (errno is not set)
+            const int err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, nullptr);
+            if (err == EINTR) return false;
+            if (err) {
+                std::ostringstream sstr;
+                sstr << "clock_nanosleep failed: " << std::strerror(err);
+                throw std::runtime_error(sstr.str());
+            }
+        }
+
+        auto now = now_ns();
+        if (wait.mode != wait_t::sleep) {
+            while (now < deadline) {
+                cpu_relax();
+                now = now_ns();
+            }
+        }
+
+        const auto latency              = now - deadline;
+        window[samples % LATENCY_WINDOW] = latency;
+        ++samples;
+        min = std::min(min, latency);
+        max = std::max(max, latency);
+        sum += static_cast<double>(latency);
+
+        if (last_start) {
+            const auto period    = now - last_start;
+            const auto deviation = std::abs(period - cycle_time);
+            ++periods;
+            period_min = std::min(period_min, period);
+            period_max = std::max(period_max, period);
+            jitter_max = std::max(jitter_max, deviation);
+            jitter_sum2 += static_cast<double>(deviation) * static_cast<double>(deviation);
+        }
+        last_start = now;
+    } else {
+        last_start = 0;
+    }
+
+    deadline += cycle_time;
+    return true;
+}
+
+stats_t Scheduler::get_stats() const {
+    stats_t stats;
+    stats.cycles   = cycles;
+    stats.overruns = overruns;
+    stats.skipped  = skipped;
+    stats.samples  = samples;
+    stats.periods  = periods;
+    if (periods) {
+        stats.period_min = std::chrono::nanoseconds(period_min);
+        stats.period_max = std::chrono::nanoseconds(period_max);
+        stats.jitter_max = std::chrono::nanoseconds(jitter_max);
+        stats.jitter_rms = std::chrono::nanoseconds(
+                static_cast<int64_t>(std::sqrt(jitter_sum2 / static_cast<double>(periods))));
+    }
+    if (!samples) return stats;
+
+    stats.min  = std::chrono::nanoseconds(min);
+    stats.max  = std::chrono::nanoseconds(max);
+    stats.mean = std::chrono::nanoseconds(static_cast<int64_t>(sum / static_cast<double>(samples)));
+
+    std::vector<int64_t> sorted(window.begin(),
+                                window.begin() + static_cast<std::ptrdiff_t>(std::min(samples, LATENCY_WINDOW)));
+    const auto           index = (sorted.size() * 99 + 99) / 100 - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(index), sorted.end());
+    stats.p99 = std::chrono::nanoseconds(sorted[index]);
+
+    return stats;
+}
+
+std::ostream &operator<<(std::ostream &out, const stats_t &stats) {
+    auto us = [](std::chrono::nanoseconds ns) { return static_cast<double>(ns.count()) / 1000.0; };
+
+    std::ostringstream sstr;
+    sstr << stats.cycles << " cycles, " << stats.overruns << " overruns, " << stats.skipped << " skipped";
+    if (stats.samples) {
+        sstr << ", wake latency min/mean/max/p99: " << std::fixed << std::setprecision(1) << us(stats.min) << '/'
+             << us(stats.mean) << '/' << us(stats.max) << '/' << us(stats.p99) << " us";
+    }
+    if (stats.periods) {
+        sstr << ", period min/max: " << std::fixed << std::setprecision(1) << us(stats.period_min) << '/'
+             << us(stats.period_max) << " us, jitter rms/max: " << us(stats.jitter_rms) << '/' << us(stats.jitter_max)
+             << " us";
+    }
+    return out << sstr.str();
+}
+
+}  // namespace scheduler
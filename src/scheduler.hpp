@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief cyclic execution with absolute deadlines
+ * @details
+ *   The begin of cycle n is start + n * cycle time (CLOCK_MONOTONIC). The deadlines do not depend on the time the
+ *   process is woken up, so the cycles do not drift.
+ *
+ *   The scheduler does not use signals. It either sleeps (clock_nanosleep), busy waits on CLOCK_MONOTONIC or combines
+ *   both (see wait_t).
+ */
+namespace scheduler {
+
+/**
+ * @brief behaviour if a cycle exceeds the cycle time (setting OVERRUN)
+ */
+enum class overrun_t {
+    skip,      //*< the next cycle starts at the next regular deadline, the missed cycles are dropped (SKIP, default)
+    catch_up,  //*< the missed cycles are executed immediately one after another (CATCHUP)
+};
+
+/**
+ * @brief how the begin of the next cycle is awaited (setting WAIT)
+ */
+enum class wait_t {
+    sleep,   //*< sleep until the deadline (SLEEP, default)
+    spin,    //*< busy wait until the deadline (SPIN, the CPU is never released)
+    hybrid,  //*< sleep until the spin time before the deadline, busy wait for the rest (HYBRID)
+};
+
+/**
+ * @brief wait mode and spin time
+ */
+struct wait_policy_t {
+    //* default spin time of HYBRID
+    static constexpr std::chrono::microseconds DEFAULT_SPIN {50};
+
+    wait_t                   mode = wait_t::sleep;  //*< wait mode
+    std::chrono::nanoseconds spin {};               //*< spin time before the deadline (HYBRID)
+};
+
+/**
+ * @brief parse a wait mode
+ * @param mode SLEEP, SPIN or HYBRID (case insensitive)
+ * @param spin_us spin time of HYBRID in us (empty: wait_policy_t::DEFAULT_SPIN)
+ * @return wait policy
+ * @exception std::runtime_error invalid mode or spin time
+ */
+wait_policy_t parse_wait(const std::string &mode, const std::string &spin_us);
+
+/**
+ * @brief print the wait policy (e.g. HYBRID 50 us)
+ */
+std::ostream &operator<<(std::ostream &out, const wait_policy_t &policy);
+
+/**
+ * @brief statistics of the scheduler
+ */
+struct stats_t {
+    std::size_t              cycles   = 0;   //*< number of cycles
+    std::size_t              overruns = 0;   //*< number of cycles that exceeded the cycle time
+    std::size_t              skipped  = 0;   //*< number of dropped cycles (SKIP)
+    std::size_t              samples  = 0;   //*< number of wake latency samples (the cycles that had to wait)
+    std::chrono::nanoseconds min {};         //*< min wake latency
+    std::chrono::nanoseconds mean {};        //*< mean wake latency
+    std::chrono::nanoseconds max {};         //*< max wake latency
+    std::chrono::nanoseconds p99 {};         //*< 99th percentile of the wake latency (last LATENCY_WINDOW samples)
+    std::size_t              periods = 0;    //*< number of periods (consecutive cycles that had to wait)
+    std::chrono::nanoseconds period_min {};  //*< min time between the begin of two consecutive cycles
+    std::chrono::nanoseconds period_max {};  //*< max time between the begin of two consecutive cycles
+    std::chrono::nanoseconds jitter_rms {};  //*< root mean square deviation of the period from the cycle time
+    std::chrono::nanoseconds jitter_max {};  //*< max deviation of the period from the cycle time
+};
+
+/**
+ * @brief print the statistics (one line)
+ */
+std::ostream &operator<<(std::ostream &out, const stats_t &stats);
+
+/**
+ * @brief cycle scheduler based on clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME)
+ * @details
+ *   Usage (once per cycle):
+ *     - start before the first cycle
+ *     - execute the cycle
+ *     - next_cycle: check if the cycle time was exceeded
+ *     - sleep: wait for the begin of the next cycle (repeat if interrupted by a signal)
+ *
+ *   The wake latency is the time between the deadline and the end of the wait. The period is the time between the
+ *   end of two consecutive waits.
+ */
+class Scheduler final {
+public:
+    //* number of wake latency samples that are used for the 99th percentile
+    static constexpr std::size_t LATENCY_WINDOW = 4096;
+
+private:
+    int64_t       cycle_time;  //*< cycle time in ns
+    overrun_t     overrun;     //*< overrun policy
+    wait_policy_t wait;        //*< wait mode
+    int64_t       deadline;    //*< begin of the next cycle in ns (CLOCK_MONOTONIC)
+
+    std::size_t          cycles   = 0;
+    std::size_t          overruns = 0;
+    std::size_t          skipped  = 0;
+    std::size_t          samples  = 0;          //*< number of latency samples
+    int64_t              min      = INT64_MAX;  //*< min latency in ns
+    int64_t              max      = 0;          //*< max latency in ns
+    double               sum      = 0.0;        //*< sum of all latencies in ns
+    std::vector<int64_t> window;                //*< ring buffer of the last LATENCY_WINDOW latencies
+
+    int64_t     last_start  = 0;          //*< end of the last wait in ns (0: no period measurement)
+    std::size_t periods     = 0;          //*< number of period samples
+    int64_t     period_min  = INT64_MAX;  //*< in ns
+    int64_t     period_max  = 0;          //*< in ns
+    int64_t     jitter_max  = 0;          //*< in ns
+    double      jitter_sum2 = 0.0;        //*< sum of the squared deviations in ns^2
+
+public:
+    /**
+     * @brief create scheduler
+     * @param cycle_time cycle time
+     * @param overrun overrun policy
+     * @exception std::invalid_argument cycle time is zero or negative
+     */
+    Scheduler(std::chrono::nanoseconds cycle_time, overrun_t overrun);
+
+    /**
+     * @brief set the wait mode
+     * @details has to be called before start
+     * @param policy wait policy
+     */
+    void set_wait(const wait_policy_t &policy) { wait = policy; }
+
+    /**
+     * @brief start the first cycle now
+     */
+    void start();
+
+    /**
+     * @brief end the current cycle
+     * @details called once per cycle after the cycle was executed
+     * @return number of deadlines that passed during the cycle (0: cycle time not exceeded)
+     */
+    std::size_t next_cycle();
+
+    /**
+     * @brief wait until the begin of the next cycle (see set_wait)
+     * @details returns immediately if the deadline already passed (CATCHUP)
+     * @return true: next cycle begins, false: sleep interrupted by a signal (call again to continue the wait)
+     * @exception std::runtime_error clock_nanosleep failed
+     */
+    bool sleep();
+
+    /**
+     * @brief get the statistics since start
+     */
+    [[nodiscard]] stats_t get_stats() const;
+};
+
+}  // namespace scheduler
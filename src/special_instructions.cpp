@@ -8,91 +8,146 @@
 #include <ctime>
 #include <iostream>
 #include <random>
-#include <system_error>
 #include <unistd.h>
 
-static std::random_device         rd;
-static std::default_random_engine re(rd());
+// per thread (host mode executes the machines on multiple threads)
+static thread_local std::default_random_engine re(std::random_device {}());
 
+/**
+ * @brief virtual clock of the simulation mode (see instr_special::simulate)
+ */
+static thread_local struct {
+    bool    active   = false;  //*< clocks are simulated
+    double  realtime = 0.0;    //*< CLOCK_REALTIME at the start of the simulation in s
+    int64_t elapsed  = 0;      //*< simulated time in ns
+} simulation;
+
+void instr_special::simulate(uint64_t seed) {
+    struct timespec tp {};
+    clock_gettime(CLOCK_REALTIME, &tp);
+
+    simulation.active   = true;
+    simulation.realtime = static_cast<double>(tp.tv_sec);
+    simulation.elapsed  = 0;
+    re.seed(seed);
+}
+
+void instr_special::advance_clock(std::chrono::nanoseconds time) { simulation.elapsed += time.count(); }
+
+/**
+ * @brief get the time of a clock in seconds
+ * @details returns the virtual clock in simulation mode
+ * @param time time of the clock
+ * @return false: call of clock_gettime failed
+ */
 template <clockid_t CLOCK_ID>
-static double get_time() {
+static bool get_time(double &time) {
+    if (simulation.active) {
+        time = static_cast<double>(simulation.elapsed) / 1000000000.0;
+        if constexpr (CLOCK_ID == CLOCK_REALTIME) time += simulation.realtime;
+        return true;
+    }
+
     struct timespec tp;
     int             tmp = clock_gettime(CLOCK_ID, &tp);
-    if (tmp != 0) throw std::system_error(errno, std::generic_category(), "call of clock_gettime failed");
+    if (tmp != 0) return false;
 
-    return static_cast<double>(tp.tv_sec) + static_cast<double>(tp.tv_nsec) / 1000000000.0;
+    time = static_cast<double>(tp.tv_sec) + static_cast<double>(tp.tv_nsec) / 1000000000.0;
+    return true;
 }
 
-bool instr_special::PUSH_stime::exec() {
+template <typename Trace>
+bool instr_special::PUSH_stime<Trace>::exec() {
     union {
         StackMachine::stack_t st;
         double                time;
     };
-    time = get_time<CLOCK_REALTIME>();
-    machine.push(st);
+    if (!get_time<CLOCK_REALTIME>(time)) {
+        machine.set_fault(StackMachine::fault_t::system);
+        return false;
+    }
+    machine.push<Trace>(st);
     return true;
 }
 
-bool instr_special::PUSH_mtime::exec() {
+template <typename Trace>
+bool instr_special::PUSH_mtime<Trace>::exec() {
     union {
         StackMachine::stack_t st;
         double                time;
     };
-    time = get_time<CLOCK_MONOTONIC>();
-    machine.push(st);
+    if (!get_time<CLOCK_MONOTONIC>(time)) {
+        machine.set_fault(StackMachine::fault_t::system);
+        return false;
+    }
+    machine.push<Trace>(st);
     return true;
 }
 
-bool instr_special::PUSH_ctime::exec() {
+template <typename Trace>
+bool instr_special::PUSH_ctime<Trace>::exec() {
     union {
         StackMachine::stack_t st;
         double                time;
     };
-    time = get_time<CLOCK_PROCESS_CPUTIME_ID>();
-    machine.push(st);
+    if (!get_time<CLOCK_PROCESS_CPUTIME_ID>(time)) {
+        machine.set_fault(StackMachine::fault_t::system);
+        return false;
+    }
+    machine.push<Trace>(st);
     return true;
 }
 
-bool instr_special::PUSH_ttime::exec() {
+template <typename Trace>
+bool instr_special::PUSH_ttime<Trace>::exec() {
     union {
         StackMachine::stack_t st;
         double                time;
     };
-    time = get_time<CLOCK_THREAD_CPUTIME_ID>();
-    machine.push(st);
+    if (!get_time<CLOCK_THREAD_CPUTIME_ID>(time)) {
+        machine.set_fault(StackMachine::fault_t::system);
+        return false;
+    }
+    machine.push<Trace>(st);
     return true;
 }
 
-bool instr_special::PUSH_pid::exec() {
-    machine.push(getpid());
+template <typename Trace>
+bool instr_special::PUSH_pid<Trace>::exec() {
+    machine.push<Trace>(getpid());
     return true;
 }
 
-bool instr_special::PUSH_ppid::exec() {
-    machine.push(getppid());
+template <typename Trace>
+bool instr_special::PUSH_ppid<Trace>::exec() {
+    machine.push<Trace>(getppid());
     return true;
 }
 
-bool instr_special::PUSH_uid::exec() {
-    machine.push(getuid());
+template <typename Trace>
+bool instr_special::PUSH_uid<Trace>::exec() {
+    machine.push<Trace>(getuid());
     return true;
 }
 
-bool instr_special::PUSH_euid::exec() {
-    machine.push(geteuid());
+template <typename Trace>
+bool instr_special::PUSH_euid<Trace>::exec() {
+    machine.push<Trace>(geteuid());
     return true;
 }
 
-bool instr_special::PUSH_rand::exec() {
+template <typename Trace>
+bool instr_special::PUSH_rand<Trace>::exec() {
     auto r_val = re();
     static_assert(sizeof(r_val) >= sizeof(StackMachine::stack_t));
     static_assert(std::is_integral<decltype(r_val)>::value);
-    machine.push(r_val);
+    machine.push<Trace>(r_val);
     return true;
 }
 
-bool instr_special::PUSH_randf::exec() {
-    static std::uniform_real_distribution<float> dist(0.0, 1.0);
+template <typename Trace>
+bool instr_special::PUSH_randf<Trace>::exec() {
+    static thread_local std::uniform_real_distribution<float> dist(0.0, 1.0);
 
     union {
         uint32_t i;
@@ -100,12 +155,13 @@ bool instr_special::PUSH_randf::exec() {
     };
 
     f = dist(re);
-    machine.push(i);
+    machine.push<Trace>(i);
     return true;
 }
 
-bool instr_special::PUSH_randd::exec() {
-    static std::uniform_real_distribution<double> dist(0.0, 1.0);
+template <typename Trace>
+bool instr_special::PUSH_randd<Trace>::exec() {
+    static thread_local std::uniform_real_distribution<double> dist(0.0, 1.0);
 
     union {
         uint64_t i;
@@ -113,41 +169,65 @@ bool instr_special::PUSH_randd::exec() {
     };
 
     d = dist(re);
-    machine.push(i);
+    machine.push<Trace>(i);
     return true;
 }
 
-bool instr_special::POP_stdout::exec() {
-    std::cout << machine.pop() << std::endl;
+template <typename Trace>
+bool instr_special::POP_stdout<Trace>::exec() {
+    std::cout << machine.pop<Trace>() << std::endl;
     return true;
 }
 
-bool instr_special::POP_stdouts::exec() {
+template <typename Trace>
+bool instr_special::POP_stdouts<Trace>::exec() {
     union {
         uint64_t u;
         int64_t  s;
     };
-    u = machine.pop();
+    u = machine.pop<Trace>();
     std::cout << s << std::endl;
     return true;
 }
 
-bool instr_special::POP_stdoutf::exec() {
+template <typename Trace>
+bool instr_special::POP_stdoutf<Trace>::exec() {
     union {
         uint32_t i;
         float    f;
     };
-    i = static_cast<decltype(i)>(machine.pop());
+    i = static_cast<decltype(i)>(machine.pop<Trace>());
     std::cout << f << std::endl;
     return true;
 }
 
-bool instr_special::POP_stdoutd::exec() {
+template <typename Trace>
+bool instr_special::POP_stdoutd<Trace>::exec() {
     union {
         uint64_t i;
         double   d;
     };
-    i = static_cast<decltype(i)>(machine.pop());
+    i = static_cast<decltype(i)>(machine.pop<Trace>());
     std::cout << d << std::endl;
     return true;
 }
+
+#define SPECIAL_INSTRUCTION_INSTANTIATE(name)                                                                          \
+    template class instr_special::name<tracing::off>;                                                                  \
+    template class instr_special::name<tracing::on>;
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_stime)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_mtime)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_ctime)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_ttime)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_pid)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_ppid)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_uid)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_euid)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_rand)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_randf)
+SPECIAL_INSTRUCTION_INSTANTIATE(PUSH_randd)
+SPECIAL_INSTRUCTION_INSTANTIATE(POP_stdout)
+SPECIAL_INSTRUCTION_INSTANTIATE(POP_stdouts)
+SPECIAL_INSTRUCTION_INSTANTIATE(POP_stdoutf)
+SPECIAL_INSTRUCTION_INSTANTIATE(POP_stdoutd)
+#undef SPECIAL_INSTRUCTION_INSTANTIATE
@@ -7,19 +7,40 @@
 
 #include "instruction.hpp"
 
+#include <chrono>
+#include <cstdint>
+
 namespace instr_special {
 
+/**
+ * @brief switch to the simulation mode (calling thread only)
+ * @details
+ *   STIME, MTIME, CTIME and TTIME return a virtual clock instead of the system clocks. The virtual clock starts at the
+ *   current real time (STIME) or at 0 (MTIME, CTIME, TTIME) and only advances if advance_clock is called.
+ *   RAND, RANDF and RANDD are generated by a random number generator with the given seed (reproducible).
+ * @param seed seed of the random number generator
+ */
+void simulate(uint64_t seed);
+
+/**
+ * @brief advance the virtual clock of the simulation mode
+ * @param time time of one cycle
+ */
+void advance_clock(std::chrono::nanoseconds time);
+
 class PUSH_special : public instr::PUSH {
 protected:
     explicit PUSH_special(StackMachine &machine) : instr::PUSH(machine) {}
 };
 
+template <typename Trace>
 class PUSH_stime : public PUSH_special {
 public:
     explicit PUSH_stime(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_mtime : public PUSH_special {
 public:
     explicit PUSH_mtime(StackMachine &machine) : PUSH_special(machine) {}
@@ -27,87 +48,101 @@ public:
 };
 
 
+template <typename Trace>
 class PUSH_ctime : public PUSH_special {
 public:
     explicit PUSH_ctime(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_ttime : public PUSH_special {
 public:
     explicit PUSH_ttime(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_pid : public PUSH_special {
 public:
     explicit PUSH_pid(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_ppid : public PUSH_special {
 public:
     explicit PUSH_ppid(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_uid : public PUSH_special {
 public:
     explicit PUSH_uid(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_euid : public PUSH_special {
 public:
     explicit PUSH_euid(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_rand : public PUSH_special {
 public:
     explicit PUSH_rand(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_randf : public PUSH_special {
 public:
     explicit PUSH_randf(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class PUSH_randd : public PUSH_special {
 public:
     explicit PUSH_randd(StackMachine &machine) : PUSH_special(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class POP_NULL : public instr::POP {
 public:
     explicit POP_NULL(StackMachine &machine) : POP(machine) {}
     bool exec() override {
-        machine.pop();
+        machine.pop<Trace>();
         return true;
     };
 };
 
+template <typename Trace>
 class POP_stdout : public instr::POP {
 public:
     explicit POP_stdout(StackMachine &machine) : POP(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class POP_stdouts : public instr::POP {
 public:
     explicit POP_stdouts(StackMachine &machine) : POP(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class POP_stdoutf : public instr::POP {
 public:
     explicit POP_stdoutf(StackMachine &machine) : POP(machine) {}
     bool exec() override;
 };
 
+template <typename Trace>
 class POP_stdoutd : public instr::POP {
 public:
     explicit POP_stdoutd(StackMachine &machine) : POP(machine) {}
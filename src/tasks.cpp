@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "tasks.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace tasks {
+
+static constexpr int64_t NS_PER_S = 1000000000;
+
+/**
+ * @brief get the current time of CLOCK_MONOTONIC in ns
+ */
+static int64_t now_ns() {
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NS_PER_S + now.tv_nsec;
+}
+
+/**
+ * @brief execution of a task failed (the message contains the task name)
+ */
+class task_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+std::ostream &operator<<(std::ostream &out, const task_stats_t &stats) {
+    auto us = [](std::chrono::nanoseconds ns) { return static_cast<double>(ns.count()) / 1000.0; };
+
+    std::ostringstream sstr;
+    sstr << stats.name << ": " << stats.cycles << " cycles, " << stats.overruns << " overruns, " << stats.skipped
+         << " skipped, " << stats.preemptions << " preemptions";
+    if (stats.cycles) {
+        sstr << ", execution time min/mean/max: " << std::fixed << std::setprecision(1) << us(stats.exec_min) << '/'
+             << us(stats.exec_mean) << '/' << us(stats.exec_max) << " us, max response time: "
+             << us(stats.response_max) << " us";
+    }
+    return out << sstr.str();
+}
+
+Executive::Executive(Machine &machine) {
+    auto add = [this](Machine &task_machine) {
+        task_t task {};
+        task.machine   = &task_machine;
+        task.period    = task_machine.get_cycle_time().count();
+        task.overrun   = task_machine.get_overrun_policy();
+        task.remaining = task_machine.get_cycles();
+        task.inf       = task_machine.get_cycles() == 0;
+        tasks.push_back(task);
+    };
+
+    add(machine);
+    for (const auto &task_machine : machine.get_tasks())
+        add(*task_machine);
+
+    // rate monotonic, tasks with the same period in the order of the sections
+    std::stable_sort(
+            tasks.begin(), tasks.end(), [](const task_t &a, const task_t &b) { return a.period < b.period; });
+
+    for (std::size_t i = 1; i < tasks.size(); ++i)
+        tasks[i].machine->set_preemption(this);
+}
+
+Executive::~Executive() { stop(); }
+
+void Executive::start() {
+    if (reporter) {
+        for (auto &task : tasks) {
+            task.log = &reporter->add("task " + task.machine->get_task_name(), std::chrono::nanoseconds(task.period));
+            task.machine->set_fault_log(task.log);
+        }
+    }
+
+    start_time = now_ns();
+    for (auto &task : tasks)
+        task.release = start_time;
+    active = tasks.size();
+
+    if (tasks.size() > 1) timer_thread = std::thread(&Executive::timer, this);
+}
+
+void Executive::stop() {
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex);
+        timer_stop = true;
+    }
+    timer_cv.notify_all();
+    if (timer_thread.joinable()) timer_thread.join();
+}
+
+void Executive::dispatch() {
+    pending.store(false, std::memory_order_relaxed);
+    run_due(tasks.size());
+}
+
+bool Executive::sleep() {
+    int64_t wakeup = INT64_MAX;
+    for (const auto &task : tasks)
+        if (!task.done) wakeup = std::min(wakeup, task.release);
+    if (wakeup == INT64_MAX) return true;
+
+    timespec ts {};
+    ts.tv_sec  = wakeup / NS_PER_S;
+    ts.tv_nsec = wakeup % NS_PER_S;
+
+    const int ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    if (ret == EINTR) return false;
+    if (ret) {
+        std::ostringstream sstr;
+        sstr << "clock_nanosleep failed: " << std::strerror(ret);
+        throw std::runtime_error(sstr.str());
+    }
+    return true;
+}
+
+std::vector<task_stats_t> Executive::get_stats() const {
+    std::vector<task_stats_t> stats;
+    stats.reserve(tasks.size());
+    for (const auto &task : tasks) {
+        task_stats_t task_stats {};
+        task_stats.name         = task.machine->get_task_name();
+        task_stats.cycles       = task.cycles;
+        task_stats.overruns     = task.overruns;
+        task_stats.skipped      = task.skipped;
+        task_stats.preemptions  = task.preemptions;
+        task_stats.exec_max     = std::chrono::nanoseconds(task.exec_max);
+        task_stats.response_max = std::chrono::nanoseconds(task.response_max);
+        if (task.cycles) {
+            task_stats.exec_min  = std::chrono::nanoseconds(task.exec_min);
+            task_stats.exec_mean = std::chrono::nanoseconds(
+                    static_cast<int64_t>(task.exec_sum / static_cast<double>(task.cycles)));
+        }
+        stats.push_back(task_stats);
+    }
+    return stats;
+}
+
+void Executive::preempt() {
+    pending.store(false, std::memory_order_relaxed);
+    if (current != IDLE) run_due(current);
+}
+
+void Executive::run_due(std::size_t limit) {
+    // a cycle of a task with a higher priority can be released while a cycle is executed --> start again at the
+    // highest priority after each cycle
+    for (std::size_t i = 0; i < limit;) {
+        if (!tasks[i].done && tasks[i].release <= now_ns()) {
+            run_cycle(i);
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+}
+
+void Executive::run_cycle(std::size_t index) {
+    auto &task = tasks[index];
+
+    const auto outer_current = current;
+    const auto outer_nested  = nested;
+    if (outer_current != IDLE) ++tasks[outer_current].preemptions;
+
+    current          = index;
+    nested           = 0;
+    const auto begin = now_ns();
+    try {
+        task.machine->run();
+    } catch (const task_error &) {
+        throw;  // failed in a cycle that preempted this cycle
+    } catch (const std::exception &e) {
+        std::ostringstream sstr;
+        sstr << "task " << task.machine->get_task_name() << ": " << e.what();
+        throw task_error(sstr.str());
+    }
+    const auto end = now_ns();
+
+    const auto exec = end - begin - nested;
+    task.exec_min   = std::min(task.exec_min, exec);
+    task.exec_max   = std::max(task.exec_max, exec);
+    task.exec_sum += static_cast<double>(exec);
+    task.response_max = std::max(task.response_max, end - task.release);
+    ++task.cycles;
+
+    current = outer_current;
+    nested  = outer_nested + (end - begin);
+
+    std::size_t missed = 0;
+    if (!task.inf && --task.remaining == 0) {
+        task.done = true;
+        --active;
+    } else {
+        task.release += task.period;
+        if (end >= task.release) {
+            ++task.overruns;
+            missed = static_cast<std::size_t>((end - task.release) / task.period) + 1;
+
+            if (task.overrun == scheduler::overrun_t::skip) {
+                task.release += static_cast<int64_t>(missed) * task.period;
+                task.skipped += missed;
+            }
+        }
+    }
+
+    // no output in the cycle thread: overrun warnings are printed (rate limited) by the reporter
+    // (execution time without preemptions)
+    if (task.log) task.log->record({end - exec, end, missed});
+}
+
+void Executive::timer() {
+    // the releases of the task with the lowest priority do not preempt another task
+    std::vector<int64_t> release(tasks.size() - 1);
+    for (std::size_t i = 0; i < release.size(); ++i)
+        release[i] = start_time + tasks[i].period;
+
+    // std::chrono::steady_clock is CLOCK_MONOTONIC
+    std::unique_lock<std::mutex> lock(timer_mutex);
+    while (!timer_stop) {
+        const auto wakeup = std::chrono::steady_clock::time_point(
+                std::chrono::nanoseconds(*std::min_element(release.begin(), release.end())));
+        if (timer_cv.wait_until(lock, wakeup, [this]() { return timer_stop; })) break;
+
+        pending.store(true, std::memory_order_relaxed);
+
+        const auto now = now_ns();
+        for (std::size_t i = 0; i < release.size(); ++i) {
+            if (release[i] <= now) release[i] += ((now - release[i]) / tasks[i].period + 1) * tasks[i].period;
+        }
+    }
+}
+
+}  // namespace tasks
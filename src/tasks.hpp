@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include "Machine.hpp"
+#include "bytecode.hpp"
+#include "cycle_log.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief execute the tasks of a program file (sections __PROGRAM <task> <period>) in one thread
+ * @details
+ *   The priorities are rate monotonic: the shorter the period, the higher the priority. Section __PROGRAM is the task
+ *   main with the cycle time of the program.
+ *
+ *   A cycle of a task is preempted if a cycle of a task with a higher priority is released: a timer thread sets the
+ *   preemption request at each release, the preempted program executes the due cycles at its next preemption point
+ *   (see Machine::set_preemption) and continues afterwards. The task with the highest priority is never preempted.
+ */
+namespace tasks {
+
+/**
+ * @brief statistics of a task
+ */
+struct task_stats_t {
+    std::string              name;          //*< task name
+    std::size_t              cycles;        //*< number of executed cycles
+    std::size_t              overruns;      //*< number of cycles that did not end before the next release
+    std::size_t              skipped;       //*< number of dropped cycles (OVERRUN SKIP)
+    std::size_t              preemptions;   //*< number of cycles of other tasks that preempted a cycle of the task
+    std::chrono::nanoseconds exec_min;      //*< min execution time of a cycle (without preemptions)
+    std::chrono::nanoseconds exec_mean;     //*< mean execution time of a cycle (without preemptions)
+    std::chrono::nanoseconds exec_max;      //*< max execution time of a cycle (without preemptions)
+    std::chrono::nanoseconds response_max;  //*< max time between the release and the end of a cycle
+};
+
+/**
+ * @brief print the statistics of a task (one line)
+ */
+std::ostream &operator<<(std::ostream &out, const task_stats_t &stats);
+
+/**
+ * @brief rate monotonic executive with preemption at instruction boundaries
+ * @details
+ *   Usage:
+ *     - start
+ *     - dispatch: execute the due cycles
+ *     - sleep: wait for the next release (repeat if interrupted by a signal)
+ *     - repeat dispatch and sleep while running
+ *
+ *   The timer thread is created by start and inherits the scheduling policy of the calling thread.
+ */
+class Executive final : public bytecode::Preemption {
+private:
+    static constexpr std::size_t IDLE = SIZE_MAX;
+
+    /**
+     * @brief task that is executed by the executive
+     */
+    struct task_t {
+        Machine             *machine;                   //*< machine of the task
+        int64_t              period;                    //*< period in ns
+        scheduler::overrun_t overrun;                   //*< overrun policy
+        std::size_t          remaining;                 //*< number of remaining cycles
+        bool                 inf;                       //*< infinite number of cycles
+        bool                 done         = false;      //*< all cycles executed
+        int64_t              release      = 0;          //*< begin of the next cycle in ns (CLOCK_MONOTONIC)
+        std::size_t          cycles       = 0;
+        std::size_t          overruns     = 0;
+        std::size_t          skipped      = 0;
+        std::size_t          preemptions  = 0;
+        int64_t              exec_min     = INT64_MAX;  //*< in ns
+        int64_t              exec_max     = 0;          //*< in ns
+        double               exec_sum     = 0.0;        //*< in ns
+        int64_t              response_max = 0;          //*< in ns
+
+        cycle_log::Reporter::Source *log = nullptr;  //*< cycle log (nullptr: none)
+    };
+
+    std::vector<task_t> tasks;              //*< ordered by priority (index 0: highest priority)
+    std::size_t         active     = 0;     //*< number of tasks that are not done
+    std::size_t         current    = IDLE;  //*< index of the task whose cycle is executed
+    int64_t             nested     = 0;     //*< time of the cycles that preempted the current cycle in ns
+    int64_t             start_time = 0;     //*< release of the first cycles in ns
+
+    cycle_log::Reporter *reporter = nullptr;  //*< reporter of the overruns (nullptr: none)
+
+    std::thread             timer_thread;
+    std::mutex              timer_mutex;
+    std::condition_variable timer_cv;
+    bool                    timer_stop = false;  //*< protected by timer_mutex
+
+public:
+    /**
+     * @brief create the executive for a machine and its tasks
+     * @details all tasks except the one with the highest priority are made preemptible
+     * @param machine initialized machine (has to outlive the executive)
+     */
+    explicit Executive(Machine &machine);
+
+    Executive(const Executive &)            = delete;
+    Executive &operator=(const Executive &) = delete;
+
+    ~Executive() override;
+
+    /**
+     * @brief record the cycles of all tasks in the cycle log of a reporter
+     * @details has to be called before start. Overruns are reported (rate limited) by the reporter thread.
+     * @param reporter reporter (has to outlive the executive)
+     */
+    void set_reporter(cycle_log::Reporter &reporter) { this->reporter = &reporter; }
+
+    /**
+     * @brief release the first cycle of all tasks now and start the timer thread
+     * @details adds a source per task to the reporter (see set_reporter)
+     */
+    void start();
+
+    /**
+     * @brief stop the timer thread
+     */
+    void stop();
+
+    /**
+     * @brief check if any task still has cycles to execute
+     */
+    [[nodiscard]] bool running() const { return active != 0; }
+
+    /**
+     * @brief execute all due cycles (highest priority first)
+     * @exception std::runtime_error execution of a task failed
+     */
+    void dispatch();
+
+    /**
+     * @brief sleep until the next release
+     * @return true: cycle released, false: interrupted by a signal (call again to continue the wait)
+     * @exception std::runtime_error clock_nanosleep failed
+     */
+    bool sleep();
+
+    /**
+     * @brief get the statistics of all tasks (ordered by priority)
+     */
+    [[nodiscard]] std::vector<task_stats_t> get_stats() const;
+
+    /**
+     * @brief execute the due cycles of the tasks with a higher priority than the current task
+     * @details called at a preemption point of the current task
+     */
+    void preempt() override;
+
+private:
+    /**
+     * @brief execute the due cycles of the tasks with a priority index below limit
+     */
+    void run_due(std::size_t limit);
+
+    /**
+     * @brief execute one cycle of a task and schedule its next release
+     */
+    void run_cycle(std::size_t index);
+
+    /**
+     * @brief timer thread: set the preemption request at each release of a task that can preempt another task
+     */
+    void timer();
+};
+
+}  // namespace tasks
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+/**
+ * @brief tracing policies of the stack machine operations and the instructions
+ * @details
+ *   The stack machine operations and the instructions are templates on the tracing policy. The trace output is only
+ *   generated by the instantiation for tracing::on (selected by --debug). The instantiation for tracing::off contains
+ *   no trace code.
+ */
+namespace tracing {
+
+/**
+ * @brief do not trace (production)
+ */
+struct off {
+    static constexpr bool enabled = false;
+};
+
+/**
+ * @brief print each stack machine operation to stderr
+ */
+struct on {
+    static constexpr bool enabled = true;
+};
+
+}  // namespace tracing
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "trigger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <linux/futex.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace trigger {
+
+/**
+ * @brief convert a duration to a timespec
+ */
+static timespec to_timespec(std::chrono::nanoseconds duration) {
+    const auto sec = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    timespec   result {};
+    result.tv_sec  = sec.count();
+    result.tv_nsec = (duration - sec).count();
+    return result;
+}
+
+Change::Change(const void *data, std::size_t size, std::chrono::nanoseconds poll)
+    : data(static_cast<const uint8_t *>(data)), snapshot(size), poll(poll) {}
+
+void Change::arm() { std::memcpy(snapshot.data(), data, snapshot.size()); }
+
+bool Change::wait(std::chrono::steady_clock::time_point deadline) {
+    while (true) {
+        if (std::memcmp(snapshot.data(), data, snapshot.size()) != 0) return true;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return false;
+
+        const auto timeout = to_timespec(std::min<std::chrono::nanoseconds>(poll, deadline - now));
+        if (nanosleep(&timeout, nullptr) && errno == EINTR) return false;
+    }
+}
+
+Futex::Futex(void *word) : word(static_cast<uint32_t *>(word)) {
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex trigger requires lock free 32 bit atomics");
+
+    if (reinterpret_cast<uintptr_t>(word) % alignof(uint32_t) != 0)
+        throw std::runtime_error("futex word is not aligned to 4 bytes");
+}
+
+void Futex::arm() { armed = reinterpret_cast<std::atomic<uint32_t> *>(word)->load(std::memory_order_acquire); }
+
+bool Futex::wait(std::chrono::steady_clock::time_point deadline) {
+    while (true) {
+        if (reinterpret_cast<std::atomic<uint32_t> *>(word)->load(std::memory_order_acquire) != armed) return true;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) return false;
+
+        // returns immediately (EAGAIN) if the word is not equal to armed
+        const auto timeout = to_timespec(deadline - now);
+        if (syscall(SYS_futex, word, FUTEX_WAIT, armed, &timeout, nullptr, 0) == -1) {
+            switch (errno) {
+                case EAGAIN:
+                case ETIMEDOUT: break;
+                case EINTR: return false;
+                default: {
+                    std::ostringstream sstr;
+                    sstr << "futex wait failed: " << std::strerror(errno);
+                    throw std::runtime_error(sstr.str());
+                }
+            }
+        }
+    }
+}
+
+Notify::Notify(void *word) : word(static_cast<uint32_t *>(word)) {
+    if (reinterpret_cast<uintptr_t>(word) % alignof(uint32_t) != 0)
+        throw std::runtime_error("futex word is not aligned to 4 bytes");
+}
+
+void Notify::notify() {
+    reinterpret_cast<std::atomic<uint32_t> *>(word)->fetch_add(1, std::memory_order_release);
+    if (syscall(SYS_futex, word, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0) == -1) {
+        std::ostringstream sstr;
+        sstr << "futex wake failed: " << std::strerror(errno);
+        throw std::runtime_error(sstr.str());
+    }
+}
+
+}  // namespace trigger
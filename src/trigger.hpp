@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief event driven execution (setting TRIGGER)
+ * @details
+ *   A cycle is only executed if the inputs changed since the begin of the previous cycle:
+ *     - arm is called at the begin of each cycle (before the inputs are read)
+ *     - wait returns as soon as the inputs differ from the state at the time of arm
+ *   Changes between arm and the input read of the cycle trigger one additional cycle, so no change is missed.
+ */
+namespace trigger {
+
+/**
+ * @brief abstract trigger
+ */
+class Trigger {
+public:
+    virtual ~Trigger() = default;
+
+    /**
+     * @brief remember the current state of the inputs
+     */
+    virtual void arm() = 0;
+
+    /**
+     * @brief wait until the inputs changed since arm
+     * @details returns early if the wait is interrupted by a signal
+     * @param deadline latest time to return (max interval between two cycles)
+     * @return true: inputs changed, false: deadline reached or interrupted
+     */
+    virtual bool wait(std::chrono::steady_clock::time_point deadline) = 0;
+};
+
+/**
+ * @brief trigger on a changed memory range (TRIGGER CHANGE)
+ * @details the range is compared with a copy (memcmp) in a fixed poll interval
+ */
+class Change final : public Trigger {
+private:
+    const uint8_t           *data;      //*< watched memory range
+    std::vector<uint8_t>     snapshot;  //*< content of the range at arm
+    std::chrono::nanoseconds poll;      //*< poll interval
+
+public:
+    /**
+     * @brief create trigger
+     * @param data watched memory range
+     * @param size size of the range in bytes
+     * @param poll poll interval
+     */
+    Change(const void *data, std::size_t size, std::chrono::nanoseconds poll);
+
+    void arm() override;
+    bool wait(std::chrono::steady_clock::time_point deadline) override;
+};
+
+/**
+ * @brief trigger on a changed futex word (TRIGGER FUTEX)
+ * @details
+ *   Producers change the 32 bit word (e.g. increment it) after they wrote the inputs and wake the waiters
+ *   (FUTEX_WAKE, not private). Waiting does not use the CPU.
+ */
+class Futex final : public Trigger {
+private:
+    uint32_t *word;       //*< futex word
+    uint32_t  armed = 0;  //*< value of the futex word at arm
+
+public:
+    /**
+     * @brief create trigger
+     * @param word futex word (aligned to 4 bytes)
+     */
+    explicit Futex(void *word);
+
+    void arm() override;
+    bool wait(std::chrono::steady_clock::time_point deadline) override;
+};
+
+/**
+ * @brief notify the next stage of a pipeline after each cycle (NOTIFY)
+ * @details
+ *   Increments a 32 bit futex word after the outputs of a cycle were written and wakes all waiters (FUTEX_WAKE, not
+ *   private). The next stage waits on the same word (TRIGGER FUTEX).
+ */
+class Notify final {
+private:
+    uint32_t *word;  //*< futex word
+
+public:
+    /**
+     * @brief create notification
+     * @param word futex word (aligned to 4 bytes)
+     */
+    explicit Notify(void *word);
+
+    /**
+     * @brief increment the futex word and wake all waiters
+     * @exception std::runtime_error futex wake failed
+     */
+    void notify();
+};
+
+}  // namespace trigger
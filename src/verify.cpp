@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2022 Nikolas Koesling <nikolas@koesling.info>.
+ * This program is free software. You can redistribute it and/or modify it under the terms of the MIT License.
+ */
+
+#include "bytecode.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+bytecode::verify_result_t bytecode::Program::verify(std::size_t stack_size) {
+    if (ops.empty() || ops.back().code != opcode_t::END) throw std::logic_error("bytecode program is not terminated");
+
+    verified = false;
+
+    verify_result_t          result;
+    auto                    &depth = result.depth;
+    std::vector<std::size_t> work;
+    depth.resize(ops.size());
+
+    // add the stack depths of an incoming path to an operation (revisit the operation if the range grows)
+    auto merge = [&](std::size_t index, std::size_t from, std::size_t min, std::size_t max) {
+        if (index >= depth.size()) throw verify_error(from, "invalid jump target");
+
+        auto &d = depth[index];
+        if (d.reachable() && min >= d.min && max <= d.max) return;
+
+        d.min = std::min(d.min, min);
+        d.max = std::max(d.max, max);
+        work.push_back(index);
+    };
+
+    // the ranges only grow and are limited by the stack size --> terminates after at most
+    // ops.size() * (stack_size + 1) iterations
+    merge(0, 0, 0, 0);
+    while (!work.empty()) {
+        const auto index = work.back();
+        work.pop_back();
+
+        const auto &op = ops[index];
+        const auto  in = depth[index];
+
+        std::size_t pops;
+        std::size_t pushes;
+        if (!stack_effect(op, pops, pushes)) throw verify_error(index, "unknown stack effect");
+
+        if (in.min < pops) {
+            std::ostringstream sstr;
+            sstr << "possible stack underflow: operation needs " << pops << " value(s), but the stack may contain only "
+                 << in.min;
+            throw verify_error(index, sstr.str());
+        }
+
+        const auto min = in.min - pops + pushes;
+        const auto max = in.max - pops + pushes;
+        if (max > stack_size) {
+            std::ostringstream sstr;
+            sstr << "possible stack overflow: stack may grow to " << max << " values (stack size: " << stack_size
+                 << ')';
+            throw verify_error(index, sstr.str());
+        }
+        result.max_depth = std::max(result.max_depth, max);
+
+        // successors
+        if (op.code == opcode_t::J || op.code == opcode_t::JZ || op.code == opcode_t::JNZ)
+            merge(op.arg.target, index, min, max);
+        if (op.code != opcode_t::END && op.code != opcode_t::J) merge(index + 1, index, min, max);
+    }
+
+    verified  = true;
+    max_depth = result.max_depth;
+    return result;
+}
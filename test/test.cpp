@@ -9,6 +9,8 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <sys/wait.h>
+#include <sysexits.h>
 
 static std::pair<std::string, int> exec(const char *cmd) {
     std::array<char, 4096> buffer {};
@@ -143,6 +145,971 @@ int main() {
         }
     }
 
+    {  // test 8
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "3\n3\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/8.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 8: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 8: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 9 (test 8 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "3\n3\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --reference ../../test/programs/8.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 9: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 9: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 10
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "9\n25\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/9.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 10: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 10: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 11 (test 10 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "9\n25\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --reference ../../test/programs/9.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 11: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 11: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 12
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "-21\n10\n7\n18446744073709551615\n1\n2\n3\n"
+                                        "-3.375\n7.375\n1.33333\n2\n-2.5\n-10\n144\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --jit ../../test/programs/10.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 12: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 12: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 13 (test 12 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "-21\n10\n7\n18446744073709551615\n1\n2\n3\n"
+                                        "-3.375\n7.375\n1.33333\n2\n-2.5\n-10\n144\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --reference ../../test/programs/10.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 13: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 13: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 14 (test 10 with native code)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "9\n25\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --jit ../../test/programs/9.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 14: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 14: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 15 (possible stack underflow)
+        const int         EXPECT_EXIT = EX_DATAERR;
+        const std::string EXPECT_OUT;
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/11.stackm 2>/dev/null");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 15: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 15: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 16 (test 15 with reference interpreter)
+        const int         EXPECT_EXIT = EX_DATAERR;
+        const std::string EXPECT_OUT;
+
+        std::pair<std::string, int> result =
+                exec("../shm-stack-machine --reference ../../test/programs/11.stackm 2>/dev/null");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 16: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 16: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 17 (stack overflow in loop)
+        const int         EXPECT_EXIT = EX_DATAERR;
+        const std::string EXPECT_OUT;
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/12.stackm 2>/dev/null");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 17: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 17: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+#ifdef TEST_AOT
+    {  // test 18 (test 10 with ahead-of-time compiled program)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "9\n25\n";
+
+        std::pair<std::string, int> result = exec("../aot/shm-stack-machine-aot -o aot_9.so ../../test/programs/9.stackm && "
+                                                  "../shm-stack-machine --aot aot_9.so ../../test/programs/9.stackm");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 18: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 18: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 19 (test 12 with ahead-of-time compiled program)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "-21\n10\n7\n18446744073709551615\n1\n2\n3\n"
+                                        "-3.375\n7.375\n1.33333\n2\n-2.5\n-10\n144\n";
+
+        std::pair<std::string, int> result = exec("../aot/shm-stack-machine-aot -o aot_10.so ../../test/programs/10.stackm && "
+                                                  "../shm-stack-machine --aot aot_10.so ../../test/programs/10.stackm");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 19: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 19: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 20 (compiled program does not match the program file)
+        const int         EXPECT_EXIT = EX_DATAERR;
+        const std::string EXPECT_OUT  = "";
+
+        std::pair<std::string, int> result = exec("../aot/shm-stack-machine-aot -o aot_9.so ../../test/programs/9.stackm && "
+                                                  "../shm-stack-machine --aot aot_9.so ../../test/programs/10.stackm 2>/dev/null");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 20: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 20: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
+    {  // test 21
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "3\n169\n18446744073709551592\n6\n13\n8\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/13.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 21: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 21: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 22 (test 21 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "3\n169\n18446744073709551592\n6\n13\n8\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --reference ../../test/programs/13.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 22: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 22: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 23 (test 21 with native code)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "3\n169\n18446744073709551592\n6\n13\n8\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --jit ../../test/programs/13.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 23: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 23: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 24 (optimized listing of test 21)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "# 33 operations (45 instructions, 3 folded, 6 reduced, 13 removed, 0 threaded)\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --listing ../../test/programs/13.stackm | head -n 1");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 24: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 24: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 25
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n2\n2\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/14.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 25: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 25: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 26 (test 25 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n2\n2\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --reference ../../test/programs/14.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 26: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 26: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 27 (test 25 with native code)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n2\n2\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --jit ../../test/programs/14.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 27: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 27: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 28 (optimized listing of test 25)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "# 24 operations (33 instructions, 0 folded, 0 reduced, 10 removed, 2 threaded)\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --listing ../../test/programs/14.stackm | head -n 1");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 28: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 28: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 29 (shared memory data types)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "8\n1\n72623859790382856\n51\n287454020\n4\n8\n72623859790382856\n8\n2\n0\n1\n255\n"
+                                        "18446744073709551614\n";
+
+        std::pair<std::string, int> result = exec("head -c 32 /dev/zero > /dev/shm/stackm_test_15 && "
+                                                  "../shm-stack-machine ../../test/programs/15.stackm; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_15; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 29: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 29: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 30 (test 29 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "8\n1\n72623859790382856\n51\n287454020\n4\n8\n72623859790382856\n8\n2\n0\n1\n255\n"
+                                        "18446744073709551614\n";
+
+        std::pair<std::string, int> result = exec("head -c 32 /dev/zero > /dev/shm/stackm_test_15 && "
+                                                  "../shm-stack-machine --reference ../../test/programs/15.stackm; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_15; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 30: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 30: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 31 (test 29 with native code)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "8\n1\n72623859790382856\n51\n287454020\n4\n8\n72623859790382856\n8\n2\n0\n1\n255\n"
+                                        "18446744073709551614\n";
+
+        std::pair<std::string, int> result = exec("head -c 32 /dev/zero > /dev/shm/stackm_test_15 && "
+                                                  "../shm-stack-machine --jit ../../test/programs/15.stackm; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_15; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 31: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 31: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 32 (variable outside of the shared memory)
+        const int         EXPECT_EXIT = EX_DATAERR;
+        const std::string EXPECT_OUT;
+
+        std::pair<std::string, int> result = exec("head -c 32 /dev/zero > /dev/shm/stackm_test_16 && "
+                                                  "../shm-stack-machine ../../test/programs/16.stackm 2>/dev/null; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_16; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 32: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 32: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 33 (division by zero, fault policy SKIP)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n0\n2\n3\n12\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/17.stackm 2>/dev/null");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 33: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 33: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 34 (test 33 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n0\n2\n3\n12\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --reference ../../test/programs/17.stackm 2>/dev/null");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 34: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 34: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 35 (fault policy HANDLER)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n101\n2\n102\n3\n3\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/18.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 35: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 35: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 36 (test 35 with reference interpreter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n101\n2\n102\n3\n3\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --reference ../../test/programs/18.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 36: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 36: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 37 (test 35 with native code)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n101\n2\n102\n3\n3\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine --jit ../../test/programs/18.stackm");
+        if (result.second != EXPECT_EXIT) {
+            std::cerr << "test 37: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 37: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+#ifdef TEST_AOT
+    {  // test 38 (test 35 with ahead-of-time compiled program)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n101\n2\n102\n3\n3\n";
+
+        std::pair<std::string, int> result = exec("../aot/shm-stack-machine-aot -o aot_18.so ../../test/programs/18.stackm && "
+                                                  "../shm-stack-machine --aot aot_18.so ../../test/programs/18.stackm");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 38: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 38: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
+    {  // test 39 (division by zero, default fault policy ABORT)
+        const int         EXPECT_EXIT = EX_DATAERR;
+        const std::string EXPECT_OUT  = "1\n";
+
+        std::pair<std::string, int> result = exec("../shm-stack-machine ../../test/programs/19.stackm 2>/dev/null");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 39: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 39: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 40 (process image)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n10\n2\n20\n3\n30\n     2    20   100    16\n";
+
+        std::pair<std::string, int> result = exec("head -c 8 /dev/zero > /dev/shm/stackm_test_20 && "
+                                                  "../shm-stack-machine ../../test/programs/20.stackm 2>/dev/null && "
+                                                  "od -An -tu2 /dev/shm/stackm_test_20; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_20; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 40: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 40: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 41 (test 40 with native code)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n10\n2\n20\n3\n30\n     2    20   100    16\n";
+
+        std::pair<std::string, int> result = exec("head -c 8 /dev/zero > /dev/shm/stackm_test_20 && "
+                                                  "../shm-stack-machine --jit ../../test/programs/20.stackm 2>/dev/null && "
+                                                  "od -An -tu2 /dev/shm/stackm_test_20; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_20; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 41: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 41: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 42 (process image synchronized by a seqlock)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n7\n2\n7\n3\n7\n                    6                    3\n"
+                                        "                    7\n";
+
+        std::pair<std::string, int> result = exec("head -c 16 /dev/zero > /dev/shm/stackm_test_21 && "
+                                                  "printf '\\007' >> /dev/shm/stackm_test_21 && "
+                                                  "head -c 7 /dev/zero >> /dev/shm/stackm_test_21 && "
+                                                  "../shm-stack-machine ../../test/programs/21.stackm 2>/dev/null && "
+                                                  "od -An -tu8 /dev/shm/stackm_test_21; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_21; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 42: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 42: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 43 (variable overlaps the seqlock sequence counter)
+        const int         EXPECT_EXIT = EX_DATAERR;
+        const std::string EXPECT_OUT;
+
+        std::pair<std::string, int> result = exec("head -c 16 /dev/zero > /dev/shm/stackm_test_22 && "
+                                                  "../shm-stack-machine ../../test/programs/22.stackm 2>/dev/null; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_22; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 43: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 43: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 44 (memory mapped file, run twice: the content is retained)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n2\n3\n4\n5\n6\n                    0                    6\n";
+
+        std::pair<std::string, int> result = exec("head -c 16 /dev/zero > stackm_test_23.dat && "
+                                                  "../shm-stack-machine ../../test/programs/23.stackm 2>/dev/null && "
+                                                  "../shm-stack-machine --jit ../../test/programs/23.stackm 2>/dev/null && "
+                                                  "od -An -tu8 stackm_test_23.dat; "
+                                                  "r=$?; rm -f stackm_test_23.dat; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 44: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 44: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 45 (prefaulted, locked and huge page backed memories)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n2\n     0     2     0     0\n";
+
+        std::pair<std::string, int> result = exec("head -c 8 /dev/zero > /dev/shm/stackm_test_24 && "
+                                                  "../shm-stack-machine ../../test/programs/24.stackm 2>/dev/null && "
+                                                  "od -An -tu2 /dev/shm/stackm_test_24; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_24; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 45: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 45: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 46 (event driven execution, the cycle time is 60 s)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "0\n7\n";
+
+        // the input is changed after the output of the first cycle was read: the trigger is armed at the begin of the
+        // cycle, so the change always triggers the second cycle (no timing dependency)
+        std::pair<std::string, int> result =
+                exec("head -c 4 /dev/zero > /dev/shm/stackm_test_25 && "
+                     "{ timeout 10 ../shm-stack-machine ../../test/programs/25.stackm 2>/dev/null; "
+                     "echo $? > /dev/shm/stackm_test_25_rc; } | "
+                     "{ read -r first && echo \"$first\" && "
+                     "printf '\\007' | dd of=/dev/shm/stackm_test_25 bs=1 seek=2 conv=notrunc 2>/dev/null; cat; }; "
+                     "r=$(cat /dev/shm/stackm_test_25_rc); rm -f /dev/shm/stackm_test_25 /dev/shm/stackm_test_25_rc; "
+                     "exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 46: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 46: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 47 (notification after each cycle)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "          3          3\n";
+
+        std::pair<std::string, int> result = exec("head -c 8 /dev/zero > /dev/shm/stackm_test_26 && "
+                                                  "../shm-stack-machine ../../test/programs/26.stackm 2>/dev/null && "
+                                                  "od -An -tu4 /dev/shm/stackm_test_26; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_26; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 47: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 47: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 48 (cached bit variables, bits that are not written keep the value of the memory)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n1\n1\n0\n1\n1\n   465     1\n";
+
+        std::pair<std::string, int> result = exec("printf '\\360\\000\\000\\000' > /dev/shm/stackm_test_27 && "
+                                                  "../shm-stack-machine ../../test/programs/27.stackm 2>/dev/null && "
+                                                  "od -An -tu2 /dev/shm/stackm_test_27; "
+                                                  "r=$?; rm -f /dev/shm/stackm_test_27; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 48: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 48: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 49 (cycle time in us, statistics on exit)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "5 cycles\n";
+
+        std::pair<std::string, int> result =
+                exec("../shm-stack-machine --stats ../../test/programs/28.stackm 2>&1 >/dev/null | "
+                     "sed -n 's/.*cycle statistics: \\([0-9]* cycles\\).*/\\1/p'");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 49: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 49: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 50 (real-time profile, invalid priority on the command line)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "SCHED_OTHER 0, CPU 0, 64 KiB stack prefaulted\n1\n1\n64\n";
+
+        std::pair<std::string, int> result =
+                exec("../shm-stack-machine -v ../../test/programs/29.stackm 2>&1 | "
+                     "sed -n -e 's/.*real-time profile: //p' -e '/^1$/p' && "
+                     "../shm-stack-machine --sched FIFO:100 ../../test/programs/29.stackm 2>/dev/null; echo $?");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 50: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 50: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 51 (host mode: two programs with different cycle times share one mapping of the shared memory)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "host: 2 programs, 1 shared memories, 2 worker threads\n"
+                                        "          5         10\n";
+
+        std::pair<std::string, int> result =
+                exec("head -c 8 /dev/zero > /dev/shm/stackm_test_30 && "
+                     "../shm-stack-machine -v --threads 2 ../../test/programs/30.stackm ../../test/programs/31.stackm "
+                     "2>&1 | sed -n 's/.* host: /host: /p' && "
+                     "od -An -tu4 /dev/shm/stackm_test_30; "
+                     "r=$?; rm -f /dev/shm/stackm_test_30; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 51: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 51: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 52 (tasks: a slow task that waits for a fast task is preempted by the fast task)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "1\n3\n3\nfast: 3 cycles\nslow: 3 cycles\nmain: 3 cycles\n";
+
+        std::pair<std::string, int> result =
+                exec("timeout 10 ../shm-stack-machine --stats ../../test/programs/32.stackm 2>&1 | "
+                     "sed -n -e '/^[0-9]*$/p' -e 's/.*task statistics \\([a-z]*: [0-9]* cycles\\).*/\\1/p'");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 52: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 52: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 53 (busy wait: setting WAIT and option --wait, period jitter statistics)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "SPIN\n50 cycles\nHYBRID 20 us\n50 cycles\n";
+
+        std::pair<std::string, int> result =
+                exec("for w in '' '--wait hybrid:20'; do "
+                     "../shm-stack-machine -v --stats $w ../../test/programs/33.stackm 2>&1 | sed -n "
+                     "-e 's/.* wait mode: //p' "
+                     "-e 's/.*cycle statistics: \\([0-9]* cycles\\).*period min\\/max: .*jitter.*/\\1/p'; done");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 53: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 53: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 54 (cycle log: rate limited overrun warnings, cycle summary on SIGTERM)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "warnings rate limited\nall cycles exceeded\n";
+
+        std::pair<std::string, int> result =
+                exec("timeout --preserve-status -s TERM 1.5 ../shm-stack-machine ../../test/programs/34.stackm 2>&1 | "
+                     "awk '/WARNING: cycle time exceeded/ { ++w } "
+                     "/cycle summary: / { c = $4; o = $6 } "
+                     "END { if (w >= 1 && w <= 4) print \"warnings rate limited\"; "
+                     "if (c > 0 && c == o) print \"all cycles exceeded\" }'");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 54: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 54: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 55 (simulation mode: virtual clock, seeded random numbers, throughput)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "0\n0.1\n0.2\nreproducible\n3 cycles (0.300 s simulated)\n";
+
+        std::pair<std::string, int> result =
+                exec("a=$(../shm-stack-machine --simulate 3 --seed 42 ../../test/programs/35.stackm 2>/dev/null) && "
+                     "b=$(../shm-stack-machine --simulate 3 --seed 42 ../../test/programs/35.stackm 2>/dev/null) && "
+                     "echo \"$a\" | sed -n '1p;3p;5p' && if [ \"$a\" = \"$b\" ]; then echo reproducible; fi && "
+                     "../shm-stack-machine --simulate 3 ../../test/programs/35.stackm 2>&1 >/dev/null | "
+                     "sed -n 's/.* simulation: \\(.* simulated)\\) in .* cycles\\/s$/\\1/p'");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 55: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 55: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 56 (cycle log of tasks and host mode: rate limited overrun warnings and cycle summary per source)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "task slow: 20 cycles, 19 overruns\nwarnings rate limited\n"
+                                        "37: 20 cycles, 19 overruns\n37: 20 cycles, 19 overruns\nwarnings rate limited\n";
+
+        std::pair<std::string, int> result =
+                exec("../shm-stack-machine --stats ../../test/programs/36.stackm 2>&1 | "
+                     "awk '/WARNING: task slow: cycle time exceeded/ { ++w } "
+                     "/cycle summary task slow: / { print $4, $5, $6, $7, $8, $9 } "
+                     "END { if (w >= 1 && w <= 2) print \"warnings rate limited\" }' && "
+                     "../shm-stack-machine --stats --threads 2 ../../test/programs/37.stackm "
+                     "../../test/programs/37.stackm 2>&1 | "
+                     "awk '/WARNING: 37: cycle time exceeded/ { ++w } "
+                     "/cycle summary 37: / { print $4, $5, $6, $7, $8 } "
+                     "END { if (w >= 2 && w <= 4) print \"warnings rate limited\" }'");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 56: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 56: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 57 (process image: a store of an unchanged value is written back)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "          0\n          0\n          0\n";
+
+        std::pair<std::string, int> result =
+                exec("for e in '' --reference --jit; do "
+                     "head -c 4 /dev/zero > /dev/shm/stackm_test_38 && "
+                     "../shm-stack-machine $e ../../test/programs/38.stackm 2>/dev/null && "
+                     "od -An -tu4 /dev/shm/stackm_test_38 || break; done; "
+                     "r=$?; rm -f /dev/shm/stackm_test_38; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 57: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 57: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+#ifdef TEST_AOT
+    {  // test 58 (test 57 with ahead-of-time compiled program)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "          0\n";
+
+        std::pair<std::string, int> result =
+                exec("head -c 4 /dev/zero > /dev/shm/stackm_test_38 && "
+                     "../aot/shm-stack-machine-aot -o aot_38.so ../../test/programs/38.stackm && "
+                     "../shm-stack-machine --aot aot_38.so ../../test/programs/38.stackm 2>/dev/null && "
+                     "od -An -tu4 /dev/shm/stackm_test_38; "
+                     "r=$?; rm -f /dev/shm/stackm_test_38; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 58: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 58: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+#endif
+
+    {  // test 59 (fault policy SKIP: the warnings of the skipped cycles are rate limited by the reporter)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "50 cycles skipped\nwarnings rate limited\n"
+                                        "50 cycles skipped\nwarnings rate limited\n";
+
+        std::pair<std::string, int> result =
+                exec("for e in '' '--simulate 50'; do ../shm-stack-machine $e ../../test/programs/39.stackm 2>&1 | "
+                     "awk '/WARNING: integer division by zero --> cycle skipped/ { ++w; ++n } "
+                     "/WARNING: integer division by zero --> [0-9]+ cycles skipped/ { ++w; n += $(NF - 2) } "
+                     "END { print n, \"cycles skipped\"; if (w >= 1 && w <= 3) print \"warnings rate limited\" }' "
+                     "|| break; done");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 59: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 59: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    {  // test 60 (prefault of a memory mapped file: the file is not modified)
+        const int         EXPECT_EXIT = 0;
+        const std::string EXPECT_OUT  = "0\n0\n0\n";
+
+        std::pair<std::string, int> result = exec("head -c 65536 /dev/zero > stackm_test_40.dat && "
+                                                  "touch -d @0 stackm_test_40.dat && "
+                                                  "../shm-stack-machine ../../test/programs/40.stackm 2>/dev/null && "
+                                                  "stat -c %Y stackm_test_40.dat; "
+                                                  "r=$?; rm -f stackm_test_40.dat; exit $r");
+        if (!WIFEXITED(result.second) || WEXITSTATUS(result.second) != EXPECT_EXIT) {
+            std::cerr << "test 60: wrong exit code" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (result.first != EXPECT_OUT) {
+            std::cerr << "test 60: wrong output: >>" << result.first << "<<" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     return EXIT_SUCCESS;
 }
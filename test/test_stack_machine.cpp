@@ -9,6 +9,7 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <sstream>
 
 union data_f {
     data_f() = default;
@@ -35,7 +36,7 @@ union data_d {
 static constexpr std::size_t STACK_SIZE = 8;
 
 int main() {
-    StackMachine          machine(false, STACK_SIZE);
+    StackMachine          machine(STACK_SIZE);
     StackMachine::stack_t p;
 
     machine.push(100);
@@ -70,6 +71,21 @@ int main() {
     static_cast<void>(p);
     assert(machine.size() == 0);
 
+    // division faults set the fault register
+    assert(!machine.faulted());
+    machine.push(7);
+    machine.push(0);
+    machine.div();
+    assert(machine.get_fault() == StackMachine::fault_t::div_zero);
+    machine.clr();
+    machine.clr_fault();
+    machine.push(static_cast<StackMachine::stack_t>(INT64_MIN));
+    machine.push(static_cast<StackMachine::stack_t>(-1));
+    machine.mods();
+    assert(machine.get_fault() == StackMachine::fault_t::div_overflow);
+    machine.clr();
+    machine.clr_fault();
+
     assert(machine.size() == 0);
 
     std::size_t sum = 0;
@@ -252,4 +268,56 @@ int main() {
     p = machine.pop();
     assert(p == 1);
     static_cast<void>(p);
+
+    // clr resets the stack (no reallocation, full capacity available again)
+    for (std::size_t i = 0; i < STACK_SIZE; ++i)
+        machine.push(i);
+    machine.clr();
+    assert(machine.size() == 0);
+
+    try {
+        machine.pop();
+        assert(0);
+    } catch (const std::exception &) {}
+
+    try {
+        machine.dup();
+        assert(0);
+    } catch (const std::exception &) {}
+
+    for (std::size_t i = 0; i < STACK_SIZE - 1; ++i)
+        machine.push(i);
+    machine.dup();
+    assert(machine.size() == STACK_SIZE);
+    assert(machine.get() == STACK_SIZE - 2);
+
+    try {
+        machine.dup();
+        assert(0);
+    } catch (const std::exception &) {}
+
+    machine.sub();
+    assert(machine.get() == 0);
+    machine.add();
+    assert(machine.get() == STACK_SIZE - 3);
+    assert(machine.size() == STACK_SIZE - 2);
+    machine.clr();
+
+    machine.push(d1.st);
+    try {
+        machine.atanxy();
+        assert(0);
+    } catch (const std::exception &) {}
+    machine.clr();
+
+    // tracing instantiation: same result, trace output on stderr
+    std::ostringstream trace;
+    auto              *cerr_buf = std::cerr.rdbuf(trace.rdbuf());
+    machine.push<tracing::on>(20);
+    machine.push<tracing::on>(22);
+    machine.add<tracing::on>();
+    p = machine.pop<tracing::on>();
+    std::cerr.rdbuf(cerr_buf);
+    assert(p == 42);
+    assert(trace.str().find("20 + 22 = 42") != std::string::npos);
 }